@@ -0,0 +1,33 @@
+# Copyright (c) 2024, MariaDB
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; version 2 of the License.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1335 USA
+
+# Provides the following configure option:
+# WITH_PROTOCOL_ZSTD
+# If this is set, the zstd compressed client/server protocol is built
+# when the system zstd library is found.
+# HAVE_ZSTD_COMPRESS, ZSTD_LIBRARIES, ZSTD_INCLUDE_DIRS
+# are set after this macro has run
+
+MACRO (MYSQL_CHECK_ZSTD)
+  OPTION(WITH_PROTOCOL_ZSTD
+    "Support the zstd compressed client/server protocol" ON)
+  IF(WITH_PROTOCOL_ZSTD)
+    FIND_PACKAGE(ZSTD)
+    IF(ZSTD_FOUND)
+      SET(HAVE_ZSTD_COMPRESS 1)
+      INCLUDE_DIRECTORIES(SYSTEM ${ZSTD_INCLUDE_DIRS})
+    ENDIF()
+  ENDIF()
+ENDMACRO()
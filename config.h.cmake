@@ -209,6 +209,7 @@
 #cmakedefine HAVE_REALPATH 1
 #cmakedefine HAVE_RENAME 1
 #cmakedefine HAVE_RWLOCK_INIT 1
+#cmakedefine HAVE_SCHED_GETCPU 1
 #cmakedefine HAVE_SCHED_YIELD 1
 #cmakedefine HAVE_SELECT 1
 #cmakedefine HAVE_SETENV 1
@@ -495,6 +496,7 @@
 #cmakedefine HAVE_CHARSET_utf32 1
 #cmakedefine HAVE_UCA_COLLATIONS 1
 #cmakedefine HAVE_COMPRESS 1
+#cmakedefine HAVE_ZSTD_COMPRESS 1
 #cmakedefine HAVE_EncryptAes128Ctr 1
 #cmakedefine HAVE_EncryptAes128Gcm 1
 #cmakedefine HAVE_des 1
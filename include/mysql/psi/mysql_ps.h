@@ -45,6 +45,8 @@
     inline_mysql_reprepare_prepared_stmt(PREPARED_STMT)
   #define MYSQL_SET_PS_TEXT(PREPARED_STMT, SQLTEXT, SQLTEXT_LENGTH) \
     inline_mysql_set_prepared_stmt_text(PREPARED_STMT, SQLTEXT, SQLTEXT_LENGTH)
+  #define MYSQL_PLAN_PS(PREPARED_STMT, EVENT) \
+    inline_mysql_plan_prepared_stmt(PREPARED_STMT, EVENT)
 #else
   #define MYSQL_CREATE_PS(IDENTITY, ID, LOCKER, NAME, NAME_LENGTH) \
     NULL
@@ -56,6 +58,8 @@
     do {} while (0)
   #define MYSQL_SET_PS_TEXT(PREPARED_STMT, SQLTEXT, SQLTEXT_LENGTH) \
     do {} while (0)
+  #define MYSQL_PLAN_PS(PREPARED_STMT, EVENT) \
+    do {} while (0)
 #endif
 
 #ifdef HAVE_PSI_PS_INTERFACE
@@ -103,6 +107,14 @@ inline_mysql_set_prepared_stmt_text(PSI_prepared_stmt *prepared_stmt,
     PSI_PS_CALL(set_prepared_stmt_text)(prepared_stmt, text, text_len);
   }
 }
+
+static inline void
+inline_mysql_plan_prepared_stmt(PSI_prepared_stmt *prepared_stmt,
+                                PSI_prepared_stmt_plan_event event)
+{
+  if (prepared_stmt != NULL)
+    PSI_PS_CALL(plan_prepared_stmt)(prepared_stmt, event);
+}
 #endif
 
 #endif
@@ -2397,6 +2397,26 @@ typedef void (*execute_prepared_stmt_v1_t)
 typedef void (*set_prepared_stmt_text_v1_t)(PSI_prepared_stmt *prepared_stmt,
                                             const char *text,
                                             uint text_len);
+
+/** Outcome of the optimization of a prepared statement with a saved plan. */
+enum PSI_prepared_stmt_plan_event
+{
+  /** The saved plan was reused. */
+  PSI_PS_PLAN_HIT= 0,
+  /** A plan was searched for and saved. */
+  PSI_PS_PLAN_MISS= 1,
+  /** The saved plan was discarded. */
+  PSI_PS_PLAN_INVALIDATE= 2
+};
+typedef enum PSI_prepared_stmt_plan_event PSI_prepared_stmt_plan_event;
+
+/**
+  Record the use of the saved plan of a prepared statement.
+  @param prepared_stmt prepared statement.
+  @param event what happened to the saved plan
+*/
+typedef void (*plan_prepared_stmt_v1_t)(PSI_prepared_stmt *prepared_stmt,
+                                        PSI_prepared_stmt_plan_event event);
 /**
   Get a digest locker for the current statement.
   @param locker a statement locker for the running thread
@@ -2755,6 +2775,8 @@ struct PSI_v1
   end_metadata_wait_v1_t end_metadata_wait;
 
   set_thread_peer_port_v1_t set_thread_peer_port;
+  /** @sa plan_prepared_stmt_v1_t. */
+  plan_prepared_stmt_v1_t plan_prepared_stmt;
 };
 
 /** @} (end of group Group_PSI_v1) */
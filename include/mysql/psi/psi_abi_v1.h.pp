@@ -658,6 +658,15 @@ typedef void (*execute_prepared_stmt_v1_t)
 typedef void (*set_prepared_stmt_text_v1_t)(PSI_prepared_stmt *prepared_stmt,
                                             const char *text,
                                             uint text_len);
+enum PSI_prepared_stmt_plan_event
+{
+  PSI_PS_PLAN_HIT= 0,
+  PSI_PS_PLAN_MISS= 1,
+  PSI_PS_PLAN_INVALIDATE= 2
+};
+typedef enum PSI_prepared_stmt_plan_event PSI_prepared_stmt_plan_event;
+typedef void (*plan_prepared_stmt_v1_t)(PSI_prepared_stmt *prepared_stmt,
+                                        PSI_prepared_stmt_plan_event event);
 typedef struct PSI_digest_locker * (*digest_start_v1_t)
   (struct PSI_statement_locker *locker);
 typedef void (*digest_end_v1_t)
@@ -834,6 +843,7 @@ struct PSI_v1
   start_metadata_wait_v1_t start_metadata_wait;
   end_metadata_wait_v1_t end_metadata_wait;
   set_thread_peer_port_v1_t set_thread_peer_port;
+  plan_prepared_stmt_v1_t plan_prepared_stmt;
 };
 typedef struct PSI_v1 PSI;
 typedef struct PSI_mutex_info_v1 PSI_mutex_info;
@@ -273,7 +273,12 @@ enum enum_indicator_type
 */
 #define CLIENT_REMEMBER_OPTIONS (1ULL << 31)
 
-/* MariaDB extended capability flags */
+/*
+  MariaDB extended capability flags. They are allocated together with
+  MariaDB Connector/C (libmariadb, include/mariadb_com.h), which defines
+  the same bits for the client side: a new flag takes the next bit that
+  is free in both, and is added to both.
+*/
 #define MARIADB_CLIENT_FLAGS_MASK 0xffffffff00000000ULL
 /* Client support progress indicator */
 #define MARIADB_CLIENT_PROGRESS (1ULL << 32)
@@ -292,12 +297,27 @@ enum enum_indicator_type
 /* permit sending unit result-set for BULK commands */
 #define MARIADB_CLIENT_BULK_UNIT_RESULTS (1ULL << 37)
 
+/* Compressed protocol uses a zstd stream instead of zlib, since 11.7 */
+#define MARIADB_CLIENT_ZSTD_COMPRESSION (1ULL << 38)
+
+/*
+  Client sends commands without waiting for the responses to the previous
+  ones (pipelining), since 11.7
+*/
+#define MARIADB_CLIENT_PIPELINE (1ULL << 39)
+
 #ifdef HAVE_COMPRESS
 #define CAN_CLIENT_COMPRESS CLIENT_COMPRESS
 #else
 #define CAN_CLIENT_COMPRESS 0
 #endif
 
+#ifdef HAVE_ZSTD_COMPRESS
+#define CAN_CLIENT_ZSTD_COMPRESS MARIADB_CLIENT_ZSTD_COMPRESSION
+#else
+#define CAN_CLIENT_ZSTD_COMPRESS 0
+#endif
+
 /*
   Gather all possible capabilities (flags) supported by the server
 
@@ -333,14 +353,17 @@ enum enum_indicator_type
                            MARIADB_CLIENT_EXTENDED_METADATA|\
                            MARIADB_CLIENT_CACHE_METADATA |\
                            CLIENT_CAN_HANDLE_EXPIRED_PASSWORDS |\
-                           MARIADB_CLIENT_BULK_UNIT_RESULTS)
+                           MARIADB_CLIENT_BULK_UNIT_RESULTS |\
+                           MARIADB_CLIENT_ZSTD_COMPRESSION |\
+                           MARIADB_CLIENT_PIPELINE)
 /*
   Switch off the flags that are optional and depending on build flags
   If any of the optional flags is supported by the build it will be switched
   on before sending to the client during the connection handshake.
 */
-#define CLIENT_BASIC_FLAGS ((CLIENT_ALL_FLAGS & ~CLIENT_SSL) \
-                                               & ~CLIENT_COMPRESS)
+#define CLIENT_BASIC_FLAGS (((CLIENT_ALL_FLAGS & ~CLIENT_SSL) \
+                                               & ~CLIENT_COMPRESS) \
+                                & ~MARIADB_CLIENT_ZSTD_COMPRESSION)
 
 enum mariadb_field_attr_t
 {
@@ -632,8 +655,12 @@ my_bool	my_net_init(NET *net, Vio* vio, void *thd, unsigned int my_flags);
 void	my_net_local_init(NET *net);
 void	net_end(NET *net);
 void	net_clear(NET *net, my_bool clear_buffer);
+my_bool	net_zstd_init(NET *net, int level);
+my_bool	net_zstd_active(const NET *net);
 my_bool net_realloc(NET *net, size_t length);
 my_bool	net_flush(NET *net);
+my_bool	net_has_pending_input(NET *net);
+my_bool	net_cork_pipeline(NET *net);
 my_bool	my_net_write(NET *net,const unsigned char *packet, size_t len);
 my_bool	net_write_command(NET *net,unsigned char command,
 			  const unsigned char *header, size_t head_len,
@@ -697,6 +724,8 @@ typedef struct st_udf_init
   /* Constants when using compression */
 #define NET_HEADER_SIZE 4		/* standard header size */
 #define COMP_HEADER_SIZE 3		/* compression header extra size */
+/* Largest window of the zstd stream of a connection, 256K */
+#define NET_ZSTD_WINDOW_LOG 18
 
   /* Prototypes to password functions */
 
@@ -34,6 +34,8 @@ struct st_net_server
   before_header_callback_fn m_before_header;
   after_header_callback_fn m_after_header;
   void *m_user_data;
+  /* Streaming state of the zstd compressed protocol, NULL for zlib */
+  void *m_compress_ctx;
 };
 
 typedef struct st_net_server NET_SERVER;
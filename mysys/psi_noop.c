@@ -772,6 +772,13 @@ static void set_prepared_stmt_text_noop(PSI_prepared_stmt *prepared_stmt NNN,
   return;
 }
 
+static void
+plan_prepared_stmt_noop(PSI_prepared_stmt *prepared_stmt NNN,
+                        PSI_prepared_stmt_plan_event event NNN)
+{
+  return;
+}
+
 void
 destroy_prepared_stmt_noop(PSI_prepared_stmt *prepared_stmt NNN)
 {
@@ -1050,7 +1057,8 @@ static PSI PSI_noop=
   start_metadata_wait_noop,
   end_metadata_wait_noop,
 
-  set_thread_peer_port_noop
+  set_thread_peer_port_noop,
+  plan_prepared_stmt_noop
 };
 
 /**
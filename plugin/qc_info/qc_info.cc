@@ -119,19 +119,15 @@ static ST_FIELD_INFO qc_info_fields[]=
 
 static const char unknown[]= "#UNKNOWN#";
 
-static int qc_info_fill_table(THD *thd, TABLE_LIST *tables,
-                                              COND *cond)
+/* Fill the table with the queries of one shard of the query cache */
+static int qc_info_fill_shard(THD *thd, TABLE *table,
+                              Accessible_Query_Cache *shard)
 {
   int status= 1;
   CHARSET_INFO *scs= system_charset_info;
-  TABLE *table= tables->table;
-  HASH *queries = qc->get_queries();
+  HASH *queries = shard->get_queries();
 
-  /* one must have PROCESS privilege to see others' queries */
-  if (check_global_access(thd, PROCESS_ACL, true))
-    return 0;
-
-  if (qc->try_lock(thd))
+  if (shard->try_lock(thd))
     return 0; // QC is or is being disabled
 
   /* loop through all queries in the query cache */
@@ -275,10 +271,26 @@ static int qc_info_fill_table(THD *thd, TABLE_LIST *tables,
   status = 0;
 
 cleanup:
-  qc->unlock();
+  shard->unlock();
   return status;
 }
 
+static int qc_info_fill_table(THD *thd, TABLE_LIST *tables,
+                                              COND *cond)
+{
+  /* one must have PROCESS privilege to see others' queries */
+  if (check_global_access(thd, PROCESS_ACL, true))
+    return 0;
+
+  for (uint i= 0; i < qc->shard_count(); i++)
+  {
+    if (qc_info_fill_shard(thd, tables->table,
+                           (Accessible_Query_Cache *) qc->shard(i)))
+      return 1;
+  }
+  return 0;
+}
+
 static int qc_info_plugin_init(void *p)
 {
   ST_SCHEMA_TABLE *schema= (ST_SCHEMA_TABLE *)p;
@@ -26,6 +26,7 @@
 #include "sql_priv.h"
 #include "filesort.h"
 #include <m_ctype.h>
+#include <mysys_err.h>                         // EE_WRITE
 #include "sql_sort.h"
 #include "probes_mysql.h"
 #include "sql_base.h"
@@ -35,6 +36,7 @@
 #include "filesort_utils.h"
 #include "sql_select.h"
 #include "debug_sync.h"
+#include "sql_parallel.h"
 
 	/* functions defined in this file */
 
@@ -362,6 +364,7 @@ SORT_INFO *filesort(THD *thd, TABLE *table, Filesort *filesort,
     param.try_to_pack_addons(thd->variables.max_length_for_sort_data);
     tracker->report_sort_keys_format(param.using_packed_sortkeys());
     param.using_pq= false;
+    param.max_threads= (uint) thd->variables.max_sort_threads;
 
     /* Allocate sort buffer. Use as much memory as possible. */
     size_t min_sort_memory= MY_MAX(MIN_SORT_MEMORY,
@@ -1118,7 +1121,9 @@ write_keys(Sort_param *param,  SORT_INFO *fs_info, uint count,
   Merge_chunk buffpek;
   DBUG_ENTER("write_keys");
 
-  fs_info->sort_buffer(param, count);
+  if (fs_info->sort_buffer(param, count))
+    status_var_increment(param->sort_form->in_use->status_var.
+                         filesort_radix_sorts_);
 
   if (!my_b_inited(tempfile) &&
       open_cached_file(tempfile, mysql_tmpdir, TEMP_PREFIX, DISK_CHUNK_SIZE,
@@ -1524,7 +1529,9 @@ static bool save_index(Sort_param *param, uint count,
   DBUG_ENTER("save_index");
   DBUG_ASSERT(table_sort->record_pointers == 0);
 
-  table_sort->sort_buffer(param, count);
+  if (table_sort->sort_buffer(param, count))
+    status_var_increment(param->sort_form->in_use->status_var.
+                         filesort_radix_sorts_);
 
   if (param->using_addon_fields())
   {
@@ -1554,6 +1561,162 @@ static bool save_index(Sort_param *param, uint count,
 }
 
 
+/*
+  Merging the groups of chunks of one pass of merge_many_buff() by several
+  threads.
+
+  The chunks of a group are adjacent in from_file, and merging them
+  produces as many bytes as they occupy (fewer if there is a LIMIT). So
+  the merged chunk of a group can be written into to_file at the position
+  where the first chunk of the group starts, and all groups can be merged
+  independently. Each worker thread merges with its own slice of the sort
+  buffer and writes through its own IO_CACHE by pwrite().
+*/
+
+class Merge_pass_job : public Parallel_job
+{
+public:
+  Merge_pass_job(Sort_param *param_arg, IO_CACHE *from_file_arg,
+                 IO_CACHE *to_file_arg, Sort_buffer sort_buffer_arg,
+                 uint workers_arg, Merge_chunk *buffpek_arg,
+                 uint maxbuffer_arg, Merge_chunk *merged_arg,
+                 my_off_t *ends_arg)
+    : param(param_arg), from_file(from_file_arg), to_file(to_file_arg),
+      sort_buffer(sort_buffer_arg), workers(workers_arg),
+      buffpek(buffpek_arg), maxbuffer(maxbuffer_arg), merged(merged_arg),
+      ends(ends_arg), error(0), error_errno(0)
+  {}
+
+  /* Same grouping as in the loop of merge_many_buff() */
+  static uint groups(uint maxbuffer)
+  {
+    return (maxbuffer - MERGEBUFF * 3 / 2) / MERGEBUFF + 2;
+  }
+
+  void run_task(uint group, uint worker) override;
+
+  Sort_param *param;
+  IO_CACHE *from_file, *to_file;
+  Sort_buffer sort_buffer;
+  uint workers;
+  Merge_chunk *buffpek;
+  uint maxbuffer;
+  Merge_chunk *merged;                /* The merged chunk of each group */
+  my_off_t *ends;                     /* Where the output of each group ends */
+  Atomic_counter<uint> error;
+  int error_errno;
+};
+
+
+static int merge_pass_write(IO_CACHE *info, const uchar *buffer, size_t count)
+{
+  if (mysql_file_pwrite(info->file, buffer, count, info->pos_in_file,
+                        MYF(MY_NABP)))
+    return info->error= -1;
+  info->pos_in_file+= count;
+  return 0;
+}
+
+
+void Merge_pass_job::run_task(uint group, uint worker)
+{
+  Sort_param worker_param(*param);
+  const size_t slice= sort_buffer.size() / workers;
+  Sort_buffer buffer(sort_buffer.array() + slice * worker, slice);
+  Merge_chunk *first= buffpek + group * MERGEBUFF;
+  Merge_chunk *last= (group + 1 < groups(maxbuffer) ?
+                      first + MERGEBUFF - 1 : buffpek + maxbuffer);
+  IO_CACHE out;
+
+  worker_param.max_keys_per_buffer= (uint) (slice / param->rec_length);
+  worker_param.not_killable= true;
+  if (init_io_cache(&out, to_file->file, DISK_CHUNK_SIZE, WRITE_CACHE,
+                    first->file_position(), 0, MYF(0)))
+    goto err;
+  out.write_function= merge_pass_write;
+  if (merge_buffers(&worker_param, from_file, &out, buffer, merged + group,
+                    first, last, 0) ||
+      flush_io_cache(&out))
+  {
+    end_io_cache(&out);
+    goto err;
+  }
+  ends[group]= my_b_tell(&out);
+  end_io_cache(&out);
+  return;
+
+err:
+  if (!error++)
+    error_errno= my_errno;
+}
+
+
+/**
+  Do one pass of merge_many_buff() by several threads
+
+  @retval -1  Error
+  @retval  0  The pass must be done by the connection thread
+  @retval  #  Number of chunks after the pass
+*/
+
+static int merge_pass_parallel(Sort_param *param, Sort_buffer sort_buffer,
+                               Merge_chunk *buffpek, uint maxbuffer,
+                               IO_CACHE *from_file, IO_CACHE *to_file)
+{
+  THD *thd= current_thd;
+  const uint groups= Merge_pass_job::groups(maxbuffer);
+  uint workers= MY_MIN(param->max_threads, groups);
+  Merge_chunk *merged;
+  my_off_t *ends, end= 0;
+  int res= -1;
+
+  set_if_smaller(workers, sort_buffer.size() /
+                          ((size_t) param->rec_length * MERGEBUFF2));
+  if (workers < 2 || (from_file->myflags & MY_ENCRYPT))
+    return 0;
+  if (to_file->file == -1 && real_open_cached_file(to_file))
+    return -1;
+  if (!my_multi_malloc(PSI_INSTRUMENT_ME, MYF(MY_WME | MY_THREAD_SPECIFIC),
+                       &merged, sizeof(Merge_chunk) * groups,
+                       &ends, sizeof(my_off_t) * groups, NullS))
+    return -1;
+
+  Merge_pass_job job(param, from_file, to_file, sort_buffer, workers,
+                     buffpek, maxbuffer, merged, ends);
+  if (run_parallel_job(thd, &job, groups, workers))
+  {
+    res= 0;
+    goto end;
+  }
+  if (thd->check_killed())
+    goto end;
+  if (job.error)
+  {
+    my_error(EE_WRITE, MYF(0), my_filename(to_file->file), job.error_errno);
+    goto end;
+  }
+
+  for (uint group= 0; group < groups; group++)
+  {
+    buffpek[group]= merged[group];
+    set_if_bigger(end, ends[group]);
+    thd->inc_status_sort_merge_passes();
+  }
+  thd->query_plan_fsort_passes+= groups;
+
+  /* The workers have written to_file bypassing its cache */
+  if (io_cache_tmp_file_track(to_file, end) ||
+      reinit_io_cache(to_file, READ_CACHE, 0L, 0, 1))
+    goto end;
+  to_file->end_of_file= end;
+  res= (int) groups;
+
+end:
+  my_free(merged);
+  return res;
+}
+
+
 /** Merge buffers to make < MERGEBUFF2 buffers. */
 
 int merge_many_buff(Sort_param *param, Sort_buffer sort_buffer,
@@ -1578,6 +1741,19 @@ int merge_many_buff(Sort_param *param, Sort_buffer sort_buffer,
       goto cleanup;
     if (reinit_io_cache(to_file, WRITE_CACHE,0L, 0, 0))
       goto cleanup;
+    if (param->max_threads > 1)
+    {
+      int chunks= merge_pass_parallel(param, sort_buffer, buffpek,
+                                      *maxbuffer, from_file, to_file);
+      if (chunks < 0)
+        goto cleanup;
+      if (chunks > 0)
+      {
+        temp=from_file; from_file=to_file; to_file=temp;
+        *maxbuffer= (uint) chunks - 1;
+        continue;
+      }
+    }
     lastbuff=buffpek;
     for (i= 0; i <= *maxbuffer - MERGEBUFF * 3 / 2 ; i+= MERGEBUFF)
     {
@@ -1762,8 +1938,12 @@ bool merge_buffers(Sort_param *param, IO_CACHE *from_file,
   THD* const thd=current_thd;
   DBUG_ENTER("merge_buffers");
 
-  thd->inc_status_sort_merge_passes();
-  thd->query_plan_fsort_passes++;
+  /* Passes done by filesort worker threads are counted by the caller */
+  if (likely(thd))
+  {
+    thd->inc_status_sort_merge_passes();
+    thd->query_plan_fsort_passes++;
+  }
 
   rec_length= param->rec_length;
   res_length= param->res_length;
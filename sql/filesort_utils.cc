@@ -20,6 +20,7 @@
 #include "sql_sort.h"
 #include "table.h"
 #include "optimizer_defaults.h"
+#include "sql_parallel.h"
 
 PSI_memory_key key_memory_Filesort_buffer_sort_keys;
 
@@ -383,32 +384,348 @@ void Filesort_buffer::free_sort_buffer()
 }
 
 
-void Filesort_buffer::sort_buffer(const Sort_param *param, uint count)
+/*
+  MSD radix sort of the record pointers of a sort buffer.
+
+  Sort keys that are not packed have a fixed length and are compared with
+  memcmp(), so they can be sorted byte by byte. The keys are distributed
+  into 256 buckets by their first byte, then every bucket is distributed
+  by the next byte and so on. Unlike the LSD radix sort of mysys, which
+  always makes one pass per byte of the key, only the bytes needed to tell
+  the keys apart are looked at: buckets of a few keys are finished by an
+  insertion sort and levels where all keys of a bucket have the same byte
+  (common prefixes, NULL flags, the high bytes of small numbers) cost a
+  single read pass.
+
+  The digit of every key of the bucket is read once per level into a byte
+  array, so that both the counting and the distribution pass run over
+  sequential memory. The sort is stable.
+*/
+
+/* Sort buffers with fewer keys by my_qsort2() */
+#define RADIX_SORT_MIN_KEYS 1000
+/* Buckets with no more keys than this are sorted by an insertion sort */
+#define RADIX_SORT_SMALL_BUCKET 16
+
+struct Radix_bucket
+{
+  uint start;                        /* Position of the first key */
+  uint count;                        /* Number of keys */
+  uint depth;                        /* Byte of the key to sort by */
+};
+
+
+/*
+  Size of the working memory of msd_radix_sort() for 'count' keys. Only
+  buckets of more than RADIX_SORT_SMALL_BUCKET keys are pushed on the
+  stack and those on it are disjoint, which bounds the stack size.
+*/
+
+static size_t radix_sort_memory(uint count)
+{
+  return ALIGN_SIZE((size_t) count * (sizeof(uchar*) + 1) +
+                    (count / RADIX_SORT_SMALL_BUCKET + 1) *
+                    sizeof(Radix_bucket));
+}
+
+
+static inline bool radix_sort_applicable(const Sort_param *param, uint count)
+{
+  return !param->using_packed_sortkeys() && count >= RADIX_SORT_MIN_KEYS;
+}
+
+
+static void radix_insertion_sort(uchar **keys, uint count, size_t depth,
+                                 size_t length)
+{
+  for (uint i= 1; i < count; i++)
+  {
+    uchar *key= keys[i];
+    uint j= i;
+    for (; j > 0 && memcmp(keys[j - 1] + depth, key + depth,
+                           length - depth) > 0; j--)
+      keys[j]= keys[j - 1];
+    keys[j]= key;
+  }
+}
+
+
+/**
+  Sort fixed length keys by an MSD radix sort
+
+  @param keys    Pointers to the keys
+  @param count   Number of keys
+  @param length  Length of the keys, they are compared with memcmp()
+  @param memory  Working memory of radix_sort_memory(count) bytes
+*/
+
+static void msd_radix_sort(uchar **keys, uint count, size_t length,
+                           uchar *memory)
+{
+  uchar **tmp= (uchar**) memory;
+  Radix_bucket *stack= (Radix_bucket*) (tmp + count);
+  uchar *digits= (uchar*) (stack + count / RADIX_SORT_SMALL_BUCKET + 1);
+  uint top= 0;
+  uint counts[256];
+
+  if (count <= RADIX_SORT_SMALL_BUCKET)
+  {
+    radix_insertion_sort(keys, count, 0, length);
+    return;
+  }
+  stack[top].start= 0;
+  stack[top].count= count;
+  stack[top++].depth= 0;
+
+  while (top)
+  {
+    Radix_bucket bucket= stack[--top];
+    uchar **bkeys= keys + bucket.start;
+    uint depth= bucket.depth, pos;
+
+    for (;;)
+    {
+      if (depth == length)
+        break;                               /* All keys are equal */
+      memset(counts, 0, sizeof(counts));
+      for (uint i= 0; i < bucket.count; i++)
+        counts[digits[i]= bkeys[i][depth]]++;
+      if (counts[digits[0]] != bucket.count)
+        break;
+      depth++;                               /* Common byte, skip it */
+    }
+    if (depth == length)
+      continue;
+
+    uint offsets[256];
+    pos= 0;
+    for (uint d= 0; d < 256; d++)
+    {
+      offsets[d]= pos;
+      pos+= counts[d];
+    }
+    for (uint i= 0; i < bucket.count; i++)
+      tmp[offsets[digits[i]]++]= bkeys[i];
+    memcpy(bkeys, tmp, bucket.count * sizeof(uchar*));
+
+    if (++depth == length)
+      continue;
+    pos= 0;
+    for (uint d= 0; d < 256; d++)
+    {
+      uint n= counts[d];
+      if (n > RADIX_SORT_SMALL_BUCKET)
+      {
+        DBUG_ASSERT(top <= count / RADIX_SORT_SMALL_BUCKET);
+        stack[top].start= bucket.start + pos;
+        stack[top].count= n;
+        stack[top++].depth= depth;
+      }
+      else if (n > 1)
+        radix_insertion_sort(bkeys + pos, n, depth, length);
+      pos+= n;
+    }
+  }
+}
+
+
+/*
+  Sorting the array of record pointers of a sort buffer by several threads.
+
+  The array is split into segments that are sorted independently (by a
+  radix sort if applicable, otherwise by my_qsort2()). Then pairs of
+  adjacent sorted runs of segments are merged, all pairs of a level in
+  parallel, going back and forth between the array and an auxiliary one,
+  until one run is left.
+*/
+
+class Sort_keys_job : public Parallel_job
+{
+public:
+  Sort_keys_job(const Sort_param *param, uchar **keys_arg, uchar **aux_arg,
+                uchar *radix_memory_arg, size_t radix_memory_size_arg,
+                uint count_arg, uint segments_arg)
+    : keys(keys_arg), aux(aux_arg), src(keys_arg), dst(aux_arg),
+      radix_memory(radix_memory_arg),
+      radix_memory_size(radix_memory_size_arg),
+      count(count_arg), segments(segments_arg), width(0),
+      sort_length(param->sort_length)
+  {
+    cmp= param->get_compare_function();
+    cmp_arg= param->get_compare_argument(&sort_length);
+  }
+
+  /* Number of tasks of the current level, segments are sorted at level 0 */
+  uint tasks() const
+  {
+    return width ? (segments + 2 * width - 1) / (2 * width) : segments;
+  }
+  bool next_level()
+  {
+    if (width)
+    {
+      uchar **tmp= src;
+      src= dst;
+      dst= tmp;
+    }
+    width= width ? width * 2 : 1;
+    return width < segments;
+  }
+  /* Where the sorted array is after the last level */
+  uchar **result() const { return src; }
+
+  void run_task(uint task, uint worker) override
+  {
+    if (!width)
+      sort_segment(task, worker);
+    else
+      merge_runs(task);
+  }
+
+private:
+  uint segment_start(uint n) const
+  {
+    return (uint) ((ulonglong) count * n / segments);
+  }
+  void sort_segment(uint n, uint worker);
+  void merge_runs(uint n);
+
+  uchar **keys, **aux;
+  uchar **src, **dst;
+  uchar *radix_memory;               /* NULL if radix sort is not used */
+  size_t radix_memory_size;          /* Size of radix_memory per worker */
+  uint count, segments;
+  uint width;                        /* Number of segments in a run */
+  size_t sort_length;
+  qsort2_cmp cmp;
+  void *cmp_arg;
+};
+
+
+void Sort_keys_job::sort_segment(uint n, uint worker)
+{
+  uint start= segment_start(n);
+  uint rows= segment_start(n + 1) - start;
+
+  if (radix_memory)
+    msd_radix_sort(keys + start, rows, sort_length,
+                   radix_memory + worker * radix_memory_size);
+  else
+    my_qsort2(keys + start, rows, sizeof(uchar*), cmp, cmp_arg);
+}
+
+
+void Sort_keys_job::merge_runs(uint n)
+{
+  uint start= segment_start(MY_MIN(2 * width * n, segments));
+  uint middle= segment_start(MY_MIN(2 * width * n + width, segments));
+  uint end= segment_start(MY_MIN(2 * width * (n + 1), segments));
+  uchar **left= src + start, **left_end= src + middle;
+  uchar **right= left_end, **right_end= src + end;
+  uchar **to= dst + start;
+
+  while (left < left_end && right < right_end)
+  {
+    if (cmp(cmp_arg, left, right) <= 0)
+      *to++= *left++;
+    else
+      *to++= *right++;
+  }
+  if (left < left_end)
+    memcpy(to, left, (left_end - left) * sizeof(uchar*));
+  else if (right < right_end)
+    memcpy(to, right, (right_end - right) * sizeof(uchar*));
+}
+
+
+/**
+  Sort the record pointers by several threads
+
+  @param[out] radix_used  Set if the segments were sorted by a radix sort
+
+  @retval TRUE   The keys have been sorted
+  @retval FALSE  Parallel sorting is not possible, sort by one thread
+*/
+
+static bool parallel_sort_keys(const Sort_param *param, uchar **keys,
+                               uint count, bool *radix_used)
+{
+  uint segments= MY_MIN(param->max_threads,
+                        count / MIN_SORT_KEYS_PER_THREAD);
+  uchar **aux;
+  uchar *radix_memory= NULL;
+  size_t radix_memory_size= 0;
+
+  if (segments < 2 ||
+      !(aux= (uchar**) my_malloc(PSI_INSTRUMENT_ME, count * sizeof(uchar*),
+                                 MYF(MY_THREAD_SPECIFIC))))
+    return FALSE;
+
+  /*
+    Segments have at least MIN_SORT_KEYS_PER_THREAD keys, so the radix sort
+    is applicable to them whenever it is to the whole buffer.
+  */
+  if (radix_sort_applicable(param, count))
+  {
+    radix_memory_size= radix_sort_memory(count / segments + 1);
+    radix_memory= (uchar*) my_malloc(PSI_INSTRUMENT_ME,
+                                     segments * radix_memory_size,
+                                     MYF(MY_THREAD_SPECIFIC));
+  }
+  *radix_used= radix_memory != NULL;
+
+  Sort_keys_job job(param, keys, aux, radix_memory, radix_memory_size,
+                    count, segments);
+
+  do
+  {
+    if (run_parallel_job(NULL, &job, job.tasks(), segments))
+    {
+      /* No threads could be created, do the rest of the work here */
+      for (uint task= 0; task < job.tasks(); task++)
+        job.run_task(task, 0);
+    }
+  } while (job.next_level());
+
+  if (job.result() != keys)
+    memcpy(keys, aux, count * sizeof(uchar*));
+  my_free(radix_memory);
+  my_free(aux);
+  return TRUE;
+}
+
+
+bool Filesort_buffer::sort_buffer(const Sort_param *param, uint count)
 {
   size_t size= param->sort_length;
+  bool radix_used= false;
   m_sort_keys= get_sort_keys();
 
   if (count <= 1 || size == 0)
-    return;
+    return false;
 
   // don't reverse for PQ, it is already done
   if (!param->using_pq)
     reverse_record_pointers();
 
-  uchar **buffer= NULL;
-  if (!param->using_packed_sortkeys() &&
-      radixsort_is_applicable(count, param->sort_length) &&
-      (buffer= (uchar**) my_malloc(PSI_INSTRUMENT_ME, count*sizeof(char*),
-                                   MYF(MY_THREAD_SPECIFIC))))
+  if (param->max_threads > 1 &&
+      parallel_sort_keys(param, m_sort_keys, count, &radix_used))
+    return radix_used;
+
+  uchar *memory;
+  if (radix_sort_applicable(param, count) &&
+      (memory= (uchar*) my_malloc(PSI_INSTRUMENT_ME, radix_sort_memory(count),
+                                  MYF(MY_THREAD_SPECIFIC))))
   {
-    radixsort_for_str_ptr(m_sort_keys, count, param->sort_length, buffer);
-    my_free(buffer);
-    return;
+    msd_radix_sort(m_sort_keys, count, param->sort_length, memory);
+    my_free(memory);
+    return true;
   }
 
   my_qsort2(m_sort_keys, count, sizeof(uchar*),
             param->get_compare_function(),
             param->get_compare_argument(&size));
+  return false;
 }
 
 
@@ -3756,6 +3756,51 @@ int handler::ha_rnd_next(uchar *buf)
   DBUG_RETURN(result);
 }
 
+/**
+  Read a batch of rows of a table scan, see rnd_next_batch()
+
+  @note
+    The statistics are updated as if ha_rnd_next() was called for each
+    row. The rows are counted as examined when the batch is read, so
+    LIMIT ROWS EXAMINED may stop the statement up to one batch later.
+*/
+
+int handler::ha_rnd_next_batch(uchar *buf, size_t stride, uint max_rows,
+                               uint *n_rows)
+{
+  int result;
+  THD *thd= table->in_use;
+  DBUG_ENTER("handler::ha_rnd_next_batch");
+  DBUG_ASSERT(table_share->tmp_table != NO_TMP_TABLE ||
+              m_lock_type != F_UNLCK);
+  DBUG_ASSERT(inited == RND);
+  DBUG_ASSERT(max_rows > 0 && stride >= table_share->reclength);
+
+  *n_rows= 0;
+  TABLE_IO_WAIT(tracker, PSI_TABLE_FETCH_ROW, MAX_KEY, result,
+    { result= rnd_next_batch(buf, stride, max_rows, n_rows); })
+  if (result == HA_ERR_UNSUPPORTED)
+    DBUG_RETURN(result);
+
+  if (!result)
+  {
+    DBUG_ASSERT(*n_rows > 0 && *n_rows <= max_rows);
+    if (likely(!internal_tmp_table))
+      rows_stats.read+= *n_rows;
+    else
+      rows_stats.tmp_read+= *n_rows;
+    thd->status_var.ha_read_rnd_next_count+= *n_rows;
+    thd->accessed_rows_and_keys+= *n_rows;
+    if (thd->accessed_rows_and_keys > thd->lex->limit_rows_examined_cnt)
+      thd->set_killed(ABORT_QUERY);
+  }
+  else
+    increment_statistics(&SSV::ha_read_rnd_next_count);
+
+  table->status=result ? STATUS_NOT_FOUND: 0;
+  DBUG_RETURN(result);
+}
+
 int handler::ha_rnd_pos(uchar *buf, uchar *pos)
 {
   int result;
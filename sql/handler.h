@@ -3157,6 +3157,24 @@ class Handler_share
   virtual ~Handler_share() = default;
 };
 
+
+/**
+  Receiver of the rows of handler::parallel_scan().
+
+  add_row() is called concurrently by the threads of the scan, each with
+  its own number 'worker' (less than the number of threads that was asked
+  for) and its own record buffer. The buffer has the layout of
+  table->record[0], but only the columns in table->read_set are set.
+  The threads have no THD.
+*/
+class Parallel_scan_rows
+{
+public:
+  virtual ~Parallel_scan_rows() = default;
+  /* Returns true to stop the scan */
+  virtual bool add_row(uint worker, const uchar *record)= 0;
+};
+
 enum class Compare_keys : uint32_t
 {
   Equal= 0,
@@ -4082,6 +4100,19 @@ class handler :public Sql_alloc
   */
   virtual int pre_records() { return 0; }
   virtual ha_rows records() { return stats.records; }
+  /**
+    Read all rows of the table by up to n_threads threads and pass them to
+    rows->add_row() (see Parallel_scan_rows), in no particular order.
+    The table must be locked and no scan may be active.
+
+    @retval 0                   all rows were read, or the receiver
+                                stopped the scan
+    @retval HA_ERR_UNSUPPORTED  the engine cannot do it for this table or
+                                statement; no row was passed
+    @retval other               error
+  */
+  virtual int parallel_scan(uint n_threads, Parallel_scan_rows *rows)
+  { return HA_ERR_UNSUPPORTED; }
   /**
     Return upper bound of current number of records in the table
     (max. of how many records one will retrieve when doing a full table scan)
@@ -4370,6 +4401,27 @@ class handler :public Sql_alloc
 public:
   virtual int ft_read(uchar *buf) { return HA_ERR_WRONG_COMMAND; }
   virtual int rnd_next(uchar *buf)=0;
+  /**
+    Read up to max_rows next rows of a table scan (rnd_init(true)) into
+    buf, the row number i at buf + i * stride in the format of
+    table->record[0]. Only the columns of table->read_set are set, and
+    virtual columns are not computed.
+
+    The rows are read ahead of their use, so afterwards the position of
+    the handler is not the one of any particular row: position(),
+    update_row(), delete_row() and unlock_row() must not be used for the
+    returned rows. The engine must refuse locking reads.
+
+    @param[out] n_rows  Number of rows read, at least 1 if 0 is returned
+
+    @retval 0                   Rows were read
+    @retval HA_ERR_END_OF_FILE  No more rows
+    @retval HA_ERR_UNSUPPORTED  Use rnd_next(); nothing was read
+    @retval other               Error
+  */
+  virtual int rnd_next_batch(uchar *buf, size_t stride, uint max_rows,
+                             uint *n_rows)
+  { return HA_ERR_UNSUPPORTED; }
   virtual int rnd_pos(uchar * buf, uchar *pos)=0;
   /**
     This function only works for handlers having
@@ -4397,6 +4449,8 @@ class handler :public Sql_alloc
   inline int ha_ft_read(uchar *buf);
   inline void ha_ft_end() { ft_end(); ft_handler=NULL; }
   int ha_rnd_next(uchar *buf);
+  int ha_rnd_next_batch(uchar *buf, size_t stride, uint max_rows,
+                        uint *n_rows);
   int ha_rnd_pos(uchar *buf, uchar *pos);
   inline int ha_rnd_pos_by_record(uchar *buf);
   inline int ha_read_first_row(uchar *buf, uint primary_key);
@@ -618,7 +618,8 @@ Item* Item::transform(THD *thd, Item_transformer transformer, uchar *arg)
   Create and set up an expression cache for this item
 
   @param thd             Thread handle
-  @param depends_on      List of the expression parameters
+  @param stats           Statistics of the caches of the subquery kept over
+                         the executions of the statement
 
   @details
   The function creates an expression cache for an item and its parameters
@@ -629,14 +630,14 @@ Item* Item::transform(THD *thd, Item_transformer transformer, uchar *arg)
   A pointer to created wrapper item if successful, NULL - otherwise
 */
 
-Item* Item::set_expr_cache(THD *thd)
+Item* Item::set_expr_cache(THD *thd, Expression_cache_stats *stats)
 {
   DBUG_ENTER("Item::set_expr_cache");
   Item_cache_wrapper *wrapper;
   if (likely((wrapper= new (thd->mem_root) Item_cache_wrapper(thd, this))) &&
       likely(!wrapper->fix_fields(thd, (Item**)&wrapper)))
   {
-    if (likely(!wrapper->set_cache(thd)))
+    if (likely(!wrapper->set_cache(thd, stats)))
       DBUG_RETURN(wrapper);
   }
   DBUG_RETURN(NULL);
@@ -9002,7 +9003,8 @@ Item_cache_wrapper::~Item_cache_wrapper()
 }
 
 Item_cache_wrapper::Item_cache_wrapper(THD *thd, Item *item_arg):
-  Item_result_field(thd), orig_item(item_arg), expr_cache(NULL), expr_value(NULL)
+  Item_result_field(thd), orig_item(item_arg), expr_cache(NULL), expr_value(NULL),
+  cache_stats(NULL)
 {
   DBUG_ASSERT(orig_item->fixed());
   Type_std_attributes::set(orig_item);
@@ -9026,7 +9028,18 @@ void Item_cache_wrapper::init_on_demand()
 {
     if (!expr_cache->is_inited())
     {
+      Expression_cache *hash_cache;
       orig_item->get_cache_parameters(parameters);
+      /* Use the hash table if the parameters and the value allow it */
+      if ((hash_cache= Expression_cache_hash::create(current_thd, parameters,
+                                                     expr_value,
+                                                     cache_stats)))
+      {
+        Expression_cache_tracker *tracker= expr_cache->get_tracker();
+        delete expr_cache;
+        expr_cache= hash_cache;
+        expr_cache->set_tracker(tracker);
+      }
       expr_cache->init();
     }
 }
@@ -9097,23 +9110,27 @@ void Item_cache_wrapper::cleanup()
   Create an expression cache that uses a temporary table
 
   @param thd           Thread handle
-  @param depends_on    Parameters of the expression to create cache for
+  @param stats         Statistics of the subquery over the executions of
+                       the statement, or NULL
 
   @details
   The function takes 'depends_on' as the list of all parameters for
   the expression wrapped into this object and creates an expression
   cache in a temporary table containing the field for the parameters
-  and the result of the expression.
+  and the result of the expression. When the parameters are known,
+  init_on_demand() may replace it with an Expression_cache_hash.
 
   @retval FALSE OK
   @retval TRUE  Error
 */
 
-bool Item_cache_wrapper::set_cache(THD *thd)
+bool Item_cache_wrapper::set_cache(THD *thd, Expression_cache_stats *stats)
 {
   DBUG_ENTER("Item_cache_wrapper::set_cache");
   DBUG_ASSERT(expr_cache == 0);
-  expr_cache= new Expression_cache_tmptable(thd, parameters, expr_value);
+  cache_stats= stats;
+  expr_cache= new Expression_cache_tmptable(thd, parameters, expr_value,
+                                            stats);
   DBUG_RETURN(expr_cache == NULL);
 }
 
@@ -9124,7 +9141,7 @@ Expression_cache_tracker* Item_cache_wrapper::init_tracker(MEM_ROOT *mem_root)
     Expression_cache_tracker* tracker=
       new(mem_root) Expression_cache_tracker(expr_cache);
     if (tracker)
-      ((Expression_cache_tmptable *)expr_cache)->set_tracker(tracker);
+      expr_cache->set_tracker(tracker);
     return tracker;
   }
   return NULL;
@@ -667,6 +667,7 @@ class st_select_lex_unit;
 
 class Item_func_not;
 class Item_splocal;
+class Expression_cache_stats;
 
 /**
   String_copier that sends Item specific warnings.
@@ -2683,7 +2684,7 @@ class Item :public Value_source,
   */
   virtual bool is_outer_field() const { DBUG_ASSERT(fixed()); return FALSE; }
 
-  Item* set_expr_cache(THD *thd);
+  Item* set_expr_cache(THD *thd, Expression_cache_stats *stats);
 
   virtual Item_equal *get_item_equal() { return NULL; }
   virtual void set_item_equal(Item_equal *item_eq) {};
@@ -6151,6 +6152,26 @@ class Item_cache;
 class Expression_cache;
 class Expression_cache_tracker;
 
+/**
+  Hits and misses of the expression caches of a subquery over the
+  executions of a prepared statement. They decide whether the next
+  execution creates a cache at all.
+*/
+
+class Expression_cache_stats
+{
+public:
+  ulonglong hit, miss;
+  /* Executions that did not use a cache because of a poor hit rate */
+  uint skipped;
+
+  Expression_cache_stats() : hit(0), miss(0), skipped(0) {}
+  bool use_cache();
+  /* TRUE if the earlier executions had a good hit rate */
+  bool is_proven() const;
+  void add(ulong h, ulong m) { hit+= h; miss+= m; }
+};
+
 /**
   The objects of this class can store its values in an expression cache.
 */
@@ -6172,6 +6193,9 @@ class Item_cache_wrapper :public Item_result_field
 
   List<Item> parameters;
 
+  /* Statistics of the cached subquery, NULL if not kept */
+  Expression_cache_stats *cache_stats;
+
   Item *check_cache();
   void cache();
   void init_on_demand();
@@ -6182,7 +6206,7 @@ class Item_cache_wrapper :public Item_result_field
 
   Type type() const override { return EXPR_CACHE_ITEM; }
   Type real_type() const override { return orig_item->type(); }
-  bool set_cache(THD *thd);
+  bool set_cache(THD *thd, Expression_cache_stats *stats);
   Expression_cache_tracker* init_tracker(MEM_ROOT *mem_root);
   bool fix_fields(THD *thd, Item **it) override;
   void cleanup() override;
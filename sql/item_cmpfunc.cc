@@ -1575,9 +1575,14 @@ Item *Item_in_optimizer::expr_cache_insert_transformer(THD *thd, uchar *unused)
   if (expr_cache)
     DBUG_RETURN(expr_cache);
 
-  if (args[1]->expr_cache_is_needed(thd) &&
-      (expr_cache= set_expr_cache(thd)))
-    DBUG_RETURN(expr_cache);
+  if (args[1]->expr_cache_is_needed(thd))
+  {
+    /* Only subqueries need an expression cache */
+    Expression_cache_stats *stats=
+      &((Item_subselect *) args[1])->expr_cache_stats;
+    if (stats->use_cache() && (expr_cache= set_expr_cache(thd, stats)))
+      DBUG_RETURN(expr_cache);
+  }
 
   DBUG_RETURN(this);
 }
@@ -1403,8 +1403,8 @@ Item* Item_singlerow_subselect::expr_cache_insert_transformer(THD *tmp_thd,
   if (expr_cache)
     DBUG_RETURN(expr_cache);
 
-  if (expr_cache_is_needed(tmp_thd) &&
-      (expr_cache= set_expr_cache(tmp_thd)))
+  if (expr_cache_is_needed(tmp_thd) && expr_cache_stats.use_cache() &&
+      (expr_cache= set_expr_cache(tmp_thd, &expr_cache_stats)))
   {
     init_expr_cache_tracker(tmp_thd);
     DBUG_RETURN(expr_cache);
@@ -1822,7 +1822,8 @@ Item* Item_exists_subselect::expr_cache_insert_transformer(THD *tmp_thd,
     DBUG_RETURN(expr_cache);
 
   if (substype() == EXISTS_SUBS && expr_cache_is_needed(tmp_thd) &&
-      (expr_cache= set_expr_cache(tmp_thd)))
+      expr_cache_stats.use_cache() &&
+      (expr_cache= set_expr_cache(tmp_thd, &expr_cache_stats)))
   {
     init_expr_cache_tracker(tmp_thd);
     DBUG_RETURN(expr_cache);
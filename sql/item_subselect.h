@@ -109,6 +109,8 @@ class Item_subselect :public Item_result_field,
   /* Cached buffers used when calling filesort in sub queries */
   Filesort_buffer filesort_buffer;
   LEX_STRING sortbuffer;
+  /* Hit statistics of the expression caches of the previous executions */
+  Expression_cache_stats expr_cache_stats;
   /* A reference from inside subquery predicate to somewhere outside of it */
   class Ref_to_outside : public Sql_alloc
   {
@@ -38,10 +38,15 @@ static PSI_memory_key key_memory_MDL_context_acquire_locks;
 
 #ifdef HAVE_PSI_INTERFACE
 static PSI_mutex_key key_MDL_wait_LOCK_wait_status;
+static PSI_mutex_key key_MDL_context_LOCK_fast_path;
+static PSI_mutex_key key_LOCK_mdl_fast_path_contexts;
 
 static PSI_mutex_info all_mdl_mutexes[]=
 {
-  { &key_MDL_wait_LOCK_wait_status, "MDL_wait::LOCK_wait_status", 0}
+  { &key_MDL_wait_LOCK_wait_status, "MDL_wait::LOCK_wait_status", 0},
+  { &key_MDL_context_LOCK_fast_path, "MDL_context::LOCK_fast_path", 0},
+  { &key_LOCK_mdl_fast_path_contexts, "LOCK_mdl_fast_path_contexts",
+    PSI_FLAG_GLOBAL}
 };
 
 static PSI_rwlock_key key_MDL_lock_rwlock;
@@ -161,6 +166,16 @@ void MDL_key::init_psi_keys()
 #endif
 
 static bool mdl_initialized= 0;
+my_bool mdl_fast_path;
+
+/**
+  Contexts which have been granted locks by the fast path, so that
+  mdl_iterate() can find the tickets that are not in MDL_lock::m_granted.
+  A context is added when it gets its first fast path ticket, and removed
+  when it is destroyed.
+*/
+static ilist<MDL_context, MDL_context_fast_path_tag> mdl_fast_path_contexts;
+static mysql_mutex_t LOCK_mdl_fast_path_contexts;
 
 
 /**
@@ -174,6 +189,8 @@ class MDL_map
   void init();
   void destroy();
   MDL_lock *find_or_insert(LF_PINS *pins, const MDL_key *key);
+  MDL_lock *try_fast_path(LF_PINS *pins, const MDL_key *key, int slot,
+                          uint shard);
   unsigned long get_lock_owner(LF_PINS *pins, const MDL_key *key);
   void remove(LF_PINS *pins, MDL_lock *lock);
   LF_PINS *get_pins() { return lf_hash_get_pins(&m_locks); }
@@ -422,6 +439,11 @@ class MDL_lock
     virtual bool needs_notification(const MDL_ticket *ticket) const = 0;
     virtual bool conflicting_locks(const MDL_ticket *ticket) const = 0;
     virtual bitmap_t hog_lock_types_bitmap() const = 0;
+    /**
+      Counter of the fast path state for each lock type, -1 for the
+      obtrusive types, see MDL_lock::m_fast_path
+    */
+    virtual const int8 *fast_path_slots() const = 0;
     virtual ~MDL_lock_strategy() = default;
   };
 
@@ -458,9 +480,12 @@ class MDL_lock
     */
     bitmap_t hog_lock_types_bitmap() const override
     { return 0; }
+    const int8 *fast_path_slots() const override
+    { return m_fast_path_slots; }
   private:
     static const bitmap_t m_granted_incompatible[MDL_TYPE_END];
     static const bitmap_t m_waiting_incompatible[MDL_TYPE_END];
+    static const int8 m_fast_path_slots[MDL_TYPE_END];
   };
 
 
@@ -505,10 +530,13 @@ class MDL_lock
               MDL_BIT(MDL_SHARED_NO_READ_WRITE) |
               MDL_BIT(MDL_EXCLUSIVE));
     }
+    const int8 *fast_path_slots() const override
+    { return m_fast_path_slots; }
 
   private:
     static const bitmap_t m_granted_incompatible[MDL_TYPE_END];
     static const bitmap_t m_waiting_incompatible[MDL_TYPE_END];
+    static const int8 m_fast_path_slots[MDL_TYPE_END];
   };
 
 
@@ -543,9 +571,12 @@ class MDL_lock
     */
     bitmap_t hog_lock_types_bitmap() const override
     { return 0; }
+    const int8 *fast_path_slots() const override
+    { return m_fast_path_slots; }
   private:
     static const bitmap_t m_granted_incompatible[MDL_BACKUP_END];
     static const bitmap_t m_waiting_incompatible[MDL_BACKUP_END];
+    static const int8 m_fast_path_slots[MDL_BACKUP_END];
   };
 
 public:
@@ -586,11 +617,116 @@ class MDL_lock
   */
   mysql_prlock_t m_rwlock;
 
+  /**
+    State of the fast path of the lock.
+
+    The unobtrusive lock types (see MDL_lock_strategy::fast_path_slots())
+    are compatible with each other, and only conflict with the obtrusive
+    ones. While the lock has no granted or waiting obtrusive tickets, the
+    unobtrusive requests are granted by incrementing a counter in
+    m_fast_path, without m_rwlock and without adding the ticket to
+    m_granted. The types which conflict with the same requests share a
+    counter.
+
+    The counters are sharded by CPU, so that the requests of threads
+    running on different CPUs do not update the same cache line. Each
+    shard has FAST_PATH_SLOTS counters of FAST_PATH_COUNTER_BITS bits.
+    A ticket is released from the shard it was counted in, see
+    MDL_ticket::m_fast_path_shard.
+
+    m_fast_path_flags has:
+    - FAST_PATH_HAS_OBTRUSIVE: m_granted or m_waiting has an obtrusive
+      ticket, or an obtrusive request holding m_rwlock is being checked.
+      Set and reset under m_rwlock.
+    - FAST_PATH_DESTROYED: the lock is being removed from MDL_map and can
+      not be granted anymore.
+
+    The fast path increments its counter before it checks the flags, an
+    obtrusive request or try_destroy() sets its flag before it reads the
+    counters: either the request sees the counted ticket, or the fast
+    path sees the flag and takes its ticket back. An obtrusive request
+    treats all the counted tickets as tickets of other contexts: the
+    requestor materializes its own fast path tickets first, see
+    MDL_context::materialize_fast_path_locks().
+  */
+  std::atomic<uint> m_fast_path_flags;
+
+  static const uint FAST_PATH_SHARDS= 8;
+  static const uint FAST_PATH_SLOTS= 4;
+  static const uint FAST_PATH_COUNTER_BITS= 16;
+  static const uint64_t FAST_PATH_COUNTER_MAX=
+    (1ULL << FAST_PATH_COUNTER_BITS) - 1;
+  static const uint FAST_PATH_HAS_OBTRUSIVE= 1;
+  static const uint FAST_PATH_DESTROYED= 2;
+
+  struct fast_path_shard
+  {
+    std::atomic<uint64_t> counters;
+    char pad[CPU_LEVEL1_DCACHE_LINESIZE - sizeof(std::atomic<uint64_t>)];
+  };
+  fast_path_shard m_fast_path[FAST_PATH_SHARDS];
+
+  /**
+    @return the counters of all the shards ORed together: a counter of
+    the result is non-zero if some ticket is counted in it
+  */
+  uint64_t fast_path_counters() const
+  {
+    uint64_t counters= 0;
+    for (const fast_path_shard &shard : m_fast_path)
+      counters|= shard.counters.load();
+    return counters;
+  }
+
+  void fast_path_reset()
+  {
+    m_fast_path_flags.store(0, std::memory_order_relaxed);
+    for (fast_path_shard &shard : m_fast_path)
+      shard.counters.store(0, std::memory_order_relaxed);
+  }
+
   bool is_empty() const
   {
-    return (m_granted.is_empty() && m_waiting.is_empty());
+    return (m_granted.is_empty() && m_waiting.is_empty() &&
+            !fast_path_counters());
   }
 
+  /**
+    Fast path counter of a lock type in a namespace
+
+    @return the slot, or -1 if the type can not be granted by the fast path
+  */
+  static int fast_path_slot(MDL_key::enum_mdl_namespace mdl_namespace,
+                            enum_mdl_type type)
+  {
+    switch (mdl_namespace) {
+    case MDL_key::BACKUP:
+      return m_backup_lock_strategy.fast_path_slots()[type];
+    case MDL_key::SCHEMA:
+      return m_scoped_lock_strategy.fast_path_slots()[type];
+    case MDL_key::USER_LOCK:
+      return -1;
+    default:
+      return m_object_lock_strategy.fast_path_slots()[type];
+    }
+  }
+
+  static uint64_t fast_path_increment(int slot)
+  { return 1ULL << (slot * FAST_PATH_COUNTER_BITS); }
+
+  bool fast_path_acquire(LF_PINS *pins, int slot, uint shard);
+  void fast_path_release(LF_PINS *pins, int slot, uint shard);
+  void fast_path_materialize(MDL_ticket *ticket, uint shard);
+  bitmap_t fast_path_granted_bitmap() const;
+  void update_fast_path_flag();
+  void set_fast_path_obtrusive()
+  {
+    if (!(m_fast_path_flags.load(std::memory_order_relaxed) &
+          FAST_PATH_HAS_OBTRUSIVE))
+      m_fast_path_flags.fetch_or(FAST_PATH_HAS_OBTRUSIVE);
+  }
+  bool try_destroy();
+
   const bitmap_t *incompatible_granted_types_bitmap() const
   { return m_strategy->incompatible_granted_types_bitmap(); }
   const bitmap_t *incompatible_waiting_types_bitmap() const
@@ -613,6 +749,11 @@ class MDL_lock
 
   bool needs_notification(const MDL_ticket *ticket) const
   { return m_strategy->needs_notification(ticket); }
+  /*
+    Tickets granted by the fast path are not in m_granted, see
+    MDL_context::notify_fast_path_locks(). Contexts that need thr_lock
+    aborts never keep such tickets.
+  */
   void notify_conflicting_locks(MDL_context *ctx, bool abort_blocking)
   {
     for (const auto &conflicting_ticket : m_granted)
@@ -653,7 +794,10 @@ class MDL_lock
   MDL_lock()
     : m_hog_lock_count(0),
       m_strategy(0)
-  { mysql_prlock_init(key_MDL_lock_rwlock, &m_rwlock); }
+  {
+    mysql_prlock_init(key_MDL_lock_rwlock, &m_rwlock);
+    fast_path_reset();
+  }
 
   MDL_lock(const MDL_key *key_arg)
   : key(key_arg),
@@ -662,6 +806,7 @@ class MDL_lock
   {
     DBUG_ASSERT(key_arg->mdl_namespace() == MDL_key::BACKUP);
     mysql_prlock_init(key_MDL_lock_rwlock, &m_rwlock);
+    fast_path_reset();
   }
 
   ~MDL_lock()
@@ -680,6 +825,7 @@ class MDL_lock
     const MDL_key *key_arg= static_cast<const MDL_key *>(_key_arg);
     DBUG_ASSERT(key_arg->mdl_namespace() != MDL_key::BACKUP);
     new (&lock->key) MDL_key(key_arg);
+    lock->fast_path_reset();
     if (key_arg->mdl_namespace() == MDL_key::SCHEMA)
       lock->m_strategy= &m_scoped_lock_strategy;
     else
@@ -736,6 +882,8 @@ void mdl_init()
 #endif
 
   mdl_locks.init();
+  mysql_mutex_init(key_LOCK_mdl_fast_path_contexts,
+                   &LOCK_mdl_fast_path_contexts, MY_MUTEX_INIT_FAST);
 }
 
 
@@ -751,6 +899,7 @@ void mdl_destroy()
   if (mdl_initialized)
   {
     mdl_initialized= FALSE;
+    mysql_mutex_destroy(&LOCK_mdl_fast_path_contexts);
     mdl_locks.destroy();
   }
 }
@@ -798,6 +947,24 @@ int mdl_iterate(mdl_iterator_callback callback, void *arg)
                          &argument);
     lf_hash_put_pins(pins);
   }
+  if (!res)
+  {
+    /* The tickets granted by the fast path are not in MDL_lock::m_granted */
+    mysql_mutex_lock(&LOCK_mdl_fast_path_contexts);
+    for (MDL_context &ctx : mdl_fast_path_contexts)
+    {
+      mysql_mutex_lock(&ctx.m_LOCK_fast_path);
+      res= std::any_of(ctx.m_fast_path_tickets.begin(),
+                       ctx.m_fast_path_tickets.end(),
+                       [callback, arg](MDL_ticket &ticket) {
+                         return callback(&ticket, arg, true);
+                       });
+      mysql_mutex_unlock(&ctx.m_LOCK_fast_path);
+      if (res)
+        break;
+    }
+    mysql_mutex_unlock(&LOCK_mdl_fast_path_contexts);
+  }
   DBUG_RETURN(res);
 }
 
@@ -887,6 +1054,56 @@ MDL_lock* MDL_map::find_or_insert(LF_PINS *pins, const MDL_key *mdl_key)
 }
 
 
+/**
+  Grant an unobtrusive lock by the fast path, without taking
+  MDL_lock::m_rwlock.
+
+  @param pins  Pins of the context
+  @param key   Key of the lock
+  @param slot  MDL_lock::fast_path_slot() of the requested type
+  @param shard Counter shard of the current CPU
+
+  @return The lock, or NULL if the request must take the slow path. The
+          lock is not in the hash yet, or can not be granted by the fast
+          path.
+*/
+
+MDL_lock *MDL_map::try_fast_path(LF_PINS *pins, const MDL_key *mdl_key,
+                                 int slot, uint shard)
+{
+  MDL_lock *lock;
+
+  if (mdl_key->mdl_namespace() == MDL_key::BACKUP)
+    return m_backup_lock->fast_path_acquire(pins, slot, shard) ?
+           m_backup_lock : NULL;
+
+  if (!(lock= (MDL_lock*) lf_hash_search(&m_locks, pins, mdl_key->ptr(),
+                                         mdl_key->length())))
+    return NULL;
+  if (!lock->fast_path_acquire(pins, slot, shard))
+    lock= NULL;
+  lf_hash_search_unpin(pins);
+  return lock;
+}
+
+
+/**
+  Fast path counter shard of a context: the one of the CPU it runs on,
+  so that the threads running on different CPUs do not update the same
+  counters.
+*/
+
+static inline uint mdl_fast_path_shard(const MDL_context *ctx)
+{
+#ifdef HAVE_SCHED_GETCPU
+  int cpu= sched_getcpu();
+  if (cpu >= 0)
+    return (uint) cpu % MDL_lock::FAST_PATH_SHARDS;
+#endif
+  return (uint) (ctx->get_thread_id() % MDL_lock::FAST_PATH_SHARDS);
+}
+
+
 /**
  * Return thread id of the owner of the lock, if it is owned.
  */
@@ -954,9 +1171,12 @@ MDL_context::MDL_context()
   m_owner(NULL),
   m_needs_thr_lock_abort(FALSE),
   m_waiting_for(NULL),
-  m_pins(NULL)
+  m_pins(NULL),
+  m_fast_path_registered(false)
 {
   mysql_prlock_init(key_MDL_context_LOCK_waiting_for, &m_LOCK_waiting_for);
+  mysql_mutex_init(key_MDL_context_LOCK_fast_path, &m_LOCK_fast_path,
+                   MY_MUTEX_INIT_FAST);
 }
 
 
@@ -978,6 +1198,15 @@ void MDL_context::destroy()
   DBUG_ASSERT(m_tickets[MDL_TRANSACTION].is_empty());
   DBUG_ASSERT(m_tickets[MDL_EXPLICIT].is_empty());
 
+  DBUG_ASSERT(m_fast_path_tickets.empty());
+
+  if (m_fast_path_registered)
+  {
+    mysql_mutex_lock(&LOCK_mdl_fast_path_contexts);
+    mdl_fast_path_contexts.remove(*this);
+    mysql_mutex_unlock(&LOCK_mdl_fast_path_contexts);
+  }
+  mysql_mutex_destroy(&m_LOCK_fast_path);
   mysql_prlock_destroy(&m_LOCK_waiting_for);
   if (m_pins)
     lf_hash_put_pins(m_pins);
@@ -1505,6 +1734,14 @@ MDL_lock::MDL_scoped_lock::m_waiting_incompatible[MDL_TYPE_END]=
 };
 
 
+/** IX is the only unobtrusive scoped lock */
+const int8
+MDL_lock::MDL_scoped_lock::m_fast_path_slots[MDL_TYPE_END]=
+{
+  0, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+
 /**
   Compatibility (or rather "incompatibility") matrices for per-object
   metadata lock. Arrays of bitmaps which elements specify which granted/
@@ -1607,6 +1844,17 @@ MDL_lock::MDL_object_lock::m_waiting_incompatible[MDL_TYPE_END]=
 };
 
 
+/**
+  S, SH, SR and SW are the unobtrusive per-object locks, taken by DML.
+  S and SH conflict with the same requests, and share a counter.
+*/
+const int8
+MDL_lock::MDL_object_lock::m_fast_path_slots[MDL_TYPE_END]=
+{
+  -1, 0, 0, 1, 2, -1, -1, -1, -1, -1
+};
+
+
 /**
   Compatibility (or rather "incompatibility") matrices for backup metadata
   lock. Arrays of bitmaps which elements specify which granted/waiting locks
@@ -1718,6 +1966,217 @@ MDL_lock::MDL_backup_lock::m_waiting_incompatible[MDL_BACKUP_END]=
 };
 
 
+/**
+  The backup locks taken by DML and by COMMIT are unobtrusive, the
+  backup stages and FTWRL are not. TRANS_DML and ALTER_COPY conflict
+  with the same requests, and share a counter. DDL is left to the slow
+  path, as there is no counter left for it.
+*/
+const int8
+MDL_lock::MDL_backup_lock::m_fast_path_slots[MDL_BACKUP_END]=
+{
+  /* MDL_BACKUP_START */
+  -1, -1, -1, -1, -1,
+  /* MDL_BACKUP_FTWRL1 */
+  -1, -1,
+  /* MDL_BACKUP_DML */
+  0, 1, 2,
+  /* MDL_BACKUP_DDL */
+  -1,
+  /* MDL_BACKUP_BLOCK_DDL */
+  -1, 1,
+  /* MDL_BACKUP_COMMIT */
+  3
+};
+
+
+/**
+  Grant an unobtrusive lock by the fast path
+
+  @param pins   Pins of the context, pinning the lock
+  @param slot   fast_path_slot() of the requested type
+  @param shard  Counter shard of the current CPU
+
+  @retval TRUE   Granted, the counter of the slot was incremented
+  @retval FALSE  The lock has obtrusive tickets, is being destroyed, or
+                 the counter is full. The request must take the slow path.
+*/
+
+bool MDL_lock::fast_path_acquire(LF_PINS *pins, int slot, uint shard)
+{
+  std::atomic<uint64_t> &counters= m_fast_path[shard].counters;
+  const uint64_t inc= fast_path_increment(slot);
+  uint64_t state;
+
+  if (m_fast_path_flags.load(std::memory_order_relaxed))
+    return false;
+
+  state= counters.load(std::memory_order_relaxed);
+  do
+  {
+    if (((state >> (slot * FAST_PATH_COUNTER_BITS)) & FAST_PATH_COUNTER_MAX) ==
+        FAST_PATH_COUNTER_MAX)
+      return false;
+  } while (!counters.compare_exchange_weak(state, state + inc));
+
+  /*
+    An obtrusive request or try_destroy() may have set its flag before we
+    incremented the counter, without seeing our ticket. Take it back, and
+    let the waiters be rescheduled or the lock be removed.
+  */
+  if (m_fast_path_flags.load())
+  {
+    fast_path_release(pins, slot, shard);
+    return false;
+  }
+  return true;
+}
+
+
+/**
+  Release a lock granted by the fast path
+
+  Obtrusive requests waiting for the lock are rescheduled. When the last
+  ticket of the lock is released, the lock is removed from MDL_map. The
+  other shards are only read when the counters of our shard drop to zero.
+
+  @param pins   Pins of the context, to keep the lock object from being
+                reused while we access it
+  @param slot   fast_path_slot() of the type of the released ticket
+  @param shard  Shard the ticket was counted in
+*/
+
+void MDL_lock::fast_path_release(LF_PINS *pins, int slot, uint shard)
+{
+  const uint64_t inc= fast_path_increment(slot);
+  const bool pin= key.mdl_namespace() != MDL_key::BACKUP;
+  uint64_t state;
+
+  /*
+    While our ticket is counted, the lock can not be destroyed, so it is
+    safe to pin it.
+  */
+  if (pin)
+    lf_pin(pins, 2, reinterpret_cast<uchar*>(this) - LF_HASH_OVERHEAD);
+
+  state= m_fast_path[shard].counters.fetch_sub(inc) - inc;
+  /* The pre-allocated BACKUP lock need not be removed when unused */
+  if ((m_fast_path_flags.load() & FAST_PATH_HAS_OBTRUSIVE) ||
+      (pin && !state && !fast_path_counters()))
+  {
+    mysql_prlock_wrlock(&m_rwlock);
+    if (!m_strategy)
+      mysql_prlock_unlock(&m_rwlock);         /* Removed by another thread */
+    else if (is_empty() && try_destroy())
+      mdl_locks.remove(pins, this);
+    else
+    {
+      reschedule_waiters();
+      mysql_prlock_unlock(&m_rwlock);
+    }
+  }
+  if (pin)
+    lf_hash_search_unpin(pins);
+}
+
+
+/**
+  Move a ticket granted by the fast path to m_granted
+
+  Afterwards the ticket is visible to the deadlock detector and to
+  notify_conflicting_locks().
+*/
+
+void MDL_lock::fast_path_materialize(MDL_ticket *ticket, uint shard)
+{
+  const uint64_t inc=
+    fast_path_increment(m_strategy->fast_path_slots()[ticket->get_type()]);
+
+  mysql_prlock_wrlock(&m_rwlock);
+  m_granted.add_ticket(ticket);
+  m_fast_path[shard].counters.fetch_sub(inc);
+  mysql_prlock_unlock(&m_rwlock);
+}
+
+
+/** Bitmap of the types of the tickets granted by the fast path */
+
+MDL_lock::bitmap_t MDL_lock::fast_path_granted_bitmap() const
+{
+  uint64_t counters= fast_path_counters();
+  const int8 *slots= m_strategy->fast_path_slots();
+  uint n_types= key.mdl_namespace() == MDL_key::BACKUP ?
+                MDL_BACKUP_END : MDL_TYPE_END;
+  bitmap_t bitmap= 0;
+
+  if (!counters)
+    return 0;
+  for (uint type= 0; type < n_types; type++)
+  {
+    if (slots[type] >= 0 &&
+        ((counters >> (slots[type] * FAST_PATH_COUNTER_BITS)) &
+         FAST_PATH_COUNTER_MAX))
+      bitmap|= MDL_BIT(type);
+  }
+  return bitmap;
+}
+
+
+/**
+  Set or reset FAST_PATH_HAS_OBTRUSIVE after m_granted or m_waiting
+  have changed. Must be called under m_rwlock.
+*/
+
+void MDL_lock::update_fast_path_flag()
+{
+  const int8 *slots= m_strategy->fast_path_slots();
+  bitmap_t tickets= m_granted.bitmap() | m_waiting.bitmap();
+  uint n_types= key.mdl_namespace() == MDL_key::BACKUP ?
+                MDL_BACKUP_END : MDL_TYPE_END;
+
+  for (uint type= 0; type < n_types; type++)
+  {
+    if ((tickets & MDL_BIT(type)) && slots[type] < 0)
+    {
+      set_fast_path_obtrusive();
+      return;
+    }
+  }
+  if (m_fast_path_flags.load(std::memory_order_relaxed) &
+      FAST_PATH_HAS_OBTRUSIVE)
+    m_fast_path_flags.fetch_and(~FAST_PATH_HAS_OBTRUSIVE);
+}
+
+
+/**
+  Stop the fast path from granting the lock, if no fast path tickets
+  are left
+
+  Called under m_rwlock, when m_granted and m_waiting are empty, before
+  the lock is removed from MDL_map.
+
+  @return TRUE if the lock can be removed
+*/
+
+bool MDL_lock::try_destroy()
+{
+  if (fast_path_counters())
+    return false;
+  /* The pre-allocated BACKUP lock is never removed */
+  if (key.mdl_namespace() == MDL_key::BACKUP)
+    return true;
+
+  m_fast_path_flags.fetch_or(FAST_PATH_DESTROYED);
+  if (fast_path_counters())
+  {
+    /* A fast path request was granted meanwhile */
+    m_fast_path_flags.fetch_and(~FAST_PATH_DESTROYED);
+    return false;
+  }
+  return true;
+}
+
+
 /**
   Check if request for the metadata lock can be satisfied given its
   current state.
@@ -1773,6 +2232,13 @@ MDL_lock::can_grant_lock(enum_mdl_type type_arg,
   if (!ignore_lock_priority && (m_waiting.bitmap() & waiting_incompat_map))
     return false;
 
+  /*
+    The fast path tickets of the requestor have been materialized, so
+    these belong to other contexts.
+  */
+  if (fast_path_granted_bitmap() & granted_incompat_map)
+    return false;
+
   if (m_granted.bitmap() & granted_incompat_map)
   {
     bool can_grant= true;
@@ -1834,7 +2300,8 @@ void MDL_lock::remove_ticket(LF_PINS *pins, Ticket_list MDL_lock::*list,
 {
   mysql_prlock_wrlock(&m_rwlock);
   (this->*list).remove_ticket(ticket);
-  if (is_empty())
+  update_fast_path_flag();
+  if (is_empty() && try_destroy())
     mdl_locks.remove(pins, this);
   else
   {
@@ -2027,6 +2494,7 @@ MDL_context::try_acquire_lock(MDL_request *mdl_request)
       is no need to release it.
     */
     DBUG_ASSERT(! ticket->m_lock->is_empty());
+    ticket->m_lock->update_fast_path_flag();
     mysql_prlock_unlock(&ticket->m_lock->m_rwlock);
     MDL_ticket::destroy(ticket);
   }
@@ -2059,6 +2527,7 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
   MDL_key *key= &mdl_request->key;
   MDL_ticket *ticket;
   enum_mdl_duration found_duration;
+  int fast_path_slot;
 
   /* Don't take chances in production. */
   DBUG_ASSERT(mdl_request->ticket == NULL);
@@ -2104,6 +2573,15 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
   if (fix_pins())
     return TRUE;
 
+  /*
+    An obtrusive request must see all the tickets of the context, both
+    when checking for conflicts and in the deadlock detector.
+  */
+  fast_path_slot= MDL_lock::fast_path_slot(key->mdl_namespace(),
+                                           mdl_request->type);
+  if (fast_path_slot < 0)
+    materialize_fast_path_locks();
+
   if (!(ticket= MDL_ticket::create(this, mdl_request->type
 #ifndef DBUG_OFF
                                    , mdl_request->duration
@@ -2111,6 +2589,32 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
                                    )))
     return TRUE;
 
+  if (fast_path_slot >= 0 && mdl_fast_path && !m_needs_thr_lock_abort)
+  {
+    uint shard= mdl_fast_path_shard(this);
+
+    if ((lock= mdl_locks.try_fast_path(m_pins, key, fast_path_slot, shard)))
+    {
+      ticket->m_lock= lock;
+      ticket->m_is_fast_path= true;
+      ticket->m_fast_path_shard= (uint8) shard;
+      ticket->m_psi= mysql_mdl_create(ticket,
+                                      &mdl_request->key,
+                                      mdl_request->type,
+                                      mdl_request->duration,
+                                      MDL_ticket::GRANTED,
+                                      mdl_request->m_src_file,
+                                      mdl_request->m_src_line);
+      if (metadata_lock_info_plugin_loaded)
+        ticket->m_time= microsecond_interval_timer();
+      add_fast_path_ticket(ticket);
+      m_tickets[mdl_request->duration].push_front(ticket);
+      mdl_request->ticket= ticket;
+      get_thd()->status_var.mdl_fast_path_locks++;
+      return FALSE;
+    }
+  }
+
   /* The below call implicitly locks MDL_lock::m_rwlock on success. */
   if (!(lock= mdl_locks.find_or_insert(m_pins, key)))
   {
@@ -2118,6 +2622,11 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
     return TRUE;
   }
 
+  /* Stop the fast path before checking for the conflicting tickets */
+  if (fast_path_slot < 0)
+    lock->set_fast_path_obtrusive();
+  get_thd()->status_var.mdl_slow_path_locks++;
+
   DBUG_ASSERT(ticket->m_psi == NULL);
   ticket->m_psi= mysql_mdl_create(ticket,
                                   &mdl_request->key,
@@ -2209,6 +2718,7 @@ MDL_context::clone_ticket(MDL_request *mdl_request)
 
   mysql_prlock_wrlock(&ticket->m_lock->m_rwlock);
   ticket->m_lock->m_granted.add_ticket(ticket);
+  ticket->m_lock->update_fast_path_flag();
   mysql_prlock_unlock(&ticket->m_lock->m_rwlock);
 
   m_tickets[mdl_request->duration].push_front(ticket);
@@ -2328,6 +2838,7 @@ MDL_context::acquire_lock(MDL_request *mdl_request, double lock_wait_timeout)
   if (lock_wait_timeout == 0)
   {
     DBUG_PRINT("mdl", ("Nowait:  %s", ticket_msg));
+    lock->update_fast_path_flag();
     mysql_prlock_unlock(&lock->m_rwlock);
     MDL_ticket::destroy(ticket);
     my_error(ER_LOCK_WAIT_TIMEOUT, MYF(0));
@@ -2382,6 +2893,9 @@ MDL_context::acquire_lock(MDL_request *mdl_request, double lock_wait_timeout)
 
   mysql_prlock_unlock(&lock->m_rwlock);
 
+  if (lock->needs_notification(ticket))
+    notify_fast_path_locks(lock, false);
+
 #ifdef HAVE_PSI_INTERFACE
   PSI_metadata_locker_state state __attribute__((unused));
   PSI_metadata_locker *locker= NULL;
@@ -2458,6 +2972,8 @@ MDL_context::acquire_lock(MDL_request *mdl_request, double lock_wait_timeout)
     if (lock->needs_notification(ticket))
       lock->notify_conflicting_locks(this, abort_blocking);
     mysql_prlock_unlock(&lock->m_rwlock);
+    if (lock->needs_notification(ticket))
+      notify_fast_path_locks(lock, abort_blocking);
   }
   if (wait_status == MDL_wait::EMPTY)
     wait_status= m_wait.timed_wait(m_owner, &abs_timeout, TRUE,
@@ -2648,6 +3164,9 @@ MDL_context::upgrade_shared_lock(MDL_ticket *mdl_ticket,
   if (acquire_lock(&mdl_xlock_request, lock_wait_timeout))
     DBUG_RETURN(TRUE);
 
+  /* Both tickets must be in the granted queue to be merged */
+  materialize_fast_path_locks();
+
   is_new_ticket= ! has_lock(mdl_svp, mdl_xlock_request.ticket);
 
   /* Merge the acquired and the original lock. @todo: move to a method. */
@@ -2662,6 +3181,7 @@ MDL_context::upgrade_shared_lock(MDL_ticket *mdl_ticket,
   mdl_ticket->m_lock->m_granted.remove_ticket(mdl_ticket);
   mdl_ticket->m_type= new_type;
   mdl_ticket->m_lock->m_granted.add_ticket(mdl_ticket);
+  mdl_ticket->m_lock->update_fast_path_flag();
 
   mysql_prlock_unlock(&mdl_ticket->m_lock->m_rwlock);
 
@@ -2934,7 +3454,17 @@ void MDL_context::release_lock(enum_mdl_duration duration, MDL_ticket *ticket)
   DBUG_ASSERT(this == ticket->get_ctx());
   DBUG_PRINT("mdl", ("Released: %s", dbug_print_mdl(ticket)));
 
-  lock->remove_ticket(m_pins, &MDL_lock::m_granted, ticket);
+  if (ticket->m_is_fast_path)
+  {
+    int slot= lock->m_strategy->fast_path_slots()[ticket->get_type()];
+
+    mysql_mutex_lock(&m_LOCK_fast_path);
+    m_fast_path_tickets.remove(*ticket);
+    mysql_mutex_unlock(&m_LOCK_fast_path);
+    lock->fast_path_release(m_pins, slot, ticket->m_fast_path_shard);
+  }
+  else
+    lock->remove_ticket(m_pins, &MDL_lock::m_granted, ticket);
 
   m_tickets[duration].remove(ticket);
   MDL_ticket::destroy(ticket);
@@ -2958,6 +3488,89 @@ void MDL_context::release_lock(MDL_ticket *ticket)
 }
 
 
+/**
+  Add a ticket granted by the fast path to m_fast_path_tickets, where
+  mdl_iterate() can find it
+*/
+
+void MDL_context::add_fast_path_ticket(MDL_ticket *ticket)
+{
+  if (!m_fast_path_registered)
+  {
+    mysql_mutex_lock(&LOCK_mdl_fast_path_contexts);
+    mdl_fast_path_contexts.push_back(*this);
+    mysql_mutex_unlock(&LOCK_mdl_fast_path_contexts);
+    m_fast_path_registered= true;
+  }
+  mysql_mutex_lock(&m_LOCK_fast_path);
+  m_fast_path_tickets.push_back(*ticket);
+  mysql_mutex_unlock(&m_LOCK_fast_path);
+}
+
+
+/**
+  Move the tickets of the context granted by the fast path to the granted
+  queues of their locks.
+
+  Called before the context waits for a lock, before it requests an
+  obtrusive lock, and when the context starts to need thr_lock aborts,
+  so that the deadlock detector and notify_conflicting_locks() see all
+  the tickets of the context.
+*/
+
+void MDL_context::materialize_fast_path_locks()
+{
+  /* Only the owner of the context adds tickets to the list */
+  if (m_fast_path_tickets.empty())
+    return;
+
+  mysql_mutex_lock(&m_LOCK_fast_path);
+  while (!m_fast_path_tickets.empty())
+  {
+    MDL_ticket *ticket= &m_fast_path_tickets.front();
+
+    m_fast_path_tickets.pop_front();
+    ticket->m_is_fast_path= false;
+    ticket->m_lock->fast_path_materialize(ticket, ticket->m_fast_path_shard);
+  }
+  mysql_mutex_unlock(&m_LOCK_fast_path);
+}
+
+
+/**
+  Notify the contexts holding tickets of the lock granted by the fast
+  path, which conflict with the request this context waits for.
+
+  MDL_lock::notify_conflicting_locks() only sees m_granted. Called
+  without MDL_lock::m_rwlock, which materialize_fast_path_locks() takes
+  while holding m_LOCK_fast_path. The lock can not go away meanwhile,
+  since the waiting ticket of this context is in its m_waiting.
+*/
+
+void MDL_context::notify_fast_path_locks(MDL_lock *lock, bool abort_blocking)
+{
+  if (!lock->fast_path_counters())
+    return;
+
+  mysql_mutex_lock(&LOCK_mdl_fast_path_contexts);
+  for (MDL_context &ctx : mdl_fast_path_contexts)
+  {
+    if (&ctx == this)
+      continue;
+    mysql_mutex_lock(&ctx.m_LOCK_fast_path);
+    if (std::any_of(ctx.m_fast_path_tickets.begin(),
+                    ctx.m_fast_path_tickets.end(),
+                    [lock](MDL_ticket &ticket) {
+                      return ticket.m_lock == lock &&
+                             lock->m_strategy->conflicting_locks(&ticket);
+                    }))
+      m_owner->notify_shared_lock(ctx.get_owner(), false, abort_blocking);
+    mysql_mutex_unlock(&ctx.m_LOCK_fast_path);
+  }
+  mysql_mutex_unlock(&LOCK_mdl_fast_path_contexts);
+}
+
+
 /**
   Release all locks associated with the context. If the sentinel
   is not NULL, do not release locks stored in the list after and
@@ -3059,6 +3672,7 @@ void MDL_ticket::downgrade_lock(enum_mdl_type type)
   m_lock->m_granted.remove_ticket(this);
   m_type= type;
   m_lock->m_granted.add_ticket(this);
+  m_lock->update_fast_path_flag();
   m_lock->reschedule_waiters();
   mysql_prlock_unlock(&m_lock->m_rwlock);
   DBUG_VOID_RETURN;
@@ -762,7 +762,9 @@ class MDL_ticket : public MDL_wait_for_subgraph, public ilist_node<>
      m_type(type_arg),
      m_ctx(ctx_arg),
      m_lock(NULL),
-     m_psi(NULL)
+     m_psi(NULL),
+     m_is_fast_path(false),
+     m_fast_path_shard(0)
   {}
 
   virtual ~MDL_ticket()
@@ -792,6 +794,16 @@ class MDL_ticket : public MDL_wait_for_subgraph, public ilist_node<>
 
   PSI_metadata_lock *m_psi;
 
+  /**
+    TRUE if the lock was granted by the fast path: the ticket is not in
+    MDL_lock::m_granted, it is only counted in the fast path state of the
+    lock. Context private.
+  */
+  bool m_is_fast_path;
+
+  /** Counter shard of a ticket granted by the fast path. Context private. */
+  uint8 m_fast_path_shard;
+
 private:
   MDL_ticket(const MDL_ticket &);               /* not implemented */
   MDL_ticket &operator=(const MDL_ticket &);    /* not implemented */
@@ -870,12 +882,19 @@ typedef I_P_List<MDL_request, I_P_List_adapter<MDL_request,
                  I_P_List_counter>
         MDL_request_list;
 
+typedef int (*mdl_iterator_callback)(MDL_ticket *ticket, void *arg,
+                                     bool granted);
+
+/** Tag of the list of contexts which got fast path tickets */
+struct MDL_context_fast_path_tag;
+
+
 /**
   Context of the owner of metadata locks. I.e. each server
   connection has such a context.
 */
 
-class MDL_context
+class MDL_context : public ilist_node<MDL_context_fast_path_tag>
 {
 public:
   typedef I_P_List<MDL_ticket,
@@ -966,6 +985,12 @@ class MDL_context
             will see the new value eventually.
     */
     m_needs_thr_lock_abort= needs_thr_lock_abort;
+    /*
+      MDL_lock::notify_conflicting_locks() must find the tickets of such
+      contexts.
+    */
+    if (needs_thr_lock_abort)
+      materialize_fast_path_locks();
   }
   bool get_needs_thr_lock_abort() const
   {
@@ -1063,6 +1088,15 @@ class MDL_context
   MDL_wait_for_subgraph *m_waiting_for;
   LF_PINS *m_pins;
   uint m_deadlock_overweight;
+  /**
+    Tickets of this context granted by the fast path. They are not in
+    MDL_lock::m_granted, so mdl_iterate() looks for them here. Modified
+    by the owner of the context under m_LOCK_fast_path.
+  */
+  ilist<MDL_ticket> m_fast_path_tickets;
+  mysql_mutex_t m_LOCK_fast_path;
+  /** Whether the context is in the list that mdl_iterate() visits */
+  bool m_fast_path_registered;
 private:
   MDL_ticket *find_ticket(MDL_request *mdl_req,
                           enum_mdl_duration *duration);
@@ -1071,6 +1105,10 @@ class MDL_context
   bool try_acquire_lock_impl(MDL_request *mdl_request,
                              MDL_ticket **out_ticket);
   bool fix_pins();
+  void add_fast_path_ticket(MDL_ticket *ticket);
+  void materialize_fast_path_locks();
+  void notify_fast_path_locks(MDL_lock *lock, bool abort_blocking);
+  friend int mdl_iterate(mdl_iterator_callback, void *);
 
 public:
   THD *get_thd() const { return m_owner->get_thd(); }
@@ -1084,6 +1122,12 @@ class MDL_context
   /** Inform the deadlock detector there is an edge in the wait-for graph. */
   void will_wait_for(MDL_wait_for_subgraph *waiting_for_arg)
   {
+    /*
+      The deadlock detector only sees the granted tickets in
+      MDL_lock::m_granted, so a waiting context must not have fast path
+      tickets.
+    */
+    materialize_fast_path_locks();
     mysql_prlock_wrlock(&m_LOCK_waiting_for);
     m_waiting_for=  waiting_for_arg;
     mysql_prlock_unlock(&m_LOCK_waiting_for);
@@ -1156,8 +1200,13 @@ extern "C" int thd_is_connected(MYSQL_THD thd);
 */
 extern "C" ulong max_write_lock_count;
 
-typedef int (*mdl_iterator_callback)(MDL_ticket *ticket, void *arg,
-                                     bool granted);
+/*
+  Grant the unobtrusive locks, i.e. the shared locks taken by DML, without
+  locking MDL_lock::m_rwlock, as long as no obtrusive lock is granted or
+  requested, see MDL_context::try_acquire_lock_impl().
+*/
+extern my_bool mdl_fast_path;
+
 extern MYSQL_PLUGIN_IMPORT
 int mdl_iterate(mdl_iterator_callback callback, void *arg);
 #endif /* MDL_H */
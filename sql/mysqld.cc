@@ -39,6 +39,8 @@
                           // date_time_format_make
 #include "tztime.h"       // my_tz_free, my_tz_init, my_tz_SYSTEM
 #include "hostname.h"     // hostname_cache_free, hostname_cache_init
+#include "opt_join_order_cache.h"   // join_order_cache_init
+#include "sql_parallel.h"         // parallel_threads_init
 #include "sql_acl.h"      // acl_free, grant_free, acl_init,
                           // grant_init
 #include "sql_base.h"
@@ -460,6 +462,7 @@ uint mysqld_extra_port;
 uint mysqld_port_timeout;
 ulong delay_key_write_options;
 uint protocol_version;
+uint protocol_compression_level;
 uint lower_case_table_names;
 ulong tc_heuristic_recover= 0;
 Atomic_counter<uint32_t> THD_count::count, CONNECT::count;
@@ -1183,7 +1186,8 @@ static PSI_cond_info all_server_conds[]=
 PSI_thread_key key_thread_delayed_insert,
   key_thread_handle_manager, key_thread_main,
   key_thread_one_connection, key_thread_signal_hand,
-  key_thread_slave_background, key_rpl_parallel_thread;
+  key_thread_slave_background, key_rpl_parallel_thread,
+  key_thread_parallel_job;
 PSI_thread_key key_thread_ack_receiver;
 
 static PSI_thread_info all_server_threads[]=
@@ -1195,7 +1199,8 @@ static PSI_thread_info all_server_threads[]=
   { &key_thread_signal_hand, "signal_handler", PSI_FLAG_GLOBAL},
   { &key_thread_slave_background, "slave_bg", PSI_FLAG_GLOBAL},
   { &key_thread_ack_receiver, "Ack_receiver", PSI_FLAG_GLOBAL},
-  { &key_rpl_parallel_thread, "rpl_parallel", 0}
+  { &key_rpl_parallel_thread, "rpl_parallel", 0},
+  { &key_thread_parallel_job, "parallel_job", 0}
 };
 
 #ifdef HAVE_MMAP
@@ -1273,6 +1278,7 @@ void init_net_server_extension(THD *thd)
   thd->m_net_server_extension.m_user_data= thd;
   thd->m_net_server_extension.m_before_header= net_before_header_psi;
   thd->m_net_server_extension.m_after_header= net_after_header_psi;
+  thd->m_net_server_extension.m_compress_ctx= NULL;
   /* Activate this private extension for the mysqld server. */
   thd->net.extension= & thd->m_net_server_extension;
 }
@@ -1503,6 +1509,7 @@ int deny_severity = LOG_WARNING;
 #endif
 #ifdef HAVE_QUERY_CACHE
 ulong query_cache_min_res_unit= QUERY_CACHE_MIN_RESULT_DATA_SIZE;
+ulong query_cache_shards= 1;
 Query_cache query_cache;
 #endif
 
@@ -1998,6 +2005,8 @@ static void clean_up(bool print_message)
 #endif
   query_cache_destroy();
   hostname_cache_free();
+  join_order_cache_free();
+  parallel_threads_end();
   item_func_sleep_free();
   lex_free();				/* Free some memory */
   item_create_cleanup();
@@ -4969,7 +4978,8 @@ static int init_server_components()
   */
   my_cpu_init();
   mdl_init();
-  if (tdc_init() || hostname_cache_init())
+  parallel_threads_init();
+  if (tdc_init() || hostname_cache_init() || join_order_cache_init())
     unireg_abort(1);
 
   query_cache_set_min_res_unit(query_cache_min_res_unit);
@@ -7030,6 +7040,30 @@ static int show_queries(THD *thd, SHOW_VAR *var, void *,
 }
 
 
+#ifdef HAVE_QUERY_CACHE
+/* The statistics of the query cache, summed over its shards */
+template <size_t Query_cache::*counter>
+static int show_qcache_counter(THD *, SHOW_VAR *var, void *buff,
+                               system_status_var *, enum_var_type)
+{
+  var->type= SHOW_LONG;
+  var->value= buff;
+  *((long *) buff)= (long) query_cache.total(counter);
+  return 0;
+}
+
+static int show_qcache_shards(THD *, SHOW_VAR *var, void *,
+                              system_status_var *, enum_var_type)
+{
+  static SHOW_VAR no_shards[]= {{NullS, NullS, SHOW_LONG}};
+  var->type= SHOW_ARRAY;
+  var->value= query_cache.shard_status() ? query_cache.shard_status() :
+              no_shards;
+  return 0;
+}
+#endif /* HAVE_QUERY_CACHE */
+
+
 static int show_net_compression(THD *thd, SHOW_VAR *var, void *,
                                 system_status_var *, enum_var_type)
 {
@@ -7038,6 +7072,15 @@ static int show_net_compression(THD *thd, SHOW_VAR *var, void *,
   return 0;
 }
 
+static int show_net_compression_algorithm(THD *thd, SHOW_VAR *var, void *,
+                                          system_status_var *, enum_var_type)
+{
+  var->type= SHOW_CHAR;
+  var->value= const_cast<char*>(!thd->net.compress ? "" :
+                                net_zstd_active(&thd->net) ? "zstd" : "zlib");
+  return 0;
+}
+
 static int show_starttime(THD *thd, SHOW_VAR *var, void *buff,
                           system_status_var *, enum_var_type)
 {
@@ -7534,6 +7577,27 @@ static int show_threadpool_threads(THD *, SHOW_VAR *var, void *buff,
   *(reinterpret_cast<int*>(buff))= tp_get_thread_count();
   return 0;
 }
+
+
+static int show_threadpool_steals(THD *, SHOW_VAR *var, void *buff,
+                                  system_status_var *, enum_var_type)
+{
+  var->type= SHOW_ULONGLONG;
+  var->value= buff;
+  *(ulonglong *) buff= tp_stats.steals;
+  return 0;
+}
+
+
+static int show_threadpool_stolen_wait_time(THD *, SHOW_VAR *var, void *buff,
+                                            system_status_var *,
+                                            enum_var_type)
+{
+  var->type= SHOW_ULONGLONG;
+  var->value= buff;
+  *(ulonglong *) buff= tp_stats.stolen_wait_time;
+  return 0;
+}
 #endif
 
 
@@ -7572,6 +7636,7 @@ SHOW_VAR status_vars[]= {
   {"Column_decompressions",    (char*) offsetof(STATUS_VAR, column_decompressions), SHOW_LONG_STATUS},
   {"Com",                      (char*) com_status_vars, SHOW_ARRAY},
   {"Compression",              (char*) &show_net_compression, SHOW_SIMPLE_FUNC},
+  {"Compression_algorithm",    (char*) &show_net_compression_algorithm, SHOW_SIMPLE_FUNC},
   {"Connections",              (char*) &global_thread_id,         SHOW_LONG_NOFLUSH},
   {"Connection_errors_accept", (char*) &connection_errors_accept, SHOW_LONG},
   {"Connection_errors_internal", (char*) &connection_errors_internal, SHOW_LONG},
@@ -7641,6 +7706,9 @@ SHOW_VAR status_vars[]= {
   {"Handler_write",            (char*) offsetof(STATUS_VAR, ha_write_count), SHOW_LONG_STATUS},
   SHOW_FUNC_ENTRY("Key",       &show_default_keycache),
   {"optimizer_join_prefixes_check_calls",     (char*) offsetof(STATUS_VAR, optimizer_join_prefixes_check_calls), SHOW_LONG_STATUS},
+  {"Optimizer_join_order_cache_hits", (char*) offsetof(STATUS_VAR, optimizer_join_order_cache_hits), SHOW_LONG_STATUS},
+  {"Optimizer_join_order_cache_misses", (char*) offsetof(STATUS_VAR, optimizer_join_order_cache_misses), SHOW_LONG_STATUS},
+  {"Optimizer_join_order_time", (char*) offsetof(STATUS_VAR, optimizer_join_order_time), SHOW_LONG_STATUS},
   {"Last_query_cost",          (char*) offsetof(STATUS_VAR, last_query_cost), SHOW_DOUBLE_STATUS},
 #ifndef DBUG_OFF
   {"malloc_calls",             (char*) &malloc_calls, SHOW_LONG},
@@ -7654,6 +7722,8 @@ SHOW_VAR status_vars[]= {
   {"Max_used_connections_time",(char*) &show_max_used_connections_time, SHOW_SIMPLE_FUNC},
   {"Memory_used",              (char*) &show_memory_used, SHOW_SIMPLE_FUNC},
   {"Memory_used_initial",      (char*) &start_memory_used, SHOW_LONGLONG_NOFLUSH},
+  {"Metadata_locks_fast_path", (char*) offsetof(STATUS_VAR, mdl_fast_path_locks), SHOW_LONG_STATUS},
+  {"Metadata_locks_slow_path", (char*) offsetof(STATUS_VAR, mdl_slow_path_locks), SHOW_LONG_STATUS},
   {"Resultset_metadata_skipped", (char *) offsetof(STATUS_VAR, skip_metadata_count),SHOW_LONG_STATUS},
   {"Not_flushed_delayed_rows", (char*) &delayed_rows_in_use,    SHOW_LONG_NOFLUSH},
   {"Open_files",               (char*) &my_file_opened,         SHOW_SINT},
@@ -7690,14 +7760,15 @@ SHOW_VAR status_vars[]= {
   {"Rpl_semi_sync_slave_send_ack", (char*) &rpl_semi_sync_slave_send_ack, SHOW_LONGLONG},
 #endif /* HAVE_REPLICATION */
 #ifdef HAVE_QUERY_CACHE
-  {"Qcache_free_blocks",       (char*) &query_cache.free_memory_blocks, SHOW_LONG_NOFLUSH},
-  {"Qcache_free_memory",       (char*) &query_cache.free_memory, SHOW_LONG_NOFLUSH},
-  {"Qcache_hits",              (char*) &query_cache.hits,       SHOW_LONG},
-  {"Qcache_inserts",           (char*) &query_cache.inserts,    SHOW_LONG},
-  {"Qcache_lowmem_prunes",     (char*) &query_cache.lowmem_prunes, SHOW_LONG},
-  {"Qcache_not_cached",        (char*) &query_cache.refused,    SHOW_LONG},
-  {"Qcache_queries_in_cache",  (char*) &query_cache.queries_in_cache, SHOW_LONG_NOFLUSH},
-  {"Qcache_total_blocks",      (char*) &query_cache.total_blocks, SHOW_LONG_NOFLUSH},
+  {"Qcache_free_blocks",       (char*) &show_qcache_counter<&Query_cache::free_memory_blocks>, SHOW_SIMPLE_FUNC},
+  {"Qcache_free_memory",       (char*) &show_qcache_counter<&Query_cache::free_memory>, SHOW_SIMPLE_FUNC},
+  {"Qcache_hits",              (char*) &show_qcache_counter<&Query_cache::hits>, SHOW_SIMPLE_FUNC},
+  {"Qcache_inserts",           (char*) &show_qcache_counter<&Query_cache::inserts>, SHOW_SIMPLE_FUNC},
+  {"Qcache_lowmem_prunes",     (char*) &show_qcache_counter<&Query_cache::lowmem_prunes>, SHOW_SIMPLE_FUNC},
+  {"Qcache_not_cached",        (char*) &show_qcache_counter<&Query_cache::refused>, SHOW_SIMPLE_FUNC},
+  {"Qcache_queries_in_cache",  (char*) &show_qcache_counter<&Query_cache::queries_in_cache>, SHOW_SIMPLE_FUNC},
+  {"Qcache_shard",             (char*) &show_qcache_shards, SHOW_SIMPLE_FUNC},
+  {"Qcache_total_blocks",      (char*) &show_qcache_counter<&Query_cache::total_blocks>, SHOW_SIMPLE_FUNC},
 #endif /*HAVE_QUERY_CACHE*/
   {"Queries",                  (char*) &show_queries,            SHOW_SIMPLE_FUNC},
   {"Questions",                (char*) offsetof(STATUS_VAR, questions), SHOW_LONG_STATUS},
@@ -7724,6 +7795,7 @@ SHOW_VAR status_vars[]= {
   {"Slow_queries",             (char*) offsetof(STATUS_VAR, long_query_count), SHOW_LONG_STATUS},
   {"Sort_merge_passes",	       (char*) offsetof(STATUS_VAR, filesort_merge_passes_), SHOW_LONG_STATUS},
   {"Sort_priority_queue_sorts",(char*) offsetof(STATUS_VAR, filesort_pq_sorts_), SHOW_LONG_STATUS}, 
+  {"Sort_radix_sorts",         (char*) offsetof(STATUS_VAR, filesort_radix_sorts_), SHOW_LONG_STATUS},
   {"Sort_range",	       (char*) offsetof(STATUS_VAR, filesort_range_count_), SHOW_LONG_STATUS},
   {"Sort_rows",		       (char*) offsetof(STATUS_VAR, filesort_rows_), SHOW_LONG_STATUS},
   {"Sort_scan",		       (char*) offsetof(STATUS_VAR, filesort_scan_count_), SHOW_LONG_STATUS},
@@ -7766,7 +7838,9 @@ SHOW_VAR status_vars[]= {
   {"Table_locks_immediate",    (char*) &locks_immediate,        SHOW_LONG},
   {"Table_locks_waited",       (char*) &locks_waited,           SHOW_LONG},
   {"Table_open_cache_active_instances", (char*) &show_tc_active_instances, SHOW_SIMPLE_FUNC},
+  {"Table_open_cache_handoffs", (char*) offsetof(STATUS_VAR, table_open_cache_handoffs), SHOW_LONGLONG_STATUS},
   {"Table_open_cache_hits",    (char*) offsetof(STATUS_VAR, table_open_cache_hits), SHOW_LONGLONG_STATUS},
+  {"Table_open_cache_migrations", (char*) offsetof(STATUS_VAR, table_open_cache_migrations), SHOW_LONGLONG_STATUS},
   {"Table_open_cache_misses",  (char*) offsetof(STATUS_VAR, table_open_cache_misses), SHOW_LONGLONG_STATUS},
   {"Table_open_cache_overflows", (char*) offsetof(STATUS_VAR, table_open_cache_overflows), SHOW_LONGLONG_STATUS},
 #ifdef HAVE_MMAP
@@ -7777,6 +7851,8 @@ SHOW_VAR status_vars[]= {
   {"Tmp_space_used",           (char*) offsetof(STATUS_VAR, tmp_space_used), SHOW_LONGLONG_STATUS},
 #ifdef HAVE_POOL_OF_THREADS
   {"Threadpool_idle_threads",  (char *) &show_threadpool_idle_threads, SHOW_SIMPLE_FUNC},
+  {"Threadpool_steals",        (char *) &show_threadpool_steals, SHOW_SIMPLE_FUNC},
+  {"Threadpool_stolen_wait_time", (char *) &show_threadpool_stolen_wait_time, SHOW_SIMPLE_FUNC},
   {"Threadpool_threads",       (char *) &show_threadpool_threads, SHOW_SIMPLE_FUNC},
 #endif
   {"Threads_cached",           (char*) &show_cached_thread_count, SHOW_SIMPLE_FUNC},
@@ -9347,6 +9423,9 @@ void refresh_global_status()
     These are the variables in 'status_vars[]' with the prefix _STATUS.
  */
   bzero(&global_status_var, clear_for_flush_status);
+#ifdef HAVE_QUERY_CACHE
+  query_cache.reset_statistics();
+#endif
 
 #ifdef WITH_WSREP
   if (WSREP_ON)
@@ -121,6 +121,33 @@ extern my_bool thd_net_is_killed(THD *thd);
 
 static my_bool net_write_buff(NET *, const uchar *, size_t len);
 
+#ifdef HAVE_ZSTD_COMPRESS
+#include <zstd.h>
+
+/*
+  Streaming state of the zstd compressed protocol of a connection.
+
+  Each direction of the connection is a single zstd stream, which is
+  flushed at the end of every compressed packet. The compression of a
+  packet can thus refer to the data of the previous packets, which makes
+  also the small packets of OLTP traffic compressible. Packets that are
+  sent uncompressed are not part of the streams.
+*/
+struct st_net_zstd
+{
+  ZSTD_CCtx *cctx;
+  ZSTD_DCtx *dctx;
+  uchar *buff;                                  /* For decompression */
+  size_t buff_length;
+};
+
+/*
+  Longest data that is compressed into one packet: the compressed data of
+  it must fit in the 3 byte packet length even if it is not compressible
+*/
+#define NET_ZSTD_MAX_BLOCK_LENGTH (MAX_PACKET_LENGTH - MAX_PACKET_LENGTH / 128)
+#endif /* HAVE_ZSTD_COMPRESS */
+
 my_bool net_allocate_new_packet(NET *net, void *thd, uint my_flags);
 
 /** Init with packet info. */
@@ -191,16 +218,215 @@ my_bool net_allocate_new_packet(NET *net, void *thd, uint my_flags)
 }
 
 
+#ifdef HAVE_ZSTD_COMPRESS
+/*
+  The zstd state is kept in the NET_SERVER of the connection, so that the
+  layout of NET stays the same
+*/
+static inline struct st_net_zstd *net_zstd(const NET *net)
+{
+  const NET_SERVER *server_extension=
+    static_cast<const NET_SERVER*>(net->extension);
+  return server_extension ?
+         (struct st_net_zstd*) server_extension->m_compress_ctx : NULL;
+}
+
+
+static void net_zstd_end(NET *net)
+{
+  struct st_net_zstd *ctx= net_zstd(net);
+  if (!ctx)
+    return;
+  ZSTD_freeCCtx(ctx->cctx);
+  ZSTD_freeDCtx(ctx->dctx);
+  my_free(ctx->buff);
+  my_free(ctx);
+  static_cast<NET_SERVER*>(net->extension)->m_compress_ctx= NULL;
+}
+#endif
+
+
+/** TRUE if the compressed protocol of the connection uses zstd */
+
+my_bool net_zstd_active(const NET *net)
+{
+#ifdef HAVE_ZSTD_COMPRESS
+  return net_zstd(net) != NULL;
+#else
+  return 0;
+#endif
+}
+
+
 void net_end(NET *net)
 {
   DBUG_ENTER("net_end");
   my_free(net->buff);
   net->buff=0;
   net->using_proxy_protocol= 0;
+#ifdef HAVE_ZSTD_COMPRESS
+  net_zstd_end(net);
+#endif
   DBUG_VOID_RETURN;
 }
 
 
+/**
+  Switch the compressed protocol of a connection from zlib to zstd
+
+  @param net    Network handler, with compression enabled
+  @param level  zstd compression level of the packets that are sent
+
+  @retval 0  ok
+  @retval 1  out of memory, the server was built without zstd, or the
+             connection has no NET_SERVER
+*/
+
+my_bool net_zstd_init(NET *net, int level)
+{
+#ifdef HAVE_ZSTD_COMPRESS
+  struct st_net_zstd *ctx;
+  NET_SERVER *server_extension= static_cast<NET_SERVER*>(net->extension);
+  DBUG_ENTER("net_zstd_init");
+  DBUG_ASSERT(!net_zstd(net));
+
+  if (!server_extension)
+    DBUG_RETURN(1);
+
+  /*
+    Not MY_THREAD_SPECIFIC, even if net->thread_specific_malloc is set:
+    the semisync Ack_receiver thread reads the packets of a replica
+    through this context, and may reallocate ctx->buff.
+  */
+  if (!(ctx= (struct st_net_zstd*)
+        my_malloc(key_memory_NET_compress_packet, sizeof(*ctx),
+                  MYF(MY_WME | MY_ZEROFILL))))
+    DBUG_RETURN(1);
+  server_extension->m_compress_ctx= ctx;
+  if (!(ctx->cctx= ZSTD_createCCtx()) || !(ctx->dctx= ZSTD_createDCtx()) ||
+      ZSTD_isError(ZSTD_CCtx_setParameter(ctx->cctx, ZSTD_c_compressionLevel,
+                                          level)) ||
+      ZSTD_isError(ZSTD_CCtx_setParameter(ctx->cctx, ZSTD_c_windowLog,
+                                          NET_ZSTD_WINDOW_LOG)) ||
+      ZSTD_isError(ZSTD_DCtx_setParameter(ctx->dctx, ZSTD_d_windowLogMax,
+                                          NET_ZSTD_WINDOW_LOG)))
+  {
+    net_zstd_end(net);
+    DBUG_RETURN(1);
+  }
+  DBUG_RETURN(0);
+#else
+  return 1;
+#endif
+}
+
+
+#ifdef HAVE_ZSTD_COMPRESS
+/**
+  Compress a packet into the zstd stream of a connection
+
+  @param      net      Network handler
+  @param      to       ZSTD_compressBound(*len) bytes
+  @param      from     Data of the packet
+  @param[in,out] len   Length of the data; the compressed length on return
+  @param[out] complen  Length of the uncompressed data
+
+  @note On error the stream is broken and the connection must be closed
+*/
+
+static my_bool net_zstd_compress(NET *net, uchar *to, const uchar *from,
+                                 size_t *len, size_t *complen)
+{
+  struct st_net_zstd *ctx= net_zstd(net);
+  ZSTD_inBuffer in= { from, *len, 0 };
+  ZSTD_outBuffer out= { to, ZSTD_compressBound(*len), 0 };
+  size_t rc;
+
+  do
+  {
+    rc= ZSTD_compressStream2(ctx->cctx, &out, &in, ZSTD_e_flush);
+    if (ZSTD_isError(rc))
+      return 1;
+  } while (rc && out.pos < out.size);
+  if (rc)
+    return 1;
+  *complen= *len;
+  *len= out.pos;
+  return 0;
+}
+
+
+/**
+  Uncompress a packet of the zstd stream of a connection
+
+  Works like my_uncompress(): 'complen' is 0 for a packet that was not
+  compressed, and the length of the data in 'packet' on return.
+*/
+
+static my_bool net_zstd_uncompress(NET *net, uchar *packet, size_t len,
+                                   size_t *complen)
+{
+  struct st_net_zstd *ctx= net_zstd(net);
+
+  if (!*complen)
+  {
+    *complen= len;
+    return 0;
+  }
+  if (ctx->buff_length < *complen)
+  {
+    uchar *buff;
+    /* Not net->thread_specific_malloc: see net_zstd_init() */
+    if (!(buff= (uchar*) my_realloc(key_memory_NET_compress_packet, ctx->buff,
+                                    *complen,
+                                    MYF(MY_WME | MY_ALLOW_ZERO_PTR))))
+      return 1;
+    ctx->buff= buff;
+    ctx->buff_length= *complen;
+  }
+
+  ZSTD_inBuffer in= { packet, len, 0 };
+  ZSTD_outBuffer out= { ctx->buff, *complen, 0 };
+  while (in.pos < in.size)
+  {
+    size_t in_pos= in.pos, out_pos= out.pos;
+    if (ZSTD_isError(ZSTD_decompressStream(ctx->dctx, &out, &in)) ||
+        (in.pos == in_pos && out.pos == out_pos))
+      return 1;
+  }
+  if (out.pos != out.size)
+    return 1;
+  memcpy(packet, ctx->buff, *complen);
+  return 0;
+}
+#endif /* HAVE_ZSTD_COMPRESS */
+
+
+#ifdef HAVE_COMPRESS
+static my_bool net_uncompress(NET *net, uchar *packet, size_t len,
+                              size_t *complen)
+{
+#ifdef HAVE_ZSTD_COMPRESS
+  if (net_zstd(net))
+    return net_zstd_uncompress(net, packet, len, complen);
+#endif
+  return my_uncompress(packet, len, complen);
+}
+#endif
+
+
+/** Longest data that is sent in one packet of the compressed protocol */
+
+static inline size_t net_max_compressed_length(const NET *net)
+{
+#ifdef HAVE_ZSTD_COMPRESS
+  if (net_zstd(net))
+    return NET_ZSTD_MAX_BLOCK_LENGTH;
+#endif
+  return MAX_PACKET_LENGTH;
+}
+
+
 /** Realloc the packet buffer. */
 
 my_bool net_realloc(NET *net, size_t length)
@@ -397,6 +623,36 @@ my_bool net_flush(NET *net)
 }
 
 
+/**
+  Check whether the next packet has already been sent by the other side
+
+  @note This never waits for data
+*/
+
+my_bool net_has_pending_input(NET *net)
+{
+  Vio *vio= net->vio;
+  return (net->compress && net->remain_in_buf) || vio->has_data(vio) ||
+         vio_pending(vio) > 0;
+}
+
+
+/**
+  Cork the socket while the next command of a pipeline has already been
+  received, and uncork it for the last command, so that the responses
+  to a pipeline are sent together
+
+  @return whether the socket is corked
+*/
+
+my_bool net_cork_pipeline(NET *net)
+{
+  my_bool pending= net_has_pending_input(net);
+  vio_cork(net->vio, pending);
+  return pending;
+}
+
+
 /*****************************************************************************
 ** Write something to server/client buffer
 *****************************************************************************/
@@ -573,8 +829,9 @@ static my_bool
 net_write_buff(NET *net, const uchar *packet, size_t len)
 {
   size_t left_length;
-  if (net->compress && net->max_packet > MAX_PACKET_LENGTH)
-    left_length= (MAX_PACKET_LENGTH - (net->write_pos - net->buff));
+  if (net->compress && net->max_packet > net_max_compressed_length(net))
+    left_length= (net_max_compressed_length(net) -
+                  (net->write_pos - net->buff));
   else
     left_length= (net->buff_end - net->write_pos);
 
@@ -600,7 +857,7 @@ net_write_buff(NET *net, const uchar *packet, size_t len)
 	We can't have bigger packets than 16M with compression
 	Because the uncompressed length is stored in 3 bytes
       */
-      left_length= MAX_PACKET_LENGTH;
+      left_length= net_max_compressed_length(net);
       while (len > left_length)
       {
 	if (net_real_write(net, packet, left_length))
@@ -662,8 +919,14 @@ net_real_write(NET *net,const uchar *packet, size_t len)
     size_t complen;
     uchar *b;
     uint header_length=NET_HEADER_SIZE+COMP_HEADER_SIZE;
+    size_t buff_length= len;
+#ifdef HAVE_ZSTD_COMPRESS
+    if (net_zstd(net))
+      buff_length= ZSTD_compressBound(len);
+#endif
     if (!(b= (uchar*) my_malloc(key_memory_NET_compress_packet,
-                                len + NET_HEADER_SIZE + COMP_HEADER_SIZE + 1,
+                                buff_length + NET_HEADER_SIZE +
+                                COMP_HEADER_SIZE + 1,
                                 MYF(MY_WME | (net->thread_specific_malloc
                                               ? MY_THREAD_SPECIFIC : 0)))))
     {
@@ -673,11 +936,30 @@ net_real_write(NET *net,const uchar *packet, size_t len)
       net->reading_or_writing= 0;
       DBUG_RETURN(1);
     }
-    memcpy(b+header_length,packet,len);
-
+#ifdef HAVE_ZSTD_COMPRESS
     /* Don't compress error packets (compress == 2) */
-    if (net->compress == 2 || my_compress(b+header_length, &len, &complen))
-      complen=0;
+    if (net_zstd(net) && net->compress != 2 && len)
+    {
+      if (net_zstd_compress(net, b + header_length, packet, &len, &complen))
+      {
+        my_free(b);
+        net->error= 2;
+        net->last_errno= ER_NET_ERROR_ON_WRITE;
+        MYSQL_SERVER_my_error(net->last_errno, MYF(0));
+        net->reading_or_writing= 0;
+        DBUG_RETURN(1);
+      }
+    }
+    else
+#endif
+    {
+      memcpy(b+header_length,packet,len);
+
+      /* Don't compress error packets (compress == 2) */
+      if (net->compress == 2 || net_zstd_active(net) ||
+          my_compress(b+header_length, &len, &complen))
+        complen=0;
+    }
     int3store(&b[NET_HEADER_SIZE],complen);
     int3store(b,len);
     b[3]=(uchar) (net->compress_pkt_nr++);
@@ -1188,8 +1470,8 @@ my_net_read_packet_reallen(NET *net, my_bool read_from_server, ulong* reallen)
 	return packet_error;
       }
       read_from_server= 0;
-      if (my_uncompress(net->buff + net->where_b, packet_len,
-			&complen))
+      if (net_uncompress(net, net->buff + net->where_b, packet_len,
+                         &complen))
       {
 	net->error= 2;			/* caller will close socket */
         net->last_errno= ER_NET_UNCOMPRESS_ERROR;
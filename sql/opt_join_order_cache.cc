@@ -0,0 +1,412 @@
+/*
+   Copyright (c) 2024, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1335  USA */
+
+
+/**
+  @file
+
+  Cache of the join orders chosen by the optimizer.
+
+  For joins of many tables most of the optimization time is spent in
+  greedy_search(). When @@optimizer_join_order_cache_size > 0, the join
+  order chosen for a join is remembered in a global LRU cache, and the next
+  optimization of the same join takes the order from the cache. The costs
+  and access methods of the cached order are still computed from the
+  current statistics by optimize_straight_join(), which is linear in the
+  number of tables.
+
+  The key of a join is an MD5 hash of
+  - the digest of the statement, when the digest was computed for the
+    performance schema,
+  - the settings that affect the choice of the join order,
+  - for every table of the join: its name and definition version, the
+    tables it depends on, the tables its keys may use, whether it is
+    constant, and the binary logarithm of its number of rows and of the
+    number of rows estimated to be read from it.
+
+  The row estimates are the "statistics version" of the tables: a cached
+  order is not used anymore once the estimate of a table has changed by
+  more than a factor of two. Literals of the statement affect the key only
+  through the row estimates, so statements that differ only in constants
+  share their join order as long as their estimates are similar.
+
+  Joins with semi-join nests, derived or temporary tables are not cached.
+  A cached order is used only if it is still a valid order of the join,
+  see apply_cached_join_order().
+
+  When @@optimizer_prepared_plan_reuse is set, the executions of a prepared
+  statement also keep the join order of each of its selects in
+  SELECT_LEX::saved_join_order. The key of a saved order does not include
+  the row estimates: they are stored next to the order and compared with
+  the estimates of the next execution, which depend on the values of the
+  parameters. The saved order is discarded when an estimate differs by
+  more than @@optimizer_prepared_plan_reuse_ratio, or when a table has been
+  reopened or analyzed since the order was saved.
+*/
+
+#include "mariadb.h"
+#include "sql_priv.h"
+#include "sql_class.h"
+#include "sql_select.h"
+#include "hash_filo.h"
+#include "my_bit.h"
+#include "opt_join_order_cache.h"
+
+class Join_order_cache_entry : public hash_filo_element
+{
+public:
+  uchar key[JOIN_ORDER_CACHE_KEY_SIZE];
+  uint n_tables;
+  uchar order[MAX_TABLES];
+};
+
+static Hash_filo<Join_order_cache_entry> *join_order_cache;
+ulong join_order_cache_size;
+
+
+bool join_order_cache_init()
+{
+  Join_order_cache_entry tmp;
+  uint key_offset= (uint) ((char*) (&tmp.key) - (char*) &tmp);
+
+  if (!(join_order_cache=
+        new Hash_filo<Join_order_cache_entry>(PSI_INSTRUMENT_ME,
+                                              (uint) join_order_cache_size,
+                                              key_offset,
+                                              JOIN_ORDER_CACHE_KEY_SIZE, NULL,
+                                              (my_hash_free_key) my_free,
+                                              &my_charset_bin)))
+    return 1;
+  join_order_cache->clear();
+  return 0;
+}
+
+
+void join_order_cache_free()
+{
+  delete join_order_cache;
+  join_order_cache= NULL;
+}
+
+
+void join_order_cache_resize(uint size)
+{
+  join_order_cache->resize(size);
+}
+
+
+static void append_int8(String *str, ulonglong value)
+{
+  uchar buff[8];
+  int8store(buff, value);
+  str->append((const char*) buff, sizeof(buff));
+}
+
+
+/**
+  Append the shape of a condition or expression to a key
+
+  @details
+    Functions, conditions and columns are appended, but the values of
+    constants are not, so that statements that differ only in their
+    constants can share a join order, as they do with the statement
+    digest. This does not depend on performance_schema.
+*/
+
+static void append_item_shape(String *str, Item *item)
+{
+  if (!item)
+  {
+    str->append('\0');
+    return;
+  }
+  item= item->real_item();
+  append_int8(str, item->type());
+  switch (item->type()) {
+  case Item::FIELD_ITEM:
+  {
+    Field *field= ((Item_field *) item)->field;
+    if (field)
+    {
+      append_int8(str, field->table->tablenr);
+      append_int8(str, field->field_index);
+    }
+    break;
+  }
+  case Item::FUNC_ITEM:
+  case Item::COND_ITEM:
+  {
+    Item_func *func= (Item_func *) item;
+    LEX_CSTRING name= func->func_name_cstring();
+    str->append(name.str, name.length);
+    append_int8(str, func->argument_count());
+    for (uint i= 0; i < func->argument_count(); i++)
+      append_item_shape(str, func->arguments()[i]);
+    if (func->functype() == Item_func::MULT_EQUAL_FUNC)
+    {
+      Item_equal *item_equal= (Item_equal *) item;
+      Item_equal_fields_iterator it(*item_equal);
+      while (it++)
+      {
+        Field *field= it.get_curr_field();
+        append_int8(str, field->table->tablenr);
+        append_int8(str, field->field_index);
+      }
+      append_int8(str, item_equal->get_const() != NULL);
+    }
+    else if (item->type() == Item::COND_ITEM)
+    {
+      List_iterator_fast<Item> it(*((Item_cond *) item)->argument_list());
+      while (Item *arg= it++)
+        append_item_shape(str, arg);
+    }
+    break;
+  }
+  default:
+    /* Constants, subqueries and others: only the type */
+    break;
+  }
+}
+
+
+/**
+  Compute the key of the join order of a join
+
+  @param      join            The join, after the constant tables have been
+                              found
+  @param[out] key             JOIN_ORDER_CACHE_KEY_SIZE bytes
+  @param      with_estimates  Include the shape of the conditions, the
+                              digest of the statement and the row
+                              estimates of the tables
+
+  @return FALSE if the join order of the join cannot be cached
+*/
+
+static bool join_order_key(JOIN *join, uchar *key, bool with_estimates)
+{
+  THD *thd= join->thd;
+  StringBuffer<1024> str(&my_charset_bin);
+
+  if (with_estimates)
+  {
+    /*
+      The digest is only computed with performance_schema, so the
+      conditions that the join order was chosen for are always part
+      of the key.
+    */
+    if (thd->m_digest && !thd->m_digest->is_empty())
+    {
+      uchar digest[MD5_HASH_SIZE];
+      compute_digest_md5(&thd->m_digest->m_digest_storage, digest);
+      str.append((const char*) digest, sizeof(digest));
+    }
+    append_int8(&str, join->select_lex->select_number);
+    append_item_shape(&str, join->conds);
+    for (uint i= 0; i < join->table_count; i++)
+    {
+      JOIN_TAB *tab= join->join_tab + i;
+      append_item_shape(&str, tab->on_expr_ref ? *tab->on_expr_ref : NULL);
+    }
+    for (ORDER *order= join->order; order; order= order->next)
+      append_item_shape(&str, *order->item);
+    for (ORDER *group= join->group_list; group; group= group->next)
+      append_item_shape(&str, *group->item);
+  }
+
+  append_int8(&str, thd->variables.optimizer_switch);
+  append_int8(&str, thd->variables.optimizer_search_depth);
+  append_int8(&str, thd->variables.optimizer_prune_level);
+  append_int8(&str, thd->variables.optimizer_use_condition_selectivity);
+  append_int8(&str, thd->variables.join_cache_level);
+  append_int8(&str, join->table_count);
+  append_int8(&str, join->const_table_map);
+
+  for (uint i= 0; i < join->table_count; i++)
+  {
+    JOIN_TAB *tab= join->join_tab + i;
+    TABLE *table= tab->table;
+    if (table->s->tmp_table != NO_TMP_TABLE)
+      return false;
+    str.append(table->s->table_cache_key.str,
+               table->s->table_cache_key.length);
+    str.append((const char*) table->s->tabledef_version.str,
+               table->s->tabledef_version.length);
+    append_int8(&str, tab->dependent);
+    append_int8(&str, tab->key_dependent);
+    if (with_estimates)
+    {
+      append_int8(&str, my_bit_log2_uint64((ulonglong) tab->found_records));
+      append_int8(&str, my_bit_log2_uint64((ulonglong)
+                                           table->file->stats.records));
+    }
+  }
+  my_md5(key, str.ptr(), str.length());
+  return true;
+}
+
+
+bool join_order_cache_key(JOIN *join, uchar *key)
+{
+  return join_order_key(join, key, true);
+}
+
+
+/**
+  Find a join order in the cache
+
+  @param      key       The key computed by join_order_cache_key()
+  @param[out] order     TABLE::tablenr of the tables in the join order
+  @param      n_tables  Number of the tables of the join
+
+  @return TRUE if the join order was found
+*/
+
+bool join_order_cache_lookup(const uchar *key, uchar *order, uint n_tables)
+{
+  Join_order_cache_entry *entry;
+  bool found= false;
+
+  mysql_mutex_lock(&join_order_cache->lock);
+  if ((entry= join_order_cache->search((uchar*) key,
+                                       JOIN_ORDER_CACHE_KEY_SIZE)) &&
+      entry->n_tables == n_tables)
+  {
+    memcpy(order, entry->order, n_tables);
+    found= true;
+  }
+  mysql_mutex_unlock(&join_order_cache->lock);
+  return found;
+}
+
+
+void join_order_cache_store(const uchar *key, const uchar *order,
+                            uint n_tables)
+{
+  Join_order_cache_entry *entry;
+
+  DBUG_ASSERT(n_tables <= MAX_TABLES);
+  mysql_mutex_lock(&join_order_cache->lock);
+  if ((entry= join_order_cache->search((uchar*) key,
+                                       JOIN_ORDER_CACHE_KEY_SIZE)))
+  {
+    /* The statistics are the same, but the search has been redone */
+    entry->n_tables= n_tables;
+    memcpy(entry->order, order, n_tables);
+  }
+  else if (join_order_cache->size() &&
+           (entry= (Join_order_cache_entry*)
+            my_malloc(PSI_INSTRUMENT_ME, sizeof(*entry), MYF(0))))
+  {
+    memcpy(entry->key, key, JOIN_ORDER_CACHE_KEY_SIZE);
+    entry->n_tables= n_tables;
+    memcpy(entry->order, order, n_tables);
+    join_order_cache->add(entry);
+  }
+  mysql_mutex_unlock(&join_order_cache->lock);
+}
+
+
+/**
+  Compute the key of the saved join order of a select of a prepared
+  statement
+
+  @return FALSE if the join order of the join cannot be saved
+*/
+
+bool saved_join_order_key(JOIN *join, uchar *key)
+{
+  return join_order_key(join, key, false);
+}
+
+
+/**
+  Check whether the saved join order of a prepared statement can be used
+  by the current execution
+
+  @param join       The join, after the constant tables have been found
+  @param saved      The saved order
+  @param key        saved_join_order_key() of the join
+  @param max_ratio  The largest allowed ratio between the saved and the
+                    current row estimate of a table
+
+  @return TRUE if the order can be used
+*/
+
+bool saved_join_order_is_usable(JOIN *join, const Saved_join_order *saved,
+                                const uchar *key, ulong max_ratio)
+{
+  if (saved->n_tables != join->table_count ||
+      memcmp(saved->key, key, JOIN_ORDER_CACHE_KEY_SIZE))
+    return false;
+
+  for (uint i= 0; i < join->table_count; i++)
+  {
+    JOIN_TAB *tab= join->join_tab + i;
+    const Saved_join_order_table *saved_tab= saved->tables + i;
+    double found= (double) MY_MAX(tab->found_records, 1);
+    double saved_found= (double) MY_MAX(saved_tab->found_records, 1);
+
+    if (saved_tab->table_map_id != tab->table->s->table_map_id ||
+        saved_tab->stats_version != tab->table->s->stats_version ||
+        found > saved_found * max_ratio || saved_found > found * max_ratio)
+      return false;
+  }
+  return true;
+}
+
+
+/**
+  Save the join order of a select of a prepared statement
+
+  @param join   The join, after the join order has been chosen
+  @param saved  The previously saved order of the select, or NULL
+  @param key    saved_join_order_key() of the join
+  @param order  TABLE::tablenr of the tables in the join order
+
+  @details
+    The order is allocated on the arena of the statement, so that it is
+    kept between the executions. The memory of the previous order of the
+    select is reused when the number of tables has not changed.
+
+  @return The saved order, NULL on out of memory
+*/
+
+Saved_join_order *save_join_order(JOIN *join, Saved_join_order *saved,
+                                  const uchar *key, const uchar *order)
+{
+  Query_arena *arena= join->thd->stmt_arena;
+
+  if (!saved || saved->n_tables != join->table_count)
+  {
+    if (!(saved= (Saved_join_order*) arena->alloc(sizeof(Saved_join_order))) ||
+        !(saved->tables= (Saved_join_order_table*)
+          arena->alloc(join->table_count * sizeof(Saved_join_order_table))))
+      return NULL;
+    saved->n_tables= join->table_count;
+  }
+
+  memcpy(saved->key, key, JOIN_ORDER_CACHE_KEY_SIZE);
+  memcpy(saved->order + join->const_tables, order + join->const_tables,
+         join->table_count - join->const_tables);
+  for (uint i= 0; i < join->table_count; i++)
+  {
+    JOIN_TAB *tab= join->join_tab + i;
+    saved->tables[i].table_map_id= tab->table->s->table_map_id;
+    saved->tables[i].stats_version= tab->table->s->stats_version;
+    saved->tables[i].found_records= tab->found_records;
+  }
+  return saved;
+}
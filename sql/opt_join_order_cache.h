@@ -0,0 +1,65 @@
+/*
+   Copyright (c) 2024, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1335  USA */
+
+#ifndef OPT_JOIN_ORDER_CACHE_INCLUDED
+#define OPT_JOIN_ORDER_CACHE_INCLUDED
+
+#include "my_md5.h"
+
+class JOIN;
+
+/* Size of the key of a cached join order */
+#define JOIN_ORDER_CACHE_KEY_SIZE MD5_HASH_SIZE
+
+extern ulong join_order_cache_size;
+
+bool join_order_cache_init();
+void join_order_cache_free();
+void join_order_cache_resize(uint size);
+
+bool join_order_cache_key(JOIN *join, uchar *key);
+bool join_order_cache_lookup(const uchar *key, uchar *order, uint n_tables);
+void join_order_cache_store(const uchar *key, const uchar *order,
+                            uint n_tables);
+
+/* Statistics of a table of a saved join order */
+struct Saved_join_order_table
+{
+  ulonglong table_map_id;
+  uint32 stats_version;
+  ha_rows found_records;
+};
+
+/*
+  Join order of a select of a prepared statement, kept for the next
+  executions of the statement
+*/
+class Saved_join_order
+{
+public:
+  uchar key[JOIN_ORDER_CACHE_KEY_SIZE];
+  uint n_tables;
+  uchar order[MAX_TABLES];
+  Saved_join_order_table *tables;               /* By JOIN::join_tab index */
+};
+
+bool saved_join_order_key(JOIN *join, uchar *key);
+bool saved_join_order_is_usable(JOIN *join, const Saved_join_order *saved,
+                                const uchar *key, ulong max_ratio);
+Saved_join_order *save_join_order(JOIN *join, Saved_join_order *saved,
+                                  const uchar *key, const uchar *order);
+
+#endif /* OPT_JOIN_ORDER_CACHE_INCLUDED */
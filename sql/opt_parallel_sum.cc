@@ -0,0 +1,442 @@
+/*
+   Copyright (c) 2024, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1335  USA */
+
+
+/**
+  @file
+
+  Computing COUNT(), SUM(), MIN() and MAX() of a single table by a
+  parallel scan of the table.
+
+  When opt_sum_query() could not replace the aggregate functions of a
+  query with implicit grouping by constants, and the query is of the form
+
+  @verbatim
+  SELECT COUNT(*), COUNT(a), SUM(a), MIN(b), MAX(b), ... FROM t1
+  @endverbatim
+
+  where the arguments are integer columns of t1 (except BIGINT UNSIGNED),
+  the table is read by handler::parallel_scan(). Every worker thread
+  aggregates the rows it reads into its own set of partial states, which
+  are merged by the connection thread afterwards. The aggregate functions
+  are then made constants, exactly like opt_sum_query() does, and the
+  table is removed from the join.
+
+  This is only done when @@max_scan_threads > 1, for plain SELECT
+  statements without WHERE, HAVING, DISTINCT or window functions, outside
+  of subqueries, and when the table has enough rows to keep at least two
+  threads busy. The threads other than the connection thread are reserved
+  from @@max_parallel_threads. Otherwise, if none is left, or if the
+  engine does not support parallel scans of the table, the query is
+  executed as before.
+*/
+
+#include "mariadb.h"
+#include "sql_priv.h"
+#include "sql_class.h"
+#include "sql_select.h"
+#include "sql_parallel.h"
+
+/* The least number of rows of the table per thread */
+#define PARALLEL_SUM_MIN_ROWS_PER_THREAD 10000
+
+
+static longlong read_tiny(const uchar *ptr)   { return (signed char) *ptr; }
+static longlong read_utiny(const uchar *ptr)  { return *ptr; }
+static longlong read_short(const uchar *ptr)  { return sint2korr(ptr); }
+static longlong read_ushort(const uchar *ptr) { return uint2korr(ptr); }
+static longlong read_medium(const uchar *ptr) { return sint3korr(ptr); }
+static longlong read_umedium(const uchar *ptr){ return uint3korr(ptr); }
+static longlong read_long(const uchar *ptr)   { return sint4korr(ptr); }
+static longlong read_ulong(const uchar *ptr)  { return uint4korr(ptr); }
+static longlong read_longlong(const uchar *ptr) { return sint8korr(ptr); }
+
+
+/* One aggregate function that is computed by the scan */
+
+struct Parallel_sum_func
+{
+  Item_sum *item;
+  Item_sum::Sumfunctype func;
+  /* The column; offset is (size_t) -1 for COUNT() of a constant */
+  size_t offset;
+  size_t null_offset;
+  uchar null_bit;
+  longlong (*read)(const uchar *);
+};
+
+
+/*
+  Partial state of one aggregate function in one worker thread.
+  The sum is kept as the 128-bit integer sum_hi * 2^64 + sum_lo, which
+  cannot overflow for any table.
+*/
+
+struct Parallel_sum_state
+{
+  ha_rows count;                 /* Number of non-NULL values */
+  ulonglong sum_lo;
+  longlong sum_hi;
+  longlong value;                /* MIN() or MAX() */
+};
+
+
+class Parallel_sum_rows : public Parallel_scan_rows
+{
+public:
+  Parallel_sum_rows(Parallel_sum_func *funcs_arg, uint n_funcs_arg,
+                    uchar *states_arg, size_t stride_arg)
+    : funcs(funcs_arg), n_funcs(n_funcs_arg), states(states_arg),
+      stride(stride_arg)
+  {}
+
+  bool add_row(uint worker, const uchar *record) override
+  {
+    Parallel_sum_state *state=
+      (Parallel_sum_state *) (states + worker * stride);
+    for (uint i= 0; i < n_funcs; i++, state++)
+    {
+      const Parallel_sum_func *f= funcs + i;
+      if (f->offset == (size_t) -1)
+      {
+        state->count++;
+        continue;
+      }
+      if (record[f->null_offset] & f->null_bit)
+        continue;
+      longlong value= f->read(record + f->offset);
+      switch (f->func) {
+      case Item_sum::SUM_FUNC:
+      {
+        ulonglong lo= state->sum_lo + (ulonglong) value;
+        if (value >= 0)
+          state->sum_hi+= lo < state->sum_lo;
+        else
+          state->sum_hi-= lo > state->sum_lo;
+        state->sum_lo= lo;
+        break;
+      }
+      case Item_sum::MIN_FUNC:
+        if (!state->count || value < state->value)
+          state->value= value;
+        break;
+      case Item_sum::MAX_FUNC:
+        if (!state->count || value > state->value)
+          state->value= value;
+        break;
+      default:
+        break;
+      }
+      state->count++;
+    }
+    return false;
+  }
+
+private:
+  Parallel_sum_func *funcs;
+  uint n_funcs;
+  uchar *states;
+  size_t stride;
+};
+
+
+/*
+  Check if the argument of an aggregate function can be read by the
+  parallel scan, and describe it in *f.
+*/
+
+static bool parallel_sum_arg(TABLE *table, Item_sum *item,
+                             Parallel_sum_func *f)
+{
+  Item *arg= item->get_arg(0);
+  f->item= item;
+  f->func= item->sum_func();
+  f->offset= (size_t) -1;
+  f->null_offset= 0;
+  f->null_bit= 0;
+  f->read= NULL;
+
+  if (f->func == Item_sum::COUNT_FUNC && arg->const_item() &&
+      !arg->is_expensive() && !arg->maybe_null())
+    return true;                                // COUNT(*)
+
+  Item *real= arg->real_item();
+  if (real->type() != Item::FIELD_ITEM)
+    return false;
+  Field *field= ((Item_field *) real)->field;
+  if (field->table != table || !field->stored_in_db())
+    return false;
+
+  bool is_unsigned= ((Field_num *) field)->unsigned_flag;
+  switch (field->real_type()) {
+  case MYSQL_TYPE_TINY:
+    f->read= is_unsigned ? read_utiny : read_tiny;
+    break;
+  case MYSQL_TYPE_SHORT:
+    f->read= is_unsigned ? read_ushort : read_short;
+    break;
+  case MYSQL_TYPE_INT24:
+    f->read= is_unsigned ? read_umedium : read_medium;
+    break;
+  case MYSQL_TYPE_LONG:
+    f->read= is_unsigned ? read_ulong : read_long;
+    break;
+  case MYSQL_TYPE_LONGLONG:
+    if (is_unsigned)
+      return false;
+    f->read= read_longlong;
+    break;
+  default:
+    return false;
+  }
+
+  if (f->func == Item_sum::SUM_FUNC && item->result_type() != DECIMAL_RESULT)
+    return false;
+
+  DBUG_ASSERT(bitmap_is_set(table->read_set, field->field_index));
+  f->offset= (size_t) (field->ptr - table->record[0]);
+  if (field->null_ptr)
+  {
+    f->null_offset= (size_t) (field->null_ptr - table->record[0]);
+    f->null_bit= field->null_bit;
+  }
+  return true;
+}
+
+
+/**
+  Get sum_hi * 2^64 + sum_lo as a decimal.
+
+  @note This is declared in sql_select.h, for sql_window.cc.
+*/
+
+void parallel_sum_decimal(longlong sum_hi, ulonglong sum_lo, my_decimal *to)
+{
+  my_decimal hi, lo, two32, two64, tmp;
+  int2my_decimal(E_DEC_FATAL_ERROR, 1LL << 32, FALSE, &two32);
+  my_decimal_mul(E_DEC_FATAL_ERROR, &two64, &two32, &two32);
+  int2my_decimal(E_DEC_FATAL_ERROR, sum_hi, FALSE, &hi);
+  my_decimal_mul(E_DEC_FATAL_ERROR, &tmp, &hi, &two64);
+  int2my_decimal(E_DEC_FATAL_ERROR, (longlong) sum_lo, TRUE, &lo);
+  my_decimal_add(E_DEC_FATAL_ERROR, to, &tmp, &lo);
+}
+
+
+/**
+  Compute the aggregate functions of a single-table query with implicit
+  grouping by a parallel scan of the table, and replace them with
+  constants.
+
+  @param join  the join, after opt_sum_query() returned 0
+
+  @retval
+    0       the query is not suitable, nothing was done
+  @retval
+    1       all aggregate functions were replaced
+  @retval
+    HA_ERR_...  error of the scan; the error has been reported
+*/
+
+int opt_parallel_sum_query(JOIN *join)
+{
+  THD *thd= join->thd;
+  SELECT_LEX *select_lex= join->select_lex;
+  List_iterator_fast<Item> it(join->all_fields);
+  Parallel_sum_func *funcs;
+  uint n_funcs= 0;
+  Item *item;
+  DBUG_ENTER("opt_parallel_sum_query");
+
+  if (thd->variables.max_scan_threads <= 1 ||
+      join->conds || join->having || join->select_distinct ||
+      select_lex->leaf_tables.elements != 1 ||
+      select_lex->have_window_funcs() ||
+      select_lex->master_unit()->item ||
+      thd->lex->sql_command != SQLCOM_SELECT ||
+      thd->lex->describe || thd->lex->analyze_stmt)
+    DBUG_RETURN(0);
+
+  TABLE_LIST *tl= select_lex->leaf_tables.head();
+  TABLE *table= tl->table;
+  if (!table || tl->on_expr || tl->schema_table || tl->jtbm_subselect ||
+      tl->is_materialized_derived() || table->file->inited ||
+      table->const_table)
+    DBUG_RETURN(0);
+
+  /* Describe the aggregate functions; all others must be constant */
+  if (!(funcs= (Parallel_sum_func *)
+        thd->alloc(sizeof(Parallel_sum_func) * join->all_fields.elements)))
+    DBUG_RETURN(0);
+  while ((item= it++))
+  {
+    if (item->type() == Item::SUM_FUNC_ITEM)
+    {
+      Item_sum *item_sum= (Item_sum *) item;
+      if (item_sum->const_item())
+        continue;                       // Replaced by opt_sum_query()
+      switch (item_sum->sum_func()) {
+      case Item_sum::COUNT_FUNC:
+      case Item_sum::SUM_FUNC:
+      case Item_sum::MIN_FUNC:
+      case Item_sum::MAX_FUNC:
+        break;
+      default:
+        DBUG_RETURN(0);
+      }
+      if ((item_sum->used_tables() & OUTER_REF_TABLE_BIT) ||
+          item_sum->get_arg_count() != 1 ||
+          !parallel_sum_arg(table, item_sum, funcs + n_funcs))
+        DBUG_RETURN(0);
+      n_funcs++;
+    }
+    else if (item->with_field() || item->with_subquery())
+      DBUG_RETURN(0);
+  }
+  if (!n_funcs)
+    DBUG_RETURN(0);
+
+  int error= table->file->info(HA_STATUS_VARIABLE | HA_STATUS_NO_LOCK);
+  if (unlikely(error))
+  {
+    table->file->print_error(error, MYF(0));
+    DBUG_RETURN(error);
+  }
+  ha_rows n_threads= table->file->stats.records /
+                     PARALLEL_SUM_MIN_ROWS_PER_THREAD;
+  set_if_smaller(n_threads, thd->variables.max_scan_threads);
+  if (n_threads < 2)
+    DBUG_RETURN(0);
+
+  /* Give every thread its own cache lines */
+  size_t stride= MY_ALIGN(sizeof(Parallel_sum_state) * n_funcs,
+                          CPU_LEVEL1_DCACHE_LINESIZE);
+  uchar *states= (uchar *) thd->calloc(stride * (size_t) n_threads +
+                                       CPU_LEVEL1_DCACHE_LINESIZE);
+  if (!states)
+    DBUG_RETURN(0);
+  states= (uchar *) MY_ALIGN((size_t) states, CPU_LEVEL1_DCACHE_LINESIZE);
+
+  /*
+    The connection thread is one of the threads of the scan. The states
+    of threads that we do not get stay empty.
+  */
+  uint workers= parallel_threads_reserve((uint) n_threads - 1);
+  if (!workers)
+    DBUG_RETURN(0);
+  Parallel_sum_rows rows(funcs, n_funcs, states, stride);
+  error= table->file->parallel_scan(workers + 1, &rows);
+  parallel_threads_release(workers);
+  if (error == HA_ERR_UNSUPPORTED)
+    DBUG_RETURN(0);
+  if (unlikely(error))
+  {
+    table->file->print_error(error, MYF(0));
+    DBUG_RETURN(error);
+  }
+  DBUG_PRINT("info", ("functions: %u  threads: %u", n_funcs, workers + 1));
+
+  /*
+    Merge the partial states, and do everything that can fail before
+    any function is replaced with a constant: if we gave up halfway,
+    the remaining functions would be computed by the normal execution,
+    but the replaced ones would no longer be.
+  */
+  Parallel_sum_state *totals= (Parallel_sum_state *)
+    thd->calloc(sizeof(Parallel_sum_state) * n_funcs);
+  Item **values= (Item **) thd->calloc(sizeof(Item *) * n_funcs);
+  if (!totals || !values)
+    DBUG_RETURN(0);
+
+  for (uint i= 0; i < n_funcs; i++)
+  {
+    Parallel_sum_func *f= funcs + i;
+    Parallel_sum_state &total= totals[i];
+    bool found= false;
+
+    for (uint w= 0; w < (uint) n_threads; w++)
+    {
+      const Parallel_sum_state *state=
+        (Parallel_sum_state *) (states + w * stride) + i;
+      if (!state->count)
+        continue;
+      total.count+= state->count;
+      ulonglong lo= total.sum_lo + state->sum_lo;
+      total.sum_hi+= state->sum_hi + (lo < total.sum_lo);
+      total.sum_lo= lo;
+      if (!found ||
+          (f->func == Item_sum::MIN_FUNC && state->value < total.value) ||
+          (f->func == Item_sum::MAX_FUNC && state->value > total.value))
+        total.value= state->value;
+      found= true;
+    }
+
+    if (f->func == Item_sum::COUNT_FUNC)
+      continue;
+    /*
+      COUNT(), SUM() and MIN() or MAX() without DISTINCT use this
+      aggregator in the normal execution too, so this can be left set.
+    */
+    if (f->item->set_aggregator(thd, Aggregator::SIMPLE_AGGREGATOR))
+      DBUG_RETURN(0);
+    if (f->func != Item_sum::SUM_FUNC && total.count &&
+        !(values[i]= new (thd->mem_root) Item_int(thd, total.value)))
+      DBUG_RETURN(0);
+  }
+
+  /* Replace the functions with constants */
+  for (uint i= 0; i < n_funcs; i++)
+  {
+    Parallel_sum_func *f= funcs + i;
+    const Parallel_sum_state &total= totals[i];
+
+    if (f->func == Item_sum::COUNT_FUNC)
+    {
+      ((Item_sum_count *) f->item)->make_const((longlong) total.count);
+      continue;
+    }
+
+    f->item->aggregator_clear();
+    if (total.count)
+    {
+      if (f->func == Item_sum::SUM_FUNC)
+      {
+        my_decimal sum;
+        parallel_sum_decimal(total.sum_hi, total.sum_lo, &sum);
+        ((Item_sum_sum *) f->item)->direct_add(&sum);
+      }
+      else
+      {
+        ((Item_sum_min_max *) f->item)->direct_add(values[i]);
+        /* As in opt_sum_query(), for a possible rollback */
+        select_lex->min_max_opt_list.push_back(f->item);
+      }
+      f->item->aggregator_add();
+    }
+    f->item->make_const();
+  }
+
+  int const_result= 1;
+  it.rewind();
+  while ((item= it++))
+  {
+    if (item->type() == Item::SUM_FUNC_ITEM)
+      continue;
+    item->update_used_tables();
+    if (!item->const_item())
+      const_result= 0;
+  }
+  DBUG_RETURN(const_result);
+}
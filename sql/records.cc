@@ -37,6 +37,7 @@
 
 static int rr_quick(READ_RECORD *info);
 int rr_sequential(READ_RECORD *info);
+static int rr_sequential_batch(READ_RECORD *info);
 static int rr_from_tempfile(READ_RECORD *info);
 template<bool> static int rr_unpack_from_tempfile(READ_RECORD *info);
 template<bool,bool> static int rr_unpack_from_buffer(READ_RECORD *info);
@@ -348,6 +349,39 @@ bool init_read_record(READ_RECORD *info,THD *thd, TABLE *table,
 
 
 
+/**
+  Make a table scan set up by init_read_record() read the rows in batches
+
+  @param info  The scan, read_record_func must be rr_sequential
+  @param buf   Buffer for 'rows' rows of table->s->reclength bytes, owned
+               by the caller. The columns that are not read are taken
+               from the buffer as they are.
+  @param rows  Number of rows in a batch
+
+  @details
+    The rows are read ahead of their use, so this is only allowed when
+    the caller neither locks the rows nor uses the position of the
+    handler (handler::position(), update or delete of the current row).
+    Virtual columns are not supported.
+
+  @retval false  ok
+  @retval true   the scan can't be read in batches
+*/
+
+bool init_read_record_batch(READ_RECORD *info, uchar *buf, uint rows)
+{
+  if (info->read_record_func != rr_sequential || rows < 2 ||
+      info->table->vfield)
+    return true;
+  info->reclength= info->table->s->reclength;
+  info->batch_buf= buf;
+  info->batch_rows= rows;
+  info->cache_pos= info->cache_end= buf;
+  info->read_record_func= rr_sequential_batch;
+  return false;
+}
+
+
 void end_read_record(READ_RECORD *info)
 {
   /* free cache if used */
@@ -519,6 +553,38 @@ int rr_sequential(READ_RECORD *info)
 }
 
 
+/**
+  Read the next row of a table scan from the batch of rows read ahead by
+  handler::ha_rnd_next_batch(), reading a new batch when it is used up.
+  Falls back to rr_sequential() if the handler can't read batches.
+*/
+
+static int rr_sequential_batch(READ_RECORD *info)
+{
+  if (info->cache_pos == info->cache_end)
+  {
+    uint n_rows;
+    int tmp= info->table->file->ha_rnd_next_batch(info->batch_buf,
+                                                  info->reclength,
+                                                  info->batch_rows, &n_rows);
+    if (unlikely(tmp))
+    {
+      if (tmp == HA_ERR_UNSUPPORTED)
+      {
+        info->read_record_func= rr_sequential;
+        return rr_sequential(info);
+      }
+      return rr_handle_error(info, tmp);
+    }
+    info->cache_pos= info->batch_buf;
+    info->cache_end= info->batch_buf + (size_t) n_rows * info->reclength;
+  }
+  memcpy(info->record(), info->cache_pos, info->reclength);
+  info->cache_pos+= info->reclength;
+  return 0;
+}
+
+
 static int rr_from_tempfile(READ_RECORD *info)
 {
   int tmp;
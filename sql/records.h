@@ -70,6 +70,9 @@ struct READ_RECORD
   uchar *ref_pos;				/* pointer to form->refpos */
   uchar *rec_buf;                /* to read field values  after filesort */
   uchar	*cache,*cache_pos,*cache_end,*read_positions;
+  /* Rows of a table scan read in batches, see init_read_record_batch() */
+  uchar *batch_buf;
+  uint batch_rows;
 
   /*
     Structure storing information about sorting
@@ -98,6 +101,7 @@ bool init_read_record(READ_RECORD *info, THD *thd, TABLE *reg_form,
                       bool print_errors, bool disable_rr_cache);
 bool init_read_record_idx(READ_RECORD *info, THD *thd, TABLE *table,
                           bool print_error, uint idx, bool reverse);
+bool init_read_record_batch(READ_RECORD *info, uchar *buf, uint rows);
 
 void rr_unlock_row(st_join_table *tab);
 
@@ -232,6 +232,8 @@ void Ack_receiver::run()
 {
   THD *thd= new THD(next_thread_id());
   NET net;
+  /* Only carries the zstd state of the replica that is read */
+  NET_SERVER net_server= { NULL, NULL, NULL, NULL };
   unsigned char net_buff[REPLY_MESSAGE_MAX_LENGTH];
   DBUG_ENTER("Ack_receiver::run");
 
@@ -338,6 +340,13 @@ void Ack_receiver::run()
           Slave_compress_protocol flag enabled Slaves
         */
         net.compress= slave->thd->net.compress;
+        /*
+          The dump thread only writes to the connection, so the zstd stream
+          in the other direction can be read here
+        */
+        net_server.m_compress_ctx=
+          slave->thd->m_net_server_extension.m_compress_ctx;
+        net.extension= &net_server;
 
         if (unlikely(listener.is_socket_hangup(slave)))
         {
@@ -13495,6 +13495,7 @@ static bool send_server_handshake_packet(MPVIO_EXT *mpvio,
     thd->client_capabilities|= CLIENT_TRANSACTIONS;
 
   thd->client_capabilities|= CAN_CLIENT_COMPRESS;
+  thd->client_capabilities|= CAN_CLIENT_ZSTD_COMPRESS;
 
   if (ssl_acceptor_fd)
   {
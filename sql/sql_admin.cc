@@ -1435,12 +1435,16 @@ static bool mysql_admin_table(THD* thd, TABLE_LIST* tables,
         table->table= 0;                        // For query cache
         query_cache_invalidate3(thd, table, 0);
       }
-      else if (collect_eis && skip_flush && compl_result_code == HA_ADMIN_OK)
+      else if (skip_flush && compl_result_code == HA_ADMIN_OK)
       {
-        TABLE_LIST *save_next_global= table->next_global;
-        table->next_global= 0;
-        read_statistics_for_tables(thd, table, true /* force_reload */);
-        table->next_global= save_next_global;
+        if (collect_eis)
+        {
+          TABLE_LIST *save_next_global= table->next_global;
+          table->next_global= 0;
+          read_statistics_for_tables(thd, table, true /* force_reload */);
+          table->next_global= save_next_global;
+        }
+        table->table->s->stats_version++;
       }
     }
     /* Error path, a admin command failed. */
@@ -223,12 +223,15 @@ class Counter_tracker
 class Table_access_tracker
 {
 public:
-  Table_access_tracker() : r_scans(0), r_rows(0), r_rows_after_where(0)
+  Table_access_tracker() : r_scans(0), r_rows(0), r_rows_after_where(0),
+    r_batch_rows(0), r_batch_rows_selected(0)
   {}
 
   ha_rows r_scans; /* how many scans were ran on this join_tab */
   ha_rows r_rows; /* How many rows we've got after that */
   ha_rows r_rows_after_where; /* Rows after applying attached part of WHERE */
+  ha_rows r_batch_rows; /* Rows checked by batch filter kernels */
+  ha_rows r_batch_rows_selected; /* Rows that passed the batch kernels */
 
   double get_avg_rows() const
   {
@@ -243,23 +246,134 @@ class Table_access_tracker
       : 0;
   }
 
+  /*
+    Rows that were checked against the attached condition. The rows that
+    were rejected by the batch kernels are read, but never reach it.
+  */
+  ha_rows get_rows_checked() const
+  {
+    return r_rows - (r_batch_rows - r_batch_rows_selected);
+  }
+
   double get_filtered_after_where() const
   {
-    return r_rows > 0
+    ha_rows rows_checked= get_rows_checked();
+    return rows_checked > 0
       ? static_cast<double>(r_rows_after_where) /
-        static_cast<double>(r_rows)
+        static_cast<double>(rows_checked)
+      : 1.0;
+  }
+
+  double get_filtered_by_batch() const
+  {
+    return r_batch_rows > 0
+      ? static_cast<double>(r_batch_rows_selected) /
+        static_cast<double>(r_batch_rows)
       : 1.0;
   }
 
   inline void on_scan_init() { r_scans++; }
   inline void on_record_read() { r_rows++; }
   inline void on_record_after_where() { r_rows_after_where++; }
+  inline void on_batch_filtered(ha_rows rows, ha_rows selected)
+  {
+    r_batch_rows+= rows;
+    r_batch_rows_selected+= selected;
+  }
 
   bool has_scans() const { return (r_scans != 0); }
+  bool has_batch_filter() const { return (r_batch_rows != 0); }
   ha_rows get_loops() const { return r_scans; }
 };
 
 
+/*
+  A class for collecting statistics of a hashed join buffer that spills
+  the records of the join operands into partition files.
+*/
+
+class Join_spill_tracker
+{
+public:
+  Join_spill_tracker() : r_spills(0), r_partitions(0), r_spilled_bytes(0),
+    r_max_depth(0)
+  {}
+
+  ha_rows r_spills; /* How many times the join buffer overflowed */
+  ulonglong r_partitions; /* Partitions created, including sub-partitions */
+  ulonglong r_spilled_bytes; /* Bytes written into the partition files */
+  uint r_max_depth; /* Maximal level of recursive re-partitioning */
+
+  inline void on_spill(uint partitions)
+  {
+    r_spills++;
+    r_partitions+= partitions;
+  }
+  inline void on_repartition(uint partitions, uint level)
+  {
+    r_partitions+= partitions;
+    set_if_bigger(r_max_depth, level);
+  }
+  inline void on_write(size_t bytes) { r_spilled_bytes+= bytes; }
+
+  bool has_spills() const { return (r_spills != 0); }
+};
+
+
+/*
+  A class for collecting statistics of the Bloom filter built over the join
+  keys of the records in a join buffer
+*/
+
+class Join_bloom_tracker
+{
+public:
+  Join_bloom_tracker() : r_rows_checked(0), r_rows_eliminated(0),
+    r_probes(0), r_sum_fpr(0.0)
+  {}
+
+  ha_rows r_rows_checked; /* Rows of the joined table checked by the filter */
+  ha_rows r_rows_eliminated; /* Rows that did not pass the filter */
+  ha_rows r_probes; /* How many times a filled filter was probed */
+  double r_sum_fpr; /* Sum of the false positive rates of the probed filters */
+
+  inline void on_row_checked(bool passed)
+  {
+    r_rows_checked++;
+    if (!passed)
+      r_rows_eliminated++;
+  }
+  inline void on_probe(double false_positive_rate)
+  {
+    r_probes++;
+    r_sum_fpr+= false_positive_rate;
+  }
+
+  bool has_checks() const { return (r_rows_checked != 0); }
+  double get_false_positive_rate() const
+  {
+    return r_probes ? r_sum_fpr / static_cast<double>(r_probes) : 0;
+  }
+};
+
+
+/*
+  A class for collecting statistics of GROUP BY computed with a Group_hash
+*/
+
+class Group_hash_tracker
+{
+public:
+  Group_hash_tracker() : r_groups(0), r_spills(0) {}
+
+  ha_rows r_groups; /* Groups collected in the hash */
+  ha_rows r_spills; /* Executions that ran out of memory for the hash */
+
+  inline void on_group() { r_groups++; }
+  inline void on_spill() { r_spills++; }
+};
+
+
 class Json_writer;
 
 /*
@@ -0,0 +1,473 @@
+/*
+   Copyright (c) 2024, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#include "mariadb.h"
+#include "sql_priv.h"
+#include "sql_class.h"
+#include "sql_select.h"
+#include "sql_batch_filter.h"
+#include <algorithm>
+
+/* Batches smaller than this are not worth the copying */
+#define BATCH_FILTER_MIN_ROWS 16
+
+/*
+  One conjunct of the attached condition compiled into a loop over the
+  values of a column.
+*/
+
+class Batch_filter_kernel : public Sql_alloc
+{
+public:
+  enum kernel_type
+  {
+    KERNEL_EQ, KERNEL_NE, KERNEL_LT, KERNEL_LE, KERNEL_GT, KERNEL_GE,
+    KERNEL_BETWEEN, KERNEL_IN
+  };
+
+  Batch_filter_kernel(Field *field_arg, kernel_type type_arg,
+                      longlong a_arg, longlong b_arg)
+    : field(field_arg), type(type_arg), a(a_arg), b(b_arg),
+      list(NULL), list_length(0)
+  {}
+
+  void run(uchar *sel, const longlong *values, const uchar *nulls,
+           uint n_rows) const;
+
+  Field *field;
+  kernel_type type;
+  longlong a, b;
+  /* Sorted list of values for KERNEL_IN */
+  longlong *list;
+  uint list_length;
+
+private:
+  bool in_list(longlong value) const
+  {
+    uint lo= 0, hi= list_length;
+    while (lo < hi)
+    {
+      uint mid= (lo + hi) / 2;
+      if (list[mid] < value)
+        lo= mid + 1;
+      else
+        hi= mid;
+    }
+    return lo < list_length && list[lo] == value;
+  }
+};
+
+
+/*
+  The loops below are kept free of branches and function calls so that
+  the compiler can vectorize them.
+*/
+
+void Batch_filter_kernel::run(uchar *sel, const longlong *values,
+                              const uchar *nulls, uint n_rows) const
+{
+  uint i;
+  switch (type) {
+  case KERNEL_EQ:
+    for (i= 0; i < n_rows; i++)
+      sel[i]&= (uchar) (values[i] == a);
+    break;
+  case KERNEL_NE:
+    for (i= 0; i < n_rows; i++)
+      sel[i]&= (uchar) (values[i] != a);
+    break;
+  case KERNEL_LT:
+    for (i= 0; i < n_rows; i++)
+      sel[i]&= (uchar) (values[i] < a);
+    break;
+  case KERNEL_LE:
+    for (i= 0; i < n_rows; i++)
+      sel[i]&= (uchar) (values[i] <= a);
+    break;
+  case KERNEL_GT:
+    for (i= 0; i < n_rows; i++)
+      sel[i]&= (uchar) (values[i] > a);
+    break;
+  case KERNEL_GE:
+    for (i= 0; i < n_rows; i++)
+      sel[i]&= (uchar) (values[i] >= a);
+    break;
+  case KERNEL_BETWEEN:
+    for (i= 0; i < n_rows; i++)
+      sel[i]&= (uchar) ((values[i] >= a) & (values[i] <= b));
+    break;
+  case KERNEL_IN:
+    for (i= 0; i < n_rows; i++)
+    {
+      if (sel[i])
+        sel[i]= (uchar) in_list(values[i]);
+    }
+    break;
+  }
+
+  /* A NULL value never satisfies a top-level conjunct */
+  if (nulls)
+  {
+    for (i= 0; i < n_rows; i++)
+      sel[i]&= (uchar) !nulls[i];
+  }
+}
+
+
+static longlong read_tiny(const uchar *ptr)   { return (signed char) *ptr; }
+static longlong read_utiny(const uchar *ptr)  { return *ptr; }
+static longlong read_short(const uchar *ptr)  { return sint2korr(ptr); }
+static longlong read_ushort(const uchar *ptr) { return uint2korr(ptr); }
+static longlong read_medium(const uchar *ptr) { return sint3korr(ptr); }
+static longlong read_umedium(const uchar *ptr){ return uint3korr(ptr); }
+static longlong read_long(const uchar *ptr)   { return sint4korr(ptr); }
+static longlong read_ulong(const uchar *ptr)  { return uint4korr(ptr); }
+static longlong read_longlong(const uchar *ptr) { return sint8korr(ptr); }
+
+template <longlong (*read)(const uchar *)>
+static void extract_values(longlong *values, const uchar *ptr, size_t step,
+                           uint n_rows)
+{
+  for (uint i= 0; i < n_rows; i++, ptr+= step)
+    values[i]= read(ptr);
+}
+
+
+/*
+  Return the field if item refers to an integer column of the table that
+  batch kernels can read directly from the record, NULL otherwise.
+*/
+
+static Field *batch_filter_field(TABLE *table, Item *item)
+{
+  Item *real= item->real_item();
+  if (real->type() != Item::FIELD_ITEM)
+    return NULL;
+  Field *field= ((Item_field *) real)->field;
+  if (field->table != table)
+    return NULL;
+
+  switch (field->real_type()) {
+  case MYSQL_TYPE_TINY:
+  case MYSQL_TYPE_SHORT:
+  case MYSQL_TYPE_INT24:
+  case MYSQL_TYPE_LONG:
+    break;
+  case MYSQL_TYPE_LONGLONG:
+    /* Values above LONGLONG_MAX would not fit the kernel representation */
+    if (((Field_num *) field)->unsigned_flag)
+      return NULL;
+    break;
+  default:
+    return NULL;
+  }
+  DBUG_ASSERT(bitmap_is_set(table->read_set, field->field_index));
+  return field;
+}
+
+
+/*
+  Get the value of an integer literal or parameter.
+
+  @return false  ok, the value is stored in *value
+  @return true   item is not a usable constant
+*/
+
+static bool batch_filter_const(Item *item, longlong *value)
+{
+  if (!item->basic_const_item() || item->cmp_type() != INT_RESULT)
+    return true;
+  longlong val= item->val_int();
+  if (item->null_value || (item->unsigned_flag && val < 0))
+    return true;
+  *value= val;
+  return false;
+}
+
+
+/**
+  @brief Try to compile a conjunct of the attached condition into a kernel
+
+  @return true on out of memory. A conjunct that has no kernel is skipped
+          and false is returned.
+*/
+
+bool Batch_filter::add_conjunct(THD *thd, Item *cond)
+{
+  if (cond->type() != Item::FUNC_ITEM)
+    return false;
+
+  Item_func *func= (Item_func *) cond;
+  Item **args= func->arguments();
+  Batch_filter_kernel *kernel= NULL;
+  Batch_filter_kernel::kernel_type type;
+  Field *field;
+  longlong a, b;
+
+  switch (func->functype()) {
+  case Item_func::EQ_FUNC:
+  case Item_func::NE_FUNC:
+  case Item_func::LT_FUNC:
+  case Item_func::LE_FUNC:
+  case Item_func::GT_FUNC:
+  case Item_func::GE_FUNC:
+  {
+    bool swapped= false;
+    if ((field= batch_filter_field(table, args[0])) &&
+        !batch_filter_const(args[1], &a))
+      ;
+    else if ((field= batch_filter_field(table, args[1])) &&
+             !batch_filter_const(args[0], &a))
+      swapped= true;
+    else
+      return false;
+
+    switch (func->functype()) {
+    case Item_func::EQ_FUNC:
+      type= Batch_filter_kernel::KERNEL_EQ;
+      break;
+    case Item_func::NE_FUNC:
+      type= Batch_filter_kernel::KERNEL_NE;
+      break;
+    case Item_func::LT_FUNC:
+      type= swapped ? Batch_filter_kernel::KERNEL_GT :
+                      Batch_filter_kernel::KERNEL_LT;
+      break;
+    case Item_func::LE_FUNC:
+      type= swapped ? Batch_filter_kernel::KERNEL_GE :
+                      Batch_filter_kernel::KERNEL_LE;
+      break;
+    case Item_func::GT_FUNC:
+      type= swapped ? Batch_filter_kernel::KERNEL_LT :
+                      Batch_filter_kernel::KERNEL_GT;
+      break;
+    default:
+      type= swapped ? Batch_filter_kernel::KERNEL_LE :
+                      Batch_filter_kernel::KERNEL_GE;
+      break;
+    }
+    kernel= new (thd->mem_root) Batch_filter_kernel(field, type, a, 0);
+    break;
+  }
+  case Item_func::BETWEEN:
+  {
+    if (((Item_func_between *) func)->negated ||
+        !(field= batch_filter_field(table, args[0])) ||
+        batch_filter_const(args[1], &a) ||
+        batch_filter_const(args[2], &b))
+      return false;
+    kernel= new (thd->mem_root)
+      Batch_filter_kernel(field, Batch_filter_kernel::KERNEL_BETWEEN, a, b);
+    break;
+  }
+  case Item_func::IN_FUNC:
+  {
+    uint n_values= func->argument_count() - 1;
+    longlong *list;
+    if (((Item_func_in *) func)->negated ||
+        !(field= batch_filter_field(table, args[0])))
+      return false;
+    if (!(list= (longlong *) thd->alloc(sizeof(longlong) * n_values)))
+      return true;
+    for (uint i= 0; i < n_values; i++)
+    {
+      if (batch_filter_const(args[i + 1], list + i))
+        return false;
+    }
+    std::sort(list, list + n_values);
+    if (!(kernel= new (thd->mem_root)
+          Batch_filter_kernel(field, Batch_filter_kernel::KERNEL_IN, 0, 0)))
+      return true;
+    kernel->list= list;
+    kernel->list_length= n_values;
+    break;
+  }
+  default:
+    return false;
+  }
+
+  return !kernel || kernels.append(kernel);
+}
+
+
+bool Batch_filter::alloc_buffers()
+{
+  return !my_multi_malloc(PSI_INSTRUMENT_ME, MYF(MY_WME | MY_THREAD_SPECIFIC),
+                          &rows, (size_t) max_rows * rec_length,
+                          &values, (size_t) max_rows * sizeof(longlong),
+                          &nulls, (size_t) max_rows,
+                          &sel, (size_t) max_rows,
+                          NullS);
+}
+
+
+Batch_filter::~Batch_filter()
+{
+  my_free(rows);
+}
+
+
+/**
+  @brief Create a batch filter for a join tab if it can use one
+
+  @return The filter, or NULL if batch evaluation is disabled, not
+          applicable to the join tab, or no conjunct of its condition has
+          a kernel. On out of memory an error is raised and NULL is returned.
+*/
+
+Batch_filter *Batch_filter::create(THD *thd, JOIN_TAB *tab)
+{
+  TABLE *table= tab->table;
+  Item *cond= tab->select_cond;
+  ulong batch_rows= thd->variables.join_batch_filter_rows;
+  DBUG_ENTER("Batch_filter::create");
+
+  if (!batch_rows || !cond || !table)
+    DBUG_RETURN(NULL);
+
+  /*
+    Rows are read ahead of their evaluation, so the handler must not lock
+    them or be asked about its current position.
+  */
+  if (thd->lex->sql_command != SQLCOM_SELECT ||
+      table->reginfo.lock_type != TL_READ ||
+      tab->keep_current_rowid || tab->loosescan_match_tab ||
+      tab->first_inner || tab->last_inner || tab->bush_children ||
+      tab->cache || table->fulltext_searched)
+    DBUG_RETURN(NULL);
+
+  switch (tab->type) {
+  case JT_ALL:
+  case JT_NEXT:
+  case JT_RANGE:
+  case JT_INDEX_MERGE:
+    break;
+  default:
+    DBUG_RETURN(NULL);
+  }
+
+  /* BLOB values are not stored in the record and would not survive */
+  for (uint *blob= table->s->blob_field,
+            *end= blob + table->s->blob_fields; blob < end; blob++)
+  {
+    if (bitmap_is_set(table->read_set, *blob))
+      DBUG_RETURN(NULL);
+  }
+
+  /* The buffer shares the memory limit of a join buffer */
+  ulonglong max_rows= MY_MIN(batch_rows,
+                             thd->variables.join_buff_size /
+                             table->s->reclength);
+  if (max_rows < BATCH_FILTER_MIN_ROWS)
+    DBUG_RETURN(NULL);
+
+  Batch_filter *filter;
+  if (!(filter= new (thd->mem_root) Batch_filter(table, (uint) max_rows)))
+    DBUG_RETURN(NULL);
+
+  bool oom= false;
+  if (cond->type() == Item::COND_ITEM &&
+      ((Item_cond *) cond)->functype() == Item_func::COND_AND_FUNC)
+  {
+    List_iterator_fast<Item> li(*((Item_cond *) cond)->argument_list());
+    Item *item;
+    while (!oom && (item= li++))
+      oom= filter->add_conjunct(thd, item);
+  }
+  else
+    oom= filter->add_conjunct(thd, cond);
+
+  if (oom || !filter->kernel_count() || filter->alloc_buffers())
+  {
+    delete filter;
+    DBUG_RETURN(NULL);
+  }
+  DBUG_PRINT("info", ("table: %s  kernels: %u  batch rows: %u",
+                      table->alias.c_ptr(), filter->kernel_count(),
+                      filter->capacity()));
+  DBUG_RETURN(filter);
+}
+
+
+void Batch_filter::extract_column(const Field *field, uint n_rows)
+{
+  const uchar *ptr= rows + (field->ptr - table->record[0]);
+  bool is_unsigned= ((const Field_num *) field)->unsigned_flag;
+
+  switch (field->real_type()) {
+  case MYSQL_TYPE_TINY:
+    if (is_unsigned)
+      extract_values<read_utiny>(values, ptr, rec_length, n_rows);
+    else
+      extract_values<read_tiny>(values, ptr, rec_length, n_rows);
+    break;
+  case MYSQL_TYPE_SHORT:
+    if (is_unsigned)
+      extract_values<read_ushort>(values, ptr, rec_length, n_rows);
+    else
+      extract_values<read_short>(values, ptr, rec_length, n_rows);
+    break;
+  case MYSQL_TYPE_INT24:
+    if (is_unsigned)
+      extract_values<read_umedium>(values, ptr, rec_length, n_rows);
+    else
+      extract_values<read_medium>(values, ptr, rec_length, n_rows);
+    break;
+  case MYSQL_TYPE_LONG:
+    if (is_unsigned)
+      extract_values<read_ulong>(values, ptr, rec_length, n_rows);
+    else
+      extract_values<read_long>(values, ptr, rec_length, n_rows);
+    break;
+  case MYSQL_TYPE_LONGLONG:
+    extract_values<read_longlong>(values, ptr, rec_length, n_rows);
+    break;
+  default:
+    DBUG_ASSERT(0);
+  }
+
+  if (field->null_ptr)
+  {
+    const uchar *null_ptr= rows + (field->null_ptr - table->record[0]);
+    uchar null_bit= field->null_bit;
+    for (uint i= 0; i < n_rows; i++, null_ptr+= rec_length)
+      nulls[i]= (uchar) ((*null_ptr & null_bit) != 0);
+  }
+}
+
+
+uint Batch_filter::evaluate(uint n_rows)
+{
+  const Field *extracted= NULL;
+  uint n_selected= 0;
+
+  memset(sel, 1, n_rows);
+  for (size_t k= 0; k < kernels.elements(); k++)
+  {
+    Batch_filter_kernel *kernel= kernels.at(k);
+    /* Kernels on the same column reuse the extracted values */
+    if (kernel->field != extracted)
+    {
+      extract_column(kernel->field, n_rows);
+      extracted= kernel->field;
+    }
+    kernel->run(sel, values, kernel->field->null_ptr ? nulls : NULL, n_rows);
+  }
+
+  for (uint i= 0; i < n_rows; i++)
+    n_selected+= sel[i];
+  return n_selected;
+}
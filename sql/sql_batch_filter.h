@@ -0,0 +1,119 @@
+/*
+   Copyright (c) 2024, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#ifndef SQL_BATCH_FILTER_INCLUDED
+#define SQL_BATCH_FILTER_INCLUDED
+
+#include "mariadb.h"
+#include "sql_array.h"
+
+/*
+  Batch evaluation of simple conditions over a table scan
+  --------------------------------------------------------
+
+  When a join tab is read by a scan, every row is normally passed to
+  evaluate_join_record() which walks the attached condition item tree with
+  virtual val_int() calls. For scans that reject most of the rows this
+  item tree walk dominates the CPU time.
+
+  A batch filter is an opt-in pre-filter (see @@join_batch_filter_rows).
+  Rows read from the handler are accumulated in a buffer, the values of the
+  integer columns referenced by simple top-level conjuncts of the attached
+  condition are extracted into arrays, and each such conjunct is evaluated
+  over the whole batch by a tight loop (a "kernel") that updates a
+  selection vector. Only the rows that survive all kernels are copied back
+  into table->record[0] and passed to evaluate_join_record(), which still
+  checks the complete attached condition. Thus the kernels never change the
+  result, they only drop rows that the condition would reject anyway.
+
+  Conjuncts that have a kernel:
+    int_col {=|<>|<|<=|>|>=} int_const   (and the mirrored form)
+    int_col BETWEEN int_const AND int_const
+    int_col IN (int_const, ...)
+  where int_col is a TINYINT/SMALLINT/MEDIUMINT/INT/BIGINT column of the
+  scanned table (except BIGINT UNSIGNED). All other conjuncts are left to
+  the per-row path.
+
+  The filter is only used for plain SELECT scans without row locking,
+  outside of outer joins and semi-join strategies that need row positions,
+  and for tables that have no BLOB columns in the read set, as the buffered
+  copies of the record must stay valid after the handler has moved on.
+*/
+
+class Batch_filter_kernel;
+struct st_join_table;
+
+class Batch_filter : public Sql_alloc
+{
+public:
+  static Batch_filter *create(THD *thd, st_join_table *tab);
+  ~Batch_filter();
+
+  /* Number of rows that the buffer can hold */
+  uint capacity() const { return max_rows; }
+
+  /* Copy the current record of the table into slot n of the buffer */
+  void store_row(uint n)
+  {
+    DBUG_ASSERT(n < max_rows);
+    memcpy(rows + (size_t) n * rec_length, table->record[0], rec_length);
+  }
+
+  /*
+    Copy buffered row n back into the record of the table. The handler may
+    have reached the end of the scan meanwhile, so the status is reset too.
+  */
+  void restore_row(uint n)
+  {
+    DBUG_ASSERT(n < max_rows);
+    memcpy(table->record[0], rows + (size_t) n * rec_length, rec_length);
+    table->status= 0;
+  }
+
+  /*
+    Run all kernels over the first n_rows buffered rows.
+    Returns the number of rows that passed; sel[i] != 0 for those rows.
+  */
+  uint evaluate(uint n_rows);
+
+  bool is_selected(uint n) const { return sel[n] != 0; }
+
+  uint kernel_count() const { return (uint) kernels.elements(); }
+
+private:
+  Batch_filter(TABLE *table_arg, uint max_rows_arg)
+    : table(table_arg), rec_length(table_arg->s->reclength),
+      max_rows(max_rows_arg), rows(NULL), sel(NULL), values(NULL),
+      nulls(NULL), kernels(PSI_INSTRUMENT_MEM)
+  {}
+
+  bool add_conjunct(THD *thd, Item *cond);
+  bool alloc_buffers();
+  void extract_column(const Field *field, uint n_rows);
+
+  TABLE *table;
+  size_t rec_length;
+  uint max_rows;
+
+  uchar *rows;       /* max_rows copies of table->record[0] */
+  uchar *sel;        /* selection vector, one byte per row */
+  longlong *values;  /* column values extracted for the current kernel */
+  uchar *nulls;      /* NULL flags extracted for the current kernel */
+
+  Dynamic_array<Batch_filter_kernel*> kernels;
+};
+
+#endif /* SQL_BATCH_FILTER_INCLUDED */
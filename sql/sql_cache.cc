@@ -1075,6 +1075,13 @@ Query_cache::insert(THD *thd, Query_cache_tls *query_cache_tls,
   if (is_disabled() || query_cache_tls->first_query_block == NULL)
     DBUG_VOID_RETURN;
 
+  if (shards)
+  {
+    query_cache_tls->query_cache->insert(thd, query_cache_tls, packet, length,
+                                         pkt_nr);
+    DBUG_VOID_RETURN;
+  }
+
   QC_DEBUG_SYNC("wait_in_query_cache_insert");
 
   /*
@@ -1113,8 +1120,8 @@ Query_cache::insert(THD *thd, Query_cache_tls *query_cache_tls,
     header->result(result);
     DBUG_PRINT("qcache", ("free query %p", query_block));
     // The following call will remove the lock on query_block
-    query_cache.free_query(query_block);
-    query_cache.refused++;
+    free_query(query_block);
+    refused++;
     // append_result_data no success => we need unlock
     unlock();
     DBUG_VOID_RETURN;
@@ -1138,6 +1145,12 @@ Query_cache::abort(THD *thd, Query_cache_tls *query_cache_tls)
   if (is_disabled() || query_cache_tls->first_query_block == NULL)
     DBUG_VOID_RETURN;
 
+  if (shards)
+  {
+    query_cache_tls->query_cache->abort(thd, query_cache_tls);
+    DBUG_VOID_RETURN;
+  }
+
   if (try_lock(thd, Query_cache::WAIT))
     DBUG_VOID_RETURN;
 
@@ -1174,6 +1187,12 @@ void Query_cache::end_of_result(THD *thd)
   if (query_cache_tls->first_query_block == NULL)
     DBUG_VOID_RETURN;
 
+  if (shards)
+  {
+    query_cache_tls->query_cache->end_of_result(thd);
+    DBUG_VOID_RETURN;
+  }
+
   /* Ensure that only complete results are cached. */
   DBUG_ASSERT(thd->get_stmt_da()->is_eof());
 
@@ -1227,9 +1246,9 @@ void Query_cache::end_of_result(THD *thd)
     }
     last_result_block= header->result()->prev;
     align_size= ALIGN_SIZE(last_result_block->used);
-    len= MY_MAX(query_cache.min_allocation_unit, align_size);
-    if (last_result_block->length >= query_cache.min_allocation_unit + len)
-      query_cache.split_block(last_result_block,len);
+    len= MY_MAX(min_allocation_unit, align_size);
+    if (last_result_block->length >= min_allocation_unit + len)
+      split_block(last_result_block,len);
 
     header->found_rows(limit_found_rows);
     header->set_results_ready(); // signal for plugin
@@ -1277,13 +1296,13 @@ Query_cache::Query_cache(size_t query_cache_limit_arg,
   :query_cache_size(0),
    query_cache_limit(query_cache_limit_arg),
    queries_in_cache(0), hits(0), inserts(0), refused(0),
-   total_blocks(0), lowmem_prunes(0),
+   total_blocks(0), lowmem_prunes(0), misses(0),
    m_cache_status(OK),
    min_allocation_unit(ALIGN_SIZE(min_allocation_unit_arg)),
    min_result_data_size(ALIGN_SIZE(min_result_data_size_arg)),
    def_query_hash_size(ALIGN_SIZE(def_query_hash_size_arg)),
    def_table_hash_size(ALIGN_SIZE(def_table_hash_size_arg)),
-   initialized(0)
+   initialized(0), shards(NULL), n_shards(0), shard_status_vars(NULL)
 {
   size_t min_needed= (ALIGN_SIZE(sizeof(Query_cache_block)) +
 		     ALIGN_SIZE(sizeof(Query_cache_block_table)) +
@@ -1302,6 +1321,22 @@ size_t Query_cache::resize(size_t query_cache_size_arg)
 			query_cache_size_arg));
   DBUG_ASSERT(initialized);
 
+  if (shards)
+  {
+    new_query_cache_size= 0;
+    for (uint i= 0; i < n_shards; i++)
+      new_query_cache_size+= shards[i].resize(query_cache_size_arg / n_shards);
+
+    lock_and_suspend();
+    query_cache_size= new_query_cache_size;
+    if (new_query_cache_size && global_system_variables.query_cache_type != 0)
+      m_cache_status= OK;
+    else
+      m_cache_status= DISABLED;
+    unlock();
+    DBUG_RETURN(new_query_cache_size);
+  }
+
   lock_and_suspend();
 
   /*
@@ -1352,11 +1387,21 @@ size_t Query_cache::resize(size_t query_cache_size_arg)
 }
 
 
+void Query_cache::result_size_limit(size_t limit)
+{
+  query_cache_limit= limit;
+  for (uint i= 0; i < n_shards; i++)
+    shards[i].result_size_limit(limit);
+}
+
+
 size_t Query_cache::set_min_res_unit(size_t size)
 {
   DBUG_ASSERT(size % 8 == 0);
   if (size < min_allocation_unit)
     size= ALIGN_SIZE(min_allocation_unit);
+  for (uint i= 0; i < n_shards; i++)
+    shards[i].set_min_res_unit(size);
   return (min_result_data_size= size);
 }
 
@@ -1382,6 +1427,11 @@ void Query_cache::store_query(THD *thd, TABLE_LIST *tables_used)
     DBUG_PRINT("qcache", ("Query cache not ready"));
     DBUG_VOID_RETURN;
   }
+  if (shards)
+  {
+    get_shard(&thd->base_query)->store_query(thd, tables_used);
+    DBUG_VOID_RETURN;
+  }
   if (thd->lex->sql_command != SQLCOM_SELECT)
   {
     DBUG_PRINT("qcache", ("Ignoring not SELECT command"));
@@ -1568,6 +1618,7 @@ def_week_frmt: %zu, in_trans: %d, autocommit: %d",
 	inserts++;
 	queries_in_cache++;
 	thd->query_cache_tls.first_query_block= query_block;
+	thd->query_cache_tls.query_cache= this;
 	header->writer(&thd->query_cache_tls);
 	header->tables_type(tables_type);
 
@@ -1710,15 +1761,6 @@ size_t build_normalized_name(char *buff, size_t bufflen,
 int
 Query_cache::send_result_to_client(THD *thd, char *org_sql, uint query_length)
 {
-  ulonglong engine_data;
-  Query_cache_query *query;
-#ifndef EMBEDDED_LIBRARY
-  Query_cache_block *first_result_block;
-#endif
-  Query_cache_block *result_block;
-  Query_cache_block_table *block_table, *block_table_end;
-  size_t tot_length;
-  Query_cache_query_flags flags;
   const char *sql, *sql_end, *found_brace= 0;
   DBUG_ENTER("Query_cache::send_result_to_client");
 
@@ -1875,23 +1917,7 @@ Query_cache::send_result_to_client(THD *thd, char *org_sql, uint query_length)
       goto err;
     }
   }
-  /*
-    Try to obtain an exclusive lock on the query cache. If the cache is
-    disabled or if a full cache flush is in progress, the attempt to
-    get the lock is aborted.
-
-    The TIMEOUT parameter indicate that the lock is allowed to timeout.
-  */
-  if (try_lock(thd, Query_cache::TIMEOUT))
-    goto err;
-
-  if (query_cache_size == 0)
-  {
-    thd->query_cache_is_applicable= 0;            // Query can't be cached
-    goto err_unlock;
-  }
 
-  Query_cache_block *query_block;
   if (thd->variables.query_cache_strip_comments)
   {
     if (found_brace)
@@ -1908,6 +1934,58 @@ Query_cache::send_result_to_client(THD *thd, char *org_sql, uint query_length)
     thd->base_query.set(sql, query_length, system_charset_info);
   }
 
+  /* The query is looked up only in the shard it would be stored in */
+  DBUG_RETURN((shards ? get_shard(&thd->base_query) : this)->
+              send_cached_result(thd, sql, query_length));
+
+err:
+  thd->query_cache_is_applicable= 0;            // Query can't be cached
+  DBUG_RETURN(0);				// Query was not cached
+}
+
+
+/**
+  Look up a query in the cache and send its result to the client
+
+  @param thd           Thread handler
+  @param sql           The base query, with space for the database name
+                       and the flags after it
+  @param query_length  Length of the base query
+
+  @return as send_result_to_client()
+*/
+
+int
+Query_cache::send_cached_result(THD *thd, const char *sql, uint query_length)
+{
+  ulonglong engine_data;
+  Query_cache_query *query;
+#ifndef EMBEDDED_LIBRARY
+  Query_cache_block *first_result_block;
+#endif
+  Query_cache_block *result_block;
+  Query_cache_block_table *block_table, *block_table_end;
+  size_t tot_length;
+  Query_cache_query_flags flags;
+  DBUG_ENTER("Query_cache::send_cached_result");
+
+  /*
+    Try to obtain an exclusive lock on the query cache. If the cache is
+    disabled or if a full cache flush is in progress, the attempt to
+    get the lock is aborted.
+
+    The TIMEOUT parameter indicate that the lock is allowed to timeout.
+  */
+  if (try_lock(thd, Query_cache::TIMEOUT))
+    goto err;
+
+  if (query_cache_size == 0)
+  {
+    thd->query_cache_is_applicable= 0;            // Query can't be cached
+    goto err_unlock;
+  }
+
+  Query_cache_block *query_block;
   tot_length= (query_length + 1 + QUERY_CACHE_DB_LENGTH_SIZE +
                thd->db.length + QUERY_CACHE_FLAGS_SIZE);
 
@@ -2212,6 +2290,7 @@ def_week_frmt: %zu, in_trans: %d, autocommit: %d",
   DBUG_RETURN(1);				// Result sent to client
 
 err_unlock:
+  misses++;
   unlock();
   MYSQL_QUERY_CACHE_MISS(thd->query());
   /*
@@ -2359,6 +2438,13 @@ void Query_cache::invalidate(THD *thd, const LEX_CSTRING &db)
 
   DBUG_SLOW_ASSERT(Lex_ident_fs(db).ok_for_lower_case_names());
 
+  if (shards)
+  {
+    for (uint i= 0; i < n_shards; i++)
+      shards[i].invalidate(thd, db);
+    DBUG_VOID_RETURN;
+  }
+
   bool restart= FALSE;
   /*
     Lock the query cache and queue all invalidation attempts to avoid
@@ -2450,6 +2536,13 @@ void Query_cache::flush()
 
   QC_DEBUG_SYNC("wait_in_query_cache_flush1");
 
+  if (shards)
+  {
+    for (uint i= 0; i < n_shards; i++)
+      shards[i].flush();
+    DBUG_VOID_RETURN;
+  }
+
   lock_and_suspend();
   if (query_cache_size > 0)
   {
@@ -2458,7 +2551,7 @@ void Query_cache::flush()
     DUMP(this);
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
   unlock();
   DBUG_VOID_RETURN;
 }
@@ -2481,6 +2574,13 @@ void Query_cache::pack(THD *thd, size_t join_limit, uint iteration_limit)
   if (is_disabled())
     DBUG_VOID_RETURN;
 
+  if (shards)
+  {
+    for (uint i= 0; i < n_shards; i++)
+      shards[i].pack(thd, join_limit, iteration_limit);
+    DBUG_VOID_RETURN;
+  }
+
   /*
     If the entire qc is being invalidated we can bail out early
     instead of waiting for the lock.
@@ -2508,6 +2608,16 @@ void Query_cache::pack(THD *thd, size_t join_limit, uint iteration_limit)
 void Query_cache::destroy()
 {
   DBUG_ENTER("Query_cache::destroy");
+  if (shards)
+  {
+    for (uint i= 0; i < n_shards; i++)
+      shards[i].destroy();
+    delete [] shards;
+    my_free(shard_status_vars);
+    shards= NULL;
+    n_shards= 0;
+    shard_status_vars= NULL;
+  }
   if (!initialized)
   {
     DBUG_PRINT("qcache", ("Query Cache not initialized"));
@@ -2530,6 +2640,8 @@ void Query_cache::destroy()
 
 void Query_cache::disable_query_cache(THD *thd)
 {
+  for (uint i= 0; i < n_shards; i++)
+    shards[i].disable_query_cache(thd);
   lock(thd);
   m_cache_status= DISABLE_REQUEST;
   unlock();
@@ -2585,10 +2697,116 @@ void Query_cache::init()
     free_cache();
     m_cache_status= DISABLED;
   }
+  if (this == &query_cache && query_cache_shards > 1 && init_shards())
+    sql_print_warning("Could not allocate %lu query cache shards; "
+                      "the query cache is not sharded", query_cache_shards);
   DBUG_VOID_RETURN;
 }
 
 
+/**
+  Create the shards of the query cache
+
+  @details
+    Every shard is a complete query cache with its own lock, hash tables
+    and memory. The shards inherit the limits of the front object, which
+    only dispatches the requests and sums the statistics of the shards.
+
+  @return FALSE on success, TRUE on out of memory
+*/
+
+bool Query_cache::init_shards()
+{
+  static const char *const counter_names[]=
+  { "hits", "misses", "inserts", "lowmem_prunes", "queries_in_cache",
+    "free_memory" };
+  static const uint n_counters= array_elements(counter_names);
+  size_t Query_cache::*const counters[]=
+  { &Query_cache::hits, &Query_cache::misses, &Query_cache::inserts,
+    &Query_cache::lowmem_prunes, &Query_cache::queries_in_cache,
+    &Query_cache::free_memory };
+  uint n= (uint) query_cache_shards;
+  char *names;
+  DBUG_ENTER("Query_cache::init_shards");
+
+  if (!(shard_status_vars= (SHOW_VAR*)
+        my_malloc(key_memory_Query_cache,
+                  (n * n_counters + 1) * sizeof(SHOW_VAR) +
+                  n * n_counters * QUERY_CACHE_SHARD_VAR_NAME_LENGTH,
+                  MYF(MY_WME | MY_ZEROFILL))))
+    DBUG_RETURN(TRUE);
+  if (!(shards= new (std::nothrow) Query_cache[n]))
+  {
+    my_free(shard_status_vars);
+    shard_status_vars= NULL;
+    DBUG_RETURN(TRUE);
+  }
+  n_shards= n;
+  names= (char*) (shard_status_vars + n * n_counters + 1);
+
+  for (uint i= 0; i < n_shards; i++)
+  {
+    Query_cache *shard= shards + i;
+    shard->query_cache_limit= query_cache_limit;
+    shard->min_result_data_size= min_result_data_size;
+    shard->init();
+
+    for (uint j= 0; j < n_counters; j++)
+    {
+      SHOW_VAR *var= shard_status_vars + i * n_counters + j;
+      my_snprintf(names, QUERY_CACHE_SHARD_VAR_NAME_LENGTH, "%u_%s",
+                  i, counter_names[j]);
+      var->name= names;
+      var->value= (char*) &(shard->*counters[j]);
+      var->type= SHOW_LONG;
+      names+= QUERY_CACHE_SHARD_VAR_NAME_LENGTH;
+    }
+  }
+  DBUG_RETURN(FALSE);
+}
+
+
+/**
+  Find the shard of a query
+
+  @param query  The query text, as used in the key of the query
+*/
+
+Query_cache *Query_cache::get_shard(const String *query)
+{
+  DBUG_ASSERT(shards);
+  return shards + my_checksum(0, query->ptr(), query->length()) % n_shards;
+}
+
+
+/**
+  Sum a counter of the query cache over all shards
+*/
+
+size_t Query_cache::total(size_t Query_cache::*counter)
+{
+  size_t sum;
+  if (!shards)
+    return this->*counter;
+  sum= 0;
+  for (uint i= 0; i < n_shards; i++)
+    sum+= shards[i].*counter;
+  return sum;
+}
+
+
+/**
+  Reset the statistics counters of FLUSH STATUS
+*/
+
+void Query_cache::reset_statistics()
+{
+  for (uint i= 0; i < n_shards; i++)
+    shards[i].reset_statistics();
+  hits= inserts= refused= lowmem_prunes= misses= 0;
+}
+
+
 size_t Query_cache::init_cache()
 {
   size_t mem_bin_count, num, step;
@@ -3303,6 +3521,14 @@ void Query_cache::invalidate_table(THD *thd, TABLE *table)
 
 void Query_cache::invalidate_table(THD *thd, uchar * key, size_t key_length)
 {
+  /* A table may be used by the queries of any shard */
+  if (shards)
+  {
+    for (uint i= 0; i < n_shards; i++)
+      shards[i].invalidate_table(thd, key, key_length);
+    return;
+  }
+
   DEBUG_SYNC(thd, "wait_in_query_cache_invalidate1");
 
   /*
@@ -4249,7 +4475,7 @@ void Query_cache::pack_cache()
 {
   DBUG_ENTER("Query_cache::pack_cache");
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
 
   uchar *border = 0;
   Query_cache_block *before = 0;
@@ -4281,7 +4507,7 @@ void Query_cache::pack_cache()
     DUMP(this);
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
   DBUG_VOID_RETURN;
 }
 
@@ -4871,6 +5097,13 @@ my_bool Query_cache::check_integrity(bool locked)
   uint i;
   DBUG_ENTER("check_integrity");
 
+  if (shards)
+  {
+    for (i= 0; i < n_shards; i++)
+      result|= shards[i].check_integrity(locked);
+    DBUG_RETURN(result);
+  }
+
   if (!locked)
     lock_and_suspend();
 
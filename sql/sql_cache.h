@@ -20,6 +20,7 @@
 #include "my_base.h"                            /* ha_rows */
 
 class MY_LOCALE;
+class String;
 struct TABLE_LIST;
 class Time_zone;
 struct LEX;
@@ -66,6 +67,10 @@ typedef struct st_changed_table_list CHANGED_TABLE_LIST;
 #define QUERY_CACHE_PACK_ITERATION		2
 #define QUERY_CACHE_PACK_LIMIT			(512*1024L)
 
+/* maximal number of shards and length of their status variable names */
+#define QUERY_CACHE_MAX_SHARDS			64
+#define QUERY_CACHE_SHARD_VAR_NAME_LENGTH	24
+
 #define TABLE_COUNTER_TYPE uint
 
 struct Query_cache_block;
@@ -77,6 +82,7 @@ class Query_cache;
 struct Query_cache_tls;
 struct LEX;
 class THD;
+struct st_mysql_show_var;
 
 typedef my_bool (*qc_engine_callback)(THD *thd, const char *table_key,
                                       uint key_length,
@@ -304,7 +310,7 @@ class Query_cache
   size_t query_cache_size, query_cache_limit;
   /* statistics */
   size_t free_memory, queries_in_cache, hits, inserts, refused,
-    free_memory_blocks, total_blocks, lowmem_prunes;
+    free_memory_blocks, total_blocks, lowmem_prunes, misses;
 
 
 private:
@@ -354,6 +360,20 @@ class Query_cache
 
   bool initialized;
 
+  /*
+    With @@query_cache_shards > 1 the global query cache has no memory of
+    its own. It passes the requests to 'shards': independent caches, each
+    with its own memory, hashes and lock, that get an equal share of
+    @@query_cache_size. A query is stored in and looked up from the shard
+    chosen by the hash of its text. Tables are invalidated in all shards.
+  */
+  Query_cache *shards;
+  uint n_shards;
+  st_mysql_show_var *shard_status_vars;
+
+  bool init_shards();
+  Query_cache *get_shard(const String *query);
+
   /* Exclude/include from cyclic double linked list */
   static void double_linked_list_exclude(Query_cache_block *point,
 					 Query_cache_block **list_pointer);
@@ -445,6 +465,7 @@ class Query_cache
                                               uint8 *tables_type);
 
   static my_bool ask_handler_allowance(THD *thd, TABLE_LIST *tables_used);
+  int send_cached_result(THD *thd, const char *sql, uint query_length);
  public:
 
   Query_cache(size_t query_cache_limit = ULONG_MAX,
@@ -462,7 +483,7 @@ class Query_cache
   /* resize query cache (return real query size, 0 if disabled) */
   size_t resize(size_t query_cache_size);
   /* set limit on result size */
-  inline void result_size_limit(size_t limit){query_cache_limit=limit;}
+  void result_size_limit(size_t limit);
   /* set minimal result data allocation unit size */
   size_t set_min_res_unit(size_t size);
 
@@ -541,6 +562,16 @@ class Query_cache
   void unlock(void);
 
   void disable_query_cache(THD *thd);
+
+  /* Shards, see 'shards'. The cache itself is its only shard if not sharded */
+  uint shard_count() const { return shards ? n_shards : 1; }
+  Query_cache *shard(uint i) { return shards ? shards + i : this; }
+  /* Sum of a statistic over all shards */
+  size_t total(size_t Query_cache::*counter);
+  /* Reset the statistics that are reset by FLUSH STATUS */
+  void reset_statistics();
+  /* Status variables with the statistics of every shard */
+  st_mysql_show_var *shard_status() { return shard_status_vars; }
 };
 
 #ifdef HAVE_QUERY_CACHE
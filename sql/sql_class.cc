@@ -1928,6 +1928,8 @@ void add_to_status(STATUS_VAR *to_var, STATUS_VAR *from_var)
   to_var->table_open_cache_hits+= from_var->table_open_cache_hits;
   to_var->table_open_cache_misses+= from_var->table_open_cache_misses;
   to_var->table_open_cache_overflows+= from_var->table_open_cache_overflows;
+  to_var->table_open_cache_handoffs+= from_var->table_open_cache_handoffs;
+  to_var->table_open_cache_migrations+= from_var->table_open_cache_migrations;
 
   /*
     Update global_memory_used. We have to do this with atomic_add as the
@@ -1991,6 +1993,10 @@ void add_diff_to_status(STATUS_VAR *to_var, STATUS_VAR *from_var,
                                     dec_var->table_open_cache_misses;
   to_var->table_open_cache_overflows+= from_var->table_open_cache_overflows -
                                        dec_var->table_open_cache_overflows;
+  to_var->table_open_cache_handoffs+= from_var->table_open_cache_handoffs -
+                                      dec_var->table_open_cache_handoffs;
+  to_var->table_open_cache_migrations+= from_var->table_open_cache_migrations -
+                                        dec_var->table_open_cache_migrations;
 
   /*
     We don't need to accumulate memory_used as these are not reset or used by
@@ -566,6 +566,7 @@ class MY_LOCALE;
 */
 
 struct Query_cache_block;
+class Query_cache;
 
 struct Query_cache_tls
 {
@@ -574,12 +575,14 @@ struct Query_cache_tls
     functions and methods to maintain proper locking.
   */
   Query_cache_block *first_query_block;
+  /* The query cache shard that first_query_block belongs to */
+  Query_cache *query_cache;
   void set_first_query_block(Query_cache_block *first_query_block_arg)
   {
     first_query_block= first_query_block_arg;
   }
 
-  Query_cache_tls() :first_query_block(NULL) {}
+  Query_cache_tls() :first_query_block(NULL), query_cache(NULL) {}
 };
 
 /* SIGNAL / RESIGNAL / GET DIAGNOSTICS */
@@ -714,6 +717,7 @@ typedef struct system_variables
   ulonglong max_heap_table_size;
   ulonglong tmp_memory_table_size;
   ulonglong tmp_disk_table_size;
+  ulonglong subquery_cache_hash_size;
   ulonglong long_query_time;
   ulonglong max_statement_time;
   ulonglong optimizer_switch;
@@ -767,11 +771,17 @@ typedef struct system_variables
   ulong column_compression_zlib_strategy;
   ulong lock_wait_timeout;
   ulong join_cache_level;
+  ulong join_batch_filter_rows;
+  ulong join_cache_spill_partitions;
+  ulong scan_batch_rows;
   ulong max_allowed_packet;
   ulong max_error_count;
   ulong max_length_for_sort_data;
   ulong max_recursive_iterations;
   ulong max_sort_length;
+  ulong max_sort_threads;
+  ulong max_scan_threads;
+  ulong max_window_threads;
   ulong max_insert_delayed_threads;
   ulong min_examined_row_limit;
   ulong net_buffer_length;
@@ -782,6 +792,7 @@ typedef struct system_variables
   ulong net_write_timeout;
   ulong optimizer_extra_pruning_depth;
   ulonglong optimizer_join_limit_pref_ratio;
+  ulong optimizer_prepared_plan_reuse_ratio;
   ulong optimizer_prune_level;
   ulong optimizer_search_depth;
   ulong optimizer_selectivity_sampling_limit;
@@ -864,6 +875,8 @@ typedef struct system_variables
   my_bool old_mode;
   my_bool old_passwords;
   my_bool big_tables;
+  my_bool group_by_hash;
+  my_bool optimizer_prepared_plan_reuse;
   my_bool only_standard_compliant_cte;
   my_bool query_cache_strip_comments;
   my_bool sql_log_slow;
@@ -988,6 +1001,8 @@ typedef struct system_status_var
   ulong opened_tables;
   ulong opened_shares;
   ulong opened_views;               /* +1 opening a view */
+  ulong mdl_fast_path_locks;        /* Granted without MDL_lock::m_rwlock */
+  ulong mdl_slow_path_locks;
 
   ulong select_full_join_count_;
   ulong select_full_range_join_count_;
@@ -1003,7 +1018,11 @@ typedef struct system_status_var
   ulong filesort_rows_;
   ulong filesort_scan_count_;
   ulong filesort_pq_sorts_;
+  ulong filesort_radix_sorts_;
   ulong optimizer_join_prefixes_check_calls;
+  ulong optimizer_join_order_cache_hits;
+  ulong optimizer_join_order_cache_misses;
+  ulong optimizer_join_order_time;          /* Time in microseconds */
 
   /* Features used */
   ulong feature_custom_aggregate_functions; /* +1 when custom aggregate
@@ -1060,6 +1079,8 @@ typedef struct system_status_var
   ulonglong table_open_cache_hits;
   ulonglong table_open_cache_misses;
   ulonglong table_open_cache_overflows;
+  ulonglong table_open_cache_handoffs;
+  ulonglong table_open_cache_migrations;
   ulonglong send_metadata_skips;
   double last_query_cost;
   double cpu_time, busy_time;
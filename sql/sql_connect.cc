@@ -1265,7 +1265,17 @@ void prepare_new_connection_state(THD* thd)
   Security_context *sctx= thd->security_ctx;
 
   if (thd->client_capabilities & CLIENT_COMPRESS)
+  {
     thd->net.compress=1;				// Use compression
+    if ((thd->client_capabilities & MARIADB_CLIENT_ZSTD_COMPRESSION) &&
+        !net_zstd_active(&thd->net) &&
+        net_zstd_init(&thd->net, (int) protocol_compression_level))
+    {
+      /* The client expects zstd, so the connection can't be used */
+      thd->set_killed(KILL_CONNECTION);
+      return;
+    }
+  }
 
   /*
     Much of this is duplicated in create_embedded_thd() for the
@@ -1062,6 +1062,7 @@ int Explain_select::print_explain(Explain_query *query,
   {
     bool using_tmp= false;
     bool using_fs= false;
+    bool using_hash_group= false;
 
     for (Explain_aggr_node *node= aggr_tree; node; node= node->child)
     {
@@ -1069,6 +1070,8 @@ int Explain_select::print_explain(Explain_query *query,
       {
         case AGGR_OP_TEMP_TABLE:
           using_tmp= true;
+          if (((Explain_aggr_tmp_table*)node)->hash_group)
+            using_hash_group= true;
           break;
         case AGGR_OP_FILESORT:
           using_fs= true;
@@ -1081,7 +1084,8 @@ int Explain_select::print_explain(Explain_query *query,
     for (uint i=0; i< n_join_tabs; i++)
     {
       join_tabs[i]->print_explain(output, explain_flags, is_analyze, select_id,
-                                  select_type, using_tmp, using_fs);
+                                  select_type, using_tmp, using_fs,
+                                  using_hash_group);
       if (i == 0)
       {
         /* 
@@ -1090,6 +1094,7 @@ int Explain_select::print_explain(Explain_query *query,
         */
         using_tmp= false;
         using_fs= false;
+        using_hash_group= false;
       }
     }
     for (uint i=0; i< n_join_tabs; i++)
@@ -1229,8 +1234,12 @@ void Explain_select::print_explain_json(Explain_query *query,
       switch (node->get_type())
       {
         case AGGR_OP_TEMP_TABLE:
+        {
           writer->add_member("temporary_table").start_object();
+          auto aggr_node= (Explain_aggr_tmp_table*)node;
+          aggr_node->print_json_members(writer, is_analyze);
           break;
+        }
         case AGGR_OP_FILESORT:
         {
           writer->add_member("filesort").start_object();
@@ -1318,6 +1327,20 @@ void Explain_aggr_filesort::print_json_members(Json_writer *writer,
 }
 
 
+void Explain_aggr_tmp_table::print_json_members(Json_writer *writer,
+                                                bool is_analyze)
+{
+  if (!hash_group)
+    return;
+  writer->add_member("hash_group").add_bool(true);
+  if (is_analyze)
+  {
+    writer->add_member("r_hash_groups").add_ull(hash_tracker.r_groups);
+    writer->add_member("r_hash_spills").add_ull(hash_tracker.r_spills);
+  }
+}
+
+
 void Explain_aggr_window_funcs::print_json_members(Json_writer *writer, 
                                                    bool is_analyze)
 {
@@ -1518,7 +1541,8 @@ bool Explain_index_use::set_pseudo_key(MEM_ROOT *root, const char* key_name_arg)
 
 double Explain_table_access::get_r_filtered()
 {
-  double r_filtered= tracker.get_filtered_after_where();
+  double r_filtered= tracker.get_filtered_after_where() *
+                     tracker.get_filtered_by_batch();
   if (bka_type.is_using_jbuf())
     r_filtered *= jbuf_tracker.get_filtered_after_where();
   return r_filtered;
@@ -1530,7 +1554,8 @@ int Explain_table_access::print_explain(select_result_sink *output,
                                         bool is_analyze,
                                         uint select_id, const char *select_type,
                                         bool using_temporary,
-                                        bool using_filesort)
+                                        bool using_filesort,
+                                        bool using_hash_group)
 {
   THD *thd= output->thd; // note: for SHOW EXPLAIN, this is target thd.
   MEM_ROOT *mem_root= thd->mem_root;
@@ -1690,9 +1715,7 @@ int Explain_table_access::print_explain(select_result_sink *output,
     }
     else
     {
-      double r_filtered= tracker.get_filtered_after_where();
-      if (bka_type.is_using_jbuf())
-        r_filtered *= jbuf_tracker.get_filtered_after_where();
+      double r_filtered= get_r_filtered();
       item_list.push_back(new (mem_root)
                           Item_float(thd, r_filtered * 100.0, 2),
                           mem_root);
@@ -1720,6 +1743,9 @@ int Explain_table_access::print_explain(select_result_sink *output,
     extra_buf.append(STRING_WITH_LEN("Using temporary"));
   }
 
+  if (using_hash_group)
+    extra_buf.append(STRING_WITH_LEN("; Using hash group"));
+
   if (using_filesort || this->pre_join_sort)
   {
     if (first)
@@ -2258,6 +2284,17 @@ void Explain_table_access::print_explain_json(Explain_query *query,
       writer->add_double(r_filtered);
     else
       writer->add_null();
+
+    /*
+      `r_batch_filtered` - part of the rows that passed the batch kernels
+      checked before attached_condition (see sql_batch_filter.h).
+      `r_filtered` above only covers the rows that passed them.
+    */
+    if (tracker.has_batch_filter())
+    {
+      writer->add_member("r_batch_filtered").
+        add_double(tracker.get_filtered_by_batch() * 100.0);
+    }
   }
 
   for (int i=0; i < (int)extra_tags.elements(); i++)
@@ -2278,6 +2315,27 @@ void Explain_table_access::print_explain_json(Explain_query *query,
                                               "incremental":"flat");
     writer->add_member("buffer_size").add_size(bka_type.join_buffer_size);
     writer->add_member("join_type").add_str(bka_type.join_alg);
+    if (bka_type.spill_partitions)
+      writer->add_member("partitions").add_ll(bka_type.spill_partitions);
+    if (bka_type.bloom_filter_size)
+    {
+      writer->add_member("bloom_filter").start_object();
+      writer->add_member("size").add_size(bka_type.bloom_filter_size);
+      writer->add_member("hashes").add_ll(bka_type.bloom_filter_hashes);
+      if (is_analyze)
+      {
+        writer->add_member("r_rows_checked").
+          add_ull(jbuf_bloom_tracker.r_rows_checked);
+        writer->add_member("r_rows_eliminated").
+          add_ull(jbuf_bloom_tracker.r_rows_eliminated);
+        writer->add_member("r_false_positive_rate");
+        if (jbuf_bloom_tracker.has_checks())
+          writer->add_double(jbuf_bloom_tracker.get_false_positive_rate());
+        else
+          writer->add_null();
+      }
+      writer->end_object(); // "bloom_filter"
+    }
     if (bka_type.mrr_type.length())
       writer->add_member("mrr_type").add_str(bka_type.mrr_type);
     if (where_cond)
@@ -2323,6 +2381,15 @@ void Explain_table_access::print_explain_json(Explain_query *query,
       else
         writer->add_null();
 
+      if (jbuf_spill_tracker.has_spills())
+      {
+        writer->add_member("r_partitions").
+          add_ull(jbuf_spill_tracker.r_partitions);
+        writer->add_member("r_spilled_bytes").
+          add_ull(jbuf_spill_tracker.r_spilled_bytes);
+        writer->add_member("r_spill_depth").
+          add_ll(jbuf_spill_tracker.r_max_depth);
+      }
     }
   }
 
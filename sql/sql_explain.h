@@ -320,7 +320,14 @@ class Explain_aggr_filesort : public Explain_aggr_node
 class Explain_aggr_tmp_table : public Explain_aggr_node
 {
 public:
+  Explain_aggr_tmp_table() : hash_group(false) {}
   enum_explain_aggr_node_type get_type() override { return AGGR_OP_TEMP_TABLE; }
+
+  /* The groups are collected in a Group_hash before the tmp table */
+  bool hash_group;
+  Group_hash_tracker hash_tracker;
+
+  void print_json_members(Json_writer *writer, bool is_analyze);
 };
 
 class Explain_aggr_remove_dups : public Explain_aggr_node
@@ -613,7 +620,8 @@ enum explain_extra_tag
 class EXPLAIN_BKA_TYPE
 {
 public:
-  EXPLAIN_BKA_TYPE() : join_alg(NULL), is_bka(false) {}
+  EXPLAIN_BKA_TYPE() : join_alg(NULL), is_bka(false), spill_partitions(0),
+    bloom_filter_size(0), bloom_filter_hashes(0) {}
 
   size_t join_buffer_size;
 
@@ -630,6 +638,16 @@ class EXPLAIN_BKA_TYPE
 
   /* Information about MRR usage.  */
   StringBuffer<64> mrr_type;
+
+  /* >0 <=> BNLH spills into this number of partitions when it overflows */
+  uint spill_partitions;
+
+  /*
+    >0 <=> rows of the joined table are checked against a Bloom filter over
+    the join keys of the buffered records. The size is in bytes.
+  */
+  size_t bloom_filter_size;
+  uint bloom_filter_hashes;
   
   bool is_using_jbuf() { return (join_alg != NULL); }
 };
@@ -925,12 +943,19 @@ class Explain_table_access : public Sql_alloc
   /* When using join buffer: Track the number of incoming record combinations */
   Counter_tracker jbuf_loops_tracker;
 
+  /* When using a spilling hashed join buffer: Track the partition files */
+  Join_spill_tracker jbuf_spill_tracker;
+
+  /* When using a Bloom filter over the join buffer: Track the checked rows */
+  Join_bloom_tracker jbuf_bloom_tracker;
+
   Explain_rowid_filter *rowid_filter;
 
   int print_explain(select_result_sink *output, uint8 explain_flags, 
                     bool is_analyze,
                     uint select_id, const char *select_type,
-                    bool using_temporary, bool using_filesort);
+                    bool using_temporary, bool using_filesort,
+                    bool using_hash_group= false);
   void print_explain_json(Explain_query *query, Json_writer *writer,
                           bool is_analyze);
 
@@ -33,6 +33,17 @@
   impact in the case when the cache is not applicable)
 */
 #define EXPCACHE_CHECK_HIT_RATIO_AFTER 200
+/**
+  Number of executions of a statement that do not create the cache of a
+  subquery after a poor hit rate, before the cache is tried again
+*/
+#define EXPCACHE_RETRY_AFTER_EXECUTIONS 16
+/** Longest string parameter kept in Expression_cache_hash */
+#define EXPCACHE_HASH_MAX_KEY_LENGTH 256
+/** Initial and minimal number of entries of Expression_cache_hash */
+#define EXPCACHE_HASH_MIN_ENTRIES 16
+/** No entry, the end of the LRU list of Expression_cache_hash */
+#define EXPCACHE_HASH_NO_ENTRY UINT_MAX32
 
 /*
   Expression cache is used only for caching subqueries now, so its statistic
@@ -40,11 +51,57 @@
 */
 ulong subquery_cache_miss, subquery_cache_hit;
 
+
+/**
+  Decide whether an execution of a statement creates the expression cache
+  of a subquery
+
+  @details
+  The cache is not created when the earlier executions found that its hit
+  rate is too low for the cache to pay off. Every
+  EXPCACHE_RETRY_AFTER_EXECUTIONS executions the statistics are forgotten
+  and the cache is tried again, as the data may have changed.
+
+  @retval TRUE  create the cache
+*/
+
+bool Expression_cache_stats::use_cache()
+{
+  if (miss < EXPCACHE_CHECK_HIT_RATIO_AFTER ||
+      ((double) hit / ((double) hit + miss)) >=
+      EXPCACHE_MIN_HIT_RATE_FOR_MEM_TABLE)
+    return TRUE;
+  if (++skipped < EXPCACHE_RETRY_AFTER_EXECUTIONS)
+    return FALSE;
+  hit= miss= 0;
+  skipped= 0;
+  return TRUE;
+}
+
+
+bool Expression_cache_stats::is_proven() const
+{
+  return (miss >= EXPCACHE_CHECK_HIT_RATIO_AFTER &&
+          ((double) hit / ((double) hit + miss)) >=
+          EXPCACHE_MIN_HIT_RATE_FOR_MEM_TABLE);
+}
+
+
+void Expression_cache::set_tracker(Expression_cache_tracker *st)
+{
+  tracker= st;
+  if (tracker)
+    tracker->attach_to_cache(this);
+  update_tracker();
+}
+
+
 Expression_cache_tmptable::Expression_cache_tmptable(THD *thd,
                                                      List<Item> &dependants,
-                                                     Item *value)
-  :cache_table(NULL), table_thd(thd), tracker(NULL), items(dependants), val(value),
-   hit(0), miss(0), inited (0)
+                                                     Item *value,
+                                                     Expression_cache_stats *stats_arg)
+  :cache_table(NULL), table_thd(thd), stats(stats_arg), items(dependants),
+   val(value), hit(0), miss(0), inited (0)
 {
   DBUG_ENTER("Expression_cache_tmptable::Expression_cache_tmptable");
   DBUG_VOID_RETURN;
@@ -184,6 +241,8 @@ Expression_cache_tmptable::~Expression_cache_tmptable()
   /* Add accumulated statistics */
   statistic_add(subquery_cache_miss, miss, &LOCK_status);
   statistic_add(subquery_cache_hit, hit, &LOCK_status);
+  if (stats)
+    stats->add(hit, miss);
 
   if (cache_table)
     disable_cache();
@@ -227,6 +286,7 @@ Expression_cache::result Expression_cache_tmptable::check_value(Item **value)
     if (res)
     {
       if (((++miss) == EXPCACHE_CHECK_HIT_RATIO_AFTER) &&
+          !(stats && stats->is_proven()) &&
           ((double)hit / ((double)hit + miss)) <
           EXPCACHE_MIN_HIT_RATE_FOR_MEM_TABLE)
       {
@@ -346,3 +406,416 @@ void Expression_cache_tmptable::print(String *str, enum_query_type query_type)
 
 const char *Expression_cache_tracker::state_str[3]=
 {"uninitialized", "disabled", "enabled"};
+
+
+/* The value of the expression found by Expression_cache_hash */
+
+class Item_cache_expr_value :public Item_cache_int
+{
+public:
+  Item_cache_expr_value(THD *thd, const Type_handler *handler)
+    :Item_cache_int(thd, handler) {}
+  void set_value(longlong nr, bool is_null)
+  {
+    value= nr;
+    null_value= null_value_inside= is_null;
+    value_cached= TRUE;
+  }
+};
+
+
+/* An entry of Expression_cache_hash, followed by the key */
+
+struct Expression_cache_hash::Entry
+{
+  /* Neighbours in the LRU list, the first one is the most recently used */
+  uint32 lru_prev, lru_next;
+  uint32 hash;
+  uint32 key_length;
+  longlong value;
+  bool value_is_null;
+  uchar key[1];
+};
+
+
+Expression_cache_hash::Expression_cache_hash(THD *thd_arg,
+                                             List<Item> &dependants,
+                                             Item *value,
+                                             Expression_cache_stats *stats_arg)
+  :thd(thd_arg), stats(stats_arg), param(dependants.head()), val(value),
+   cached_result(NULL), key_cs(NULL), key(NULL), key_length(0), key_hash(0),
+   key_valid(FALSE), entries(NULL), entry_size(0), max_key_length(0),
+   entries_max(0), entries_used(0), entries_limit(0), index(NULL),
+   index_mask(0), lru_first(EXPCACHE_HASH_NO_ENTRY),
+   lru_last(EXPCACHE_HASH_NO_ENTRY), hit(0), miss(0), inited(0)
+{}
+
+
+/**
+  Create a hash expression cache if it can be used for an expression
+
+  @param thd         Thread handle
+  @param dependants  The parameters of the expression
+  @param value       The Item_cache of the value of the expression
+  @param stats       Statistics of the subquery, or NULL
+
+  @return The cache, or NULL if the expression needs the more general
+          Expression_cache_tmptable
+*/
+
+Expression_cache_hash *
+Expression_cache_hash::create(THD *thd, List<Item> &dependants, Item *value,
+                              Expression_cache_stats *stats)
+{
+  Item *param;
+  if (!thd->variables.subquery_cache_hash_size ||
+      dependants.elements != 1 ||
+      value->cmp_type() != INT_RESULT ||
+      value->type_handler()->field_type() == MYSQL_TYPE_YEAR)
+    return NULL;
+  param= dependants.head();
+  if (param->cmp_type() != INT_RESULT && param->cmp_type() != STRING_RESULT)
+    return NULL;
+  return new Expression_cache_hash(thd, dependants, value, stats);
+}
+
+
+/**
+  Allocate the entries and the index of the hash expression cache
+*/
+
+void Expression_cache_hash::init()
+{
+  size_t limit;
+  DBUG_ENTER("Expression_cache_hash::init");
+  DBUG_ASSERT(!inited);
+  inited= TRUE;
+
+  if (param->cmp_type() == STRING_RESULT)
+  {
+    key_cs= param->collation.collation;
+    max_key_length= MY_MAX(MY_MIN(param->max_length,
+                                  EXPCACHE_HASH_MAX_KEY_LENGTH), 1);
+  }
+  else
+    max_key_length= sizeof(int_key);
+  entry_size= ALIGN_SIZE(offsetof(Entry, key) + max_key_length);
+
+  /* Every entry takes at most two cells of the index */
+  limit= (size_t) (thd->variables.subquery_cache_hash_size /
+                   (entry_size + 2 * sizeof(uint32)));
+  entries_limit= (uint32) MY_MIN(limit, UINT_MAX32 / 4);
+  if (entries_limit < EXPCACHE_HASH_MIN_ENTRIES)
+  {
+    DBUG_PRINT("info", ("subquery_cache_hash_size is too small"));
+    update_tracker();
+    DBUG_VOID_RETURN;
+  }
+
+  if (!(cached_result= new (thd->mem_root)
+        Item_cache_expr_value(thd, val->type_handler())) ||
+      cached_result->setup(thd, val) ||
+      grow())
+  {
+    DBUG_PRINT("error", ("out of memory, caching switched off"));
+    disable_cache();
+    DBUG_VOID_RETURN;
+  }
+  update_tracker();
+  DBUG_VOID_RETURN;
+}
+
+
+Expression_cache_hash::~Expression_cache_hash()
+{
+  /* Add accumulated statistics */
+  statistic_add(subquery_cache_miss, miss, &LOCK_status);
+  statistic_add(subquery_cache_hit, hit, &LOCK_status);
+  if (stats)
+    stats->add(hit, miss);
+
+  if (entries)
+    disable_cache();
+  else
+  {
+    update_tracker();
+    if (tracker)
+      tracker->detach_from_cache();
+    tracker= NULL;
+  }
+}
+
+
+void Expression_cache_hash::disable_cache()
+{
+  my_free(entries);
+  my_free(index);
+  entries= NULL;
+  index= NULL;
+  entries_max= entries_used= 0;
+  update_tracker();
+  if (tracker)
+    tracker->detach_from_cache();
+}
+
+
+/**
+  Double the number of entries of the cache, up to entries_limit
+
+  @retval FALSE OK
+  @retval TRUE  Out of memory, the cache is unchanged
+*/
+
+bool Expression_cache_hash::grow()
+{
+  uint32 new_max= (entries_max ? MY_MIN(entries_max * 2, entries_limit) :
+                   EXPCACHE_HASH_MIN_ENTRIES);
+  uint32 cells= my_round_up_to_next_power(new_max * 2);
+  uchar *new_entries;
+  uint32 *new_index;
+
+  if (!(new_entries= (uchar*) my_realloc(PSI_INSTRUMENT_ME, entries,
+                                         (size_t) new_max * entry_size,
+                                         MYF(MY_ALLOW_ZERO_PTR))))
+    return TRUE;
+  entries= new_entries;
+  if (!(new_index= (uint32*) my_malloc(PSI_INSTRUMENT_ME,
+                                       cells * sizeof(uint32),
+                                       MYF(MY_ZEROFILL))))
+    return TRUE;
+  my_free(index);
+  index= new_index;
+  index_mask= cells - 1;
+  entries_max= new_max;
+  for (uint32 nr= 0; nr < entries_used; nr++)
+    index_insert(nr);
+  return FALSE;
+}
+
+
+void Expression_cache_hash::index_insert(uint32 nr)
+{
+  uint32 cell= entry(nr)->hash & index_mask;
+  while (index[cell])
+    cell= (cell + 1) & index_mask;
+  index[cell]= nr + 1;
+}
+
+
+/**
+  Remove an entry from the index
+
+  @details
+  The entries that follow the removed one in its probe sequence are moved
+  back, so that no lookup stops at the freed cell too early.
+*/
+
+void Expression_cache_hash::index_delete(uint32 nr)
+{
+  uint32 cell= entry(nr)->hash & index_mask;
+  while (index[cell] != nr + 1)
+    cell= (cell + 1) & index_mask;
+
+  for (uint32 next= (cell + 1) & index_mask; index[next];
+       next= (next + 1) & index_mask)
+  {
+    uint32 home= entry(index[next] - 1)->hash & index_mask;
+    /* Move the entry unless its home is cyclically in (cell, next] */
+    if (cell <= next ? (home <= cell || home > next) :
+                       (home <= cell && home > next))
+    {
+      index[cell]= index[next];
+      cell= next;
+    }
+  }
+  index[cell]= 0;
+}
+
+
+void Expression_cache_hash::lru_unlink(uint32 nr)
+{
+  Entry *e= entry(nr);
+  if (e->lru_prev != EXPCACHE_HASH_NO_ENTRY)
+    entry(e->lru_prev)->lru_next= e->lru_next;
+  else
+    lru_first= e->lru_next;
+  if (e->lru_next != EXPCACHE_HASH_NO_ENTRY)
+    entry(e->lru_next)->lru_prev= e->lru_prev;
+  else
+    lru_last= e->lru_prev;
+}
+
+
+void Expression_cache_hash::lru_push(uint32 nr)
+{
+  Entry *e= entry(nr);
+  e->lru_prev= EXPCACHE_HASH_NO_ENTRY;
+  e->lru_next= lru_first;
+  if (lru_first != EXPCACHE_HASH_NO_ENTRY)
+    entry(lru_first)->lru_prev= nr;
+  else
+    lru_last= nr;
+  lru_first= nr;
+}
+
+
+/**
+  Compute the key of the current value of the parameter
+
+  @retval FALSE the value is NULL or too long to be cached
+*/
+
+bool Expression_cache_hash::make_key()
+{
+  if (key_cs)
+  {
+    ulong nr1= 1, nr2= 4;
+    String *str= param->val_str(&key_buff);
+    if (param->null_value || str->length() > max_key_length)
+      return FALSE;
+    /* The subquery may overwrite the buffer of the parameter */
+    if (str != &key_buff && key_buff.copy(*str))
+      return FALSE;
+    key= (const uchar*) key_buff.ptr();
+    key_length= key_buff.length();
+    key_cs->hash_sort(key, key_length, &nr1, &nr2);
+    key_hash= (uint32) nr1;
+  }
+  else
+  {
+    longlong nr= param->val_int();
+    if (param->null_value)
+      return FALSE;
+    int8store(int_key, nr);
+    key= int_key;
+    key_length= sizeof(int_key);
+    key_hash= (uint32) (((ulonglong) nr * 0x9E3779B97F4A7C15ULL) >> 32);
+  }
+  return TRUE;
+}
+
+
+/**
+  Find the entry of the current key
+
+  @return The number of the entry, EXPCACHE_HASH_NO_ENTRY if not found
+*/
+
+uint32 Expression_cache_hash::find(Entry **found)
+{
+  for (uint32 cell= key_hash & index_mask; index[cell];
+       cell= (cell + 1) & index_mask)
+  {
+    Entry *e= entry(index[cell] - 1);
+    if (e->hash == key_hash &&
+        (key_cs ?
+         !key_cs->strnncollsp(key, key_length, e->key, e->key_length) :
+         !memcmp(key, e->key, key_length)))
+    {
+      *found= e;
+      return index[cell] - 1;
+    }
+  }
+  return EXPCACHE_HASH_NO_ENTRY;
+}
+
+
+/**
+  Check if the current value of the parameter is in the cache
+
+  @param [out] value     the expression value found in the cache if any
+
+  @retval Expression_cache::HIT if the parameter is in the cache
+  @retval Expression_cache::MISS - otherwise
+*/
+
+Expression_cache::result Expression_cache_hash::check_value(Item **value)
+{
+  DBUG_ENTER("Expression_cache_hash::check_value");
+
+  if (entries)
+  {
+    key_valid= make_key();
+    if (unlikely(thd->is_error()))
+      DBUG_RETURN(ERROR);
+
+    if (key_valid)
+    {
+      Entry *e;
+      uint32 nr= find(&e);
+      if (nr != EXPCACHE_HASH_NO_ENTRY)
+      {
+        lru_unlink(nr);
+        lru_push(nr);
+        cached_result->set_value(e->value, e->value_is_null);
+        hit++;
+        *value= cached_result;
+        DBUG_RETURN(HIT);
+      }
+    }
+
+    if (((++miss) == EXPCACHE_CHECK_HIT_RATIO_AFTER) &&
+        !(stats && stats->is_proven()) &&
+        ((double)hit / ((double)hit + miss)) <
+        EXPCACHE_MIN_HIT_RATE_FOR_MEM_TABLE)
+    {
+      DBUG_PRINT("info",
+                 ("Early check: hit rate is not so good to keep the cache"));
+      disable_cache();
+    }
+  }
+  DBUG_RETURN(MISS);
+}
+
+
+/**
+  Put the value of the expression for the parameter of the last
+  check_value() into the cache
+
+  @details
+  When the cache is full, the least recently used entry is replaced.
+
+  @retval FALSE OK
+*/
+
+my_bool Expression_cache_hash::put_value(Item *value)
+{
+  uint32 nr;
+  Entry *e;
+  DBUG_ENTER("Expression_cache_hash::put_value");
+  DBUG_ASSERT(inited);
+
+  if (!entries || !key_valid)
+    DBUG_RETURN(FALSE);
+
+  /* If the cache cannot grow, the least recently used entry is reused */
+  if (entries_used == entries_max && entries_max < entries_limit)
+    (void) grow();
+  if (entries_used < entries_max)
+    nr= entries_used++;
+  else
+  {
+    nr= lru_last;
+    lru_unlink(nr);
+    index_delete(nr);
+  }
+
+  e= entry(nr);
+  e->hash= key_hash;
+  e->key_length= (uint32) key_length;
+  memcpy(e->key, key, key_length);
+  e->value= value->val_int();
+  e->value_is_null= value->null_value;
+  index_insert(nr);
+  lru_push(nr);
+  key_valid= FALSE;
+  DBUG_RETURN(FALSE);
+}
+
+
+void Expression_cache_hash::print(String *str, enum_query_type query_type)
+{
+  str->append('<');
+  param->print(str, query_type);
+  str->append('>');
+}
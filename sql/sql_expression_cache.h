@@ -31,12 +31,14 @@
 
 extern ulong subquery_cache_miss, subquery_cache_hit;
 
+class Expression_cache_tracker;
+
 class Expression_cache :public Sql_alloc
 {
 public:
   enum result {ERROR, HIT, MISS};
 
-  Expression_cache()= default;
+  Expression_cache() :tracker(NULL) {}
   virtual ~Expression_cache() = default;
   /**
     Shall check the presence of expression value in the cache for a given
@@ -68,11 +70,19 @@ class Expression_cache :public Sql_alloc
     Save this object's statistics into Expression_cache_tracker object
   */
   virtual void update_tracker()= 0;
+
+  void set_tracker(Expression_cache_tracker *st);
+  Expression_cache_tracker *get_tracker() { return tracker; }
+
+protected:
+  /* EXPALIN/ANALYZE statistics */
+  Expression_cache_tracker *tracker;
 };
 
 struct st_table_ref;
 struct st_join_table;
 class Item_field;
+class Item_cache_expr_value;
 
 
 class Expression_cache_tracker :public Sql_alloc
@@ -95,6 +105,7 @@ class Expression_cache_tracker :public Sql_alloc
   void set(ulong h, ulong m, enum expr_cache_state s)
   {hit= h; miss= m; state= s;}
 
+  void attach_to_cache(Expression_cache *c) { cache= c; }
   void detach_from_cache() { cache= NULL; }
   void fetch_current_stats()
   {
@@ -111,7 +122,8 @@ class Expression_cache_tracker :public Sql_alloc
 class Expression_cache_tmptable :public Expression_cache
 {
 public:
-  Expression_cache_tmptable(THD *thd, List<Item> &dependants, Item *value);
+  Expression_cache_tmptable(THD *thd, List<Item> &dependants, Item *value,
+                            Expression_cache_stats *stats_arg);
   virtual ~Expression_cache_tmptable();
   result check_value(Item **value) override;
   my_bool put_value(Item *value) override;
@@ -120,11 +132,6 @@ class Expression_cache_tmptable :public Expression_cache
   bool is_inited() override { return inited; };
   void init() override;
 
-  void set_tracker(Expression_cache_tracker *st)
-  {
-    tracker= st;
-    update_tracker();
-  }
   void update_tracker() override
   {
     if (tracker)
@@ -145,8 +152,8 @@ class Expression_cache_tmptable :public Expression_cache
   TABLE *cache_table;
   /* Thread handle for the temporary table */
   THD *table_thd;
-  /* EXPALIN/ANALYZE statistics */
-  Expression_cache_tracker *tracker;
+  /* Statistics kept over the executions of the statement, or NULL */
+  Expression_cache_stats *stats;
   /* TABLE_REF for index lookup */
   struct st_table_ref ref;
   /* Cached result */
@@ -161,4 +168,101 @@ class Expression_cache_tmptable :public Expression_cache
   bool inited;
 };
 
+
+/**
+  Implementation of expression cache over an in-memory hash table
+
+  @details
+  The cache is used instead of Expression_cache_tmptable when the
+  expression depends on one integer or string parameter and returns an
+  integer, which covers the IN and EXISTS subqueries and the correlated
+  scalar subqueries with an integer result. The entries have a fixed size
+  and are allocated at once from the memory given by
+  @@subquery_cache_hash_size. They are found through an open addressing
+  index with linear probing. When all entries are used, the least recently
+  used one is evicted, so a poor hit rate does not disable the cache only
+  because the memory is full.
+*/
+
+class Expression_cache_hash :public Expression_cache
+{
+public:
+  Expression_cache_hash(THD *thd, List<Item> &dependants, Item *value,
+                        Expression_cache_stats *stats_arg);
+  virtual ~Expression_cache_hash();
+  result check_value(Item **value) override;
+  my_bool put_value(Item *value) override;
+
+  void print(String *str, enum_query_type query_type) override;
+  bool is_inited() override { return inited; };
+  void init() override;
+  void update_tracker() override
+  {
+    if (tracker)
+    {
+      tracker->set(hit, miss, (inited ? (entries ?
+                                         Expression_cache_tracker::OK :
+                                         Expression_cache_tracker::STOPPED) :
+                               Expression_cache_tracker::UNINITED));
+    }
+  }
+
+  static Expression_cache_hash *create(THD *thd, List<Item> &dependants,
+                                       Item *value,
+                                       Expression_cache_stats *stats);
+
+private:
+  struct Entry;
+
+  Entry *entry(uint32 nr)
+  { return (Entry *) (entries + (size_t) nr * entry_size); }
+  bool make_key();
+  uint32 find(Entry **found);
+  bool grow();
+  void index_insert(uint32 nr);
+  void index_delete(uint32 nr);
+  void lru_unlink(uint32 nr);
+  void lru_push(uint32 nr);
+  void disable_cache();
+
+  THD *thd;
+  /* Statistics kept over the executions of the statement, or NULL */
+  Expression_cache_stats *stats;
+  /* The parameter of the expression */
+  Item *param;
+  /* Value Item example */
+  Item *val;
+  /* The value returned on a hit */
+  Item_cache_expr_value *cached_result;
+  /* Collation of string keys, NULL for integer keys */
+  CHARSET_INFO *key_cs;
+  /* Buffer for the value of string parameters */
+  StringBuffer<MAX_FIELD_WIDTH> key_buff;
+  /* Buffer for the value of integer parameters */
+  uchar int_key[8];
+  /* The key of the last lookup, see make_key() */
+  const uchar *key;
+  size_t key_length;
+  uint32 key_hash;
+  bool key_valid;
+
+  /*
+    entries_max entries of entry_size bytes. The array grows up to
+    entries_limit entries, the number that fits in @@subquery_cache_hash_size
+  */
+  uchar *entries;
+  size_t entry_size, max_key_length;
+  uint32 entries_max, entries_used, entries_limit;
+  /* Open addressing index: entry number + 1, 0 for an empty cell */
+  uint32 *index;
+  uint32 index_mask;
+  /* The most and the least recently used entries */
+  uint32 lru_first, lru_last;
+
+  /* hit/miss counters */
+  ulong hit, miss;
+  /* Set on if the object has been successfully initialized with init() */
+  bool inited;
+};
+
 #endif /* SQL_EXPRESSION_CACHE_INCLUDED */
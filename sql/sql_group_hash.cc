@@ -0,0 +1,193 @@
+/*
+   Copyright (c) 2024, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/**
+  @file
+
+  @brief
+    In-memory hash aggregation of the groups of GROUP BY
+
+  @see sql_group_hash.h
+*/
+
+#include "mariadb.h"
+#include "sql_priv.h"
+#include "sql_class.h"
+#include "key.h"
+#include "sql_group_hash.h"
+
+/* Number of buckets allocated for the first group */
+#define GROUP_HASH_MIN_BUCKETS 256
+
+
+Group_hash::Group_hash(TABLE *table, uint group_length, size_t limit)
+  :buckets(NULL), n_buckets(0), n_entries(0), first(NULL), last(NULL),
+   key_info(table->key_info),
+   key_parts(table->key_info->user_defined_key_parts),
+   key_length(group_length), rec_length(table->s->reclength),
+   mem_limit(limit), mem_used(0), tracker(NULL)
+{
+  entry_size= ALIGN_SIZE(sizeof(Entry) + key_length + rec_length);
+  init_sql_alloc(PSI_INSTRUMENT_ME, &mem_root,
+                 MY_MAX(entry_size * 64, 8192), 0, MYF(MY_THREAD_SPECIFIC));
+}
+
+
+/**
+  Check whether the groups of a temporary table can be collected in a
+  Group_hash
+
+  @details
+    The records of the groups are copied, so the values of all columns
+    must be stored in the record itself. Floating point key parts are
+    not supported: their key images are not compared bytewise by the
+    temporary table (e.g. -0.0 = 0.0), and key_hashnr() hashes the bytes.
+*/
+
+bool Group_hash::is_usable(TABLE *table)
+{
+  if (table->s->blob_fields || !table->s->keys ||
+      table->s->have_unique_constraint())
+    return false;
+  KEY *key= table->key_info;
+  for (uint i= 0; i < key->user_defined_key_parts; i++)
+  {
+    switch (key->key_part[i].type) {
+    case HA_KEYTYPE_FLOAT:
+    case HA_KEYTYPE_DOUBLE:
+      return false;
+    default:
+      break;
+    }
+  }
+  return true;
+}
+
+
+ulong Group_hash::hash_key(const uchar *key) const
+{
+  return key_hashnr(key_info, key_parts, key);
+}
+
+
+/**
+  Find the group with the given key
+
+  @return The record of the group, NULL if there is none
+*/
+
+uchar *Group_hash::find(const uchar *key, ulong hash) const
+{
+  if (!n_buckets)
+    return NULL;
+  for (Entry *entry= buckets[hash % n_buckets]; entry;
+       entry= entry->next_in_bucket)
+  {
+    if (entry->hash == hash &&
+        !key_buf_cmp(key_info, key_parts, entry_key(entry), key))
+      return entry_key(entry) + key_length;
+  }
+  return NULL;
+}
+
+
+/* Double the number of buckets and redistribute the entries */
+
+bool Group_hash::grow()
+{
+  ulong new_size= n_buckets ? n_buckets * 2 : GROUP_HASH_MIN_BUCKETS;
+  Entry **new_buckets;
+
+  if (!(new_buckets= (Entry**) my_malloc(PSI_INSTRUMENT_ME,
+                                         new_size * sizeof(Entry*),
+                                         MYF(MY_WME | MY_ZEROFILL |
+                                             MY_THREAD_SPECIFIC))))
+    return true;
+  for (Entry *entry= first; entry; entry= entry->next)
+  {
+    Entry **bucket= new_buckets + entry->hash % new_size;
+    entry->next_in_bucket= *bucket;
+    *bucket= entry;
+  }
+  my_free(buckets);
+  mem_used+= (new_size - n_buckets) * sizeof(Entry*);
+  buckets= new_buckets;
+  n_buckets= new_size;
+  return false;
+}
+
+
+/**
+  Add a new group
+
+  @param key     The key of the group, not in the hash yet
+  @param hash    hash_key(key)
+  @param record  The tmp table record of the group
+
+  @return The copy of the record in the hash, NULL on out of memory
+*/
+
+uchar *Group_hash::insert(const uchar *key, ulong hash, const uchar *record)
+{
+  Entry *entry;
+
+  if (n_entries >= n_buckets && grow())
+    return NULL;
+  if (!(entry= (Entry*) alloc_root(&mem_root, entry_size)))
+    return NULL;
+  mem_used+= entry_size;
+  n_entries++;
+
+  entry->hash= hash;
+  entry->next= NULL;
+  memcpy(entry_key(entry), key, key_length);
+  memcpy(entry_key(entry) + key_length, record, rec_length);
+
+  Entry **bucket= buckets + hash % n_buckets;
+  entry->next_in_bucket= *bucket;
+  *bucket= entry;
+  if (last)
+    last->next= entry;
+  else
+    first= entry;
+  last= entry;
+  return entry_key(entry) + key_length;
+}
+
+
+/* Remove all groups, the buckets are kept for the next execution */
+
+void Group_hash::reset()
+{
+  if (!n_entries)
+    return;
+  free_root(&mem_root, MYF(MY_KEEP_PREALLOC));
+  bzero(buckets, n_buckets * sizeof(Entry*));
+  mem_used= n_buckets * sizeof(Entry*);
+  n_entries= 0;
+  first= last= NULL;
+}
+
+
+void Group_hash::free()
+{
+  free_root(&mem_root, MYF(0));
+  my_free(buckets);
+  buckets= NULL;
+  n_buckets= n_entries= 0;
+  mem_used= 0;
+  first= last= NULL;
+}
@@ -0,0 +1,114 @@
+/*
+   Copyright (c) 2024, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#ifndef SQL_GROUP_HASH_INCLUDED
+#define SQL_GROUP_HASH_INCLUDED
+
+#include "mariadb.h"
+#include "sql_alloc.h"
+
+/*
+  Hash aggregation for GROUP BY
+  -----------------------------
+
+  With end_update() every row of the join output is looked up in the
+  temporary table by the group key, and the aggregate functions of the
+  group are updated with an update of the found tmp table row. For a HEAP
+  table this is an index lookup, a copy of the row and an index maintained
+  update per input row.
+
+  With @@group_by_hash the groups are first collected in a Group_hash, an
+  in-memory chained hash table keyed by the group key in the format of
+  TMP_TABLE_PARAM::group_buff. Each entry holds a copy of the tmp table
+  record of the group, and the aggregate functions are updated directly in
+  that copy. The groups are written into the temporary table only once,
+  when the join output has been consumed (see end_hash_update()).
+
+  The entries are allocated in a MEM_ROOT of their own. When a new group
+  would make the hash use more than its memory limit, all collected groups
+  are written into the temporary table and the rest of the rows are
+  aggregated by end_update(), as without the hash.
+
+  Hashing and comparison of the keys use key_hashnr() and key_buf_cmp()
+  with the group key of the temporary table, so groups are told apart
+  exactly as the unique key of the temporary table would do it.
+*/
+
+struct TABLE;
+struct st_key;
+class Group_hash_tracker;
+
+class Group_hash : public Sql_alloc
+{
+  struct Entry
+  {
+    Entry *next_in_bucket;
+    Entry *next;                   /* In the order of insertion */
+    ulong hash;
+    /* Followed by the key and the record of the group */
+  };
+
+  MEM_ROOT mem_root;
+  Entry **buckets;
+  ulong n_buckets;
+  ulong n_entries;
+  Entry *first;
+  Entry *last;
+  st_key *key_info;
+  uint key_parts;
+  uint key_length;
+  uint rec_length;
+  size_t entry_size;
+  size_t mem_limit;
+  size_t mem_used;
+
+  bool grow();
+  uchar *entry_key(Entry *entry) const { return (uchar*) (entry + 1); }
+
+public:
+  Group_hash_tracker *tracker;
+
+  Group_hash(TABLE *table, uint group_length, size_t limit);
+  ~Group_hash() { free(); }
+
+  static bool is_usable(TABLE *table);
+
+  ulong hash_key(const uchar *key) const;
+  uchar *find(const uchar *key, ulong hash) const;
+  uchar *insert(const uchar *key, ulong hash, const uchar *record);
+  /* TRUE <=> a new group would exceed the memory limit */
+  bool is_full() const
+  {
+    return mem_used + entry_size +
+           (n_entries >= n_buckets ? n_buckets * sizeof(Entry*) : 0) >
+           mem_limit;
+  }
+  ulong elements() const { return n_entries; }
+
+  /* Iteration over the groups in the order of insertion */
+  uchar *first_record() const
+  { return first ? entry_key(first) + key_length : NULL; }
+  uchar *next_record(const uchar *record) const
+  {
+    Entry *entry= ((Entry*) (record - key_length)) - 1;
+    return entry->next ? entry_key(entry->next) + key_length : NULL;
+  }
+
+  void reset();
+  void free();
+};
+
+#endif /* SQL_GROUP_HASH_INCLUDED */
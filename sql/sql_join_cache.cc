@@ -1030,7 +1030,8 @@ bool JOIN_CACHE::shrink_join_buffer_in_ratio(ulonglong n, ulonglong d)
 
   DESCRITION
     The function reallocates the join buffer of the join cache. After this
-    it resets the buffer for writing.
+    it resets the buffer for writing. The Bloom filter, if any, is sized
+    for the new buffer and cleared.
 
   NOTES
     The function assumes that buff_size contains the new value for the join
@@ -1044,6 +1045,9 @@ bool JOIN_CACHE::shrink_join_buffer_in_ratio(ulonglong n, ulonglong d)
 int JOIN_CACHE::realloc_buffer()
 {
   free();
+  if (bloom_filter &&
+      bloom_filter->resize(buff_size / MY_MAX(avg_record_length, 1)))
+    return 1;
   buff= (uchar*) my_malloc(key_memory_JOIN_CACHE, buff_size,
                                          MYF(MY_THREAD_SPECIFIC));
   reset(TRUE);
@@ -1108,6 +1112,303 @@ int JOIN_CACHE::init(bool for_explain)
 }
 
 
+/*
+  Check whether a column can be a component of the key of a join Bloom filter
+
+  SYNOPSIS
+    is_bloom_filter_key_field()
+      field  the column
+
+  DESCRIPTION
+    Only integer columns are used, because two integer values compare as
+    equal exactly when val_int() returns the same value for them.
+*/
+
+static bool is_bloom_filter_key_field(Field *field)
+{
+  switch (field->real_type()) {
+  case MYSQL_TYPE_TINY:
+  case MYSQL_TYPE_SHORT:
+  case MYSQL_TYPE_INT24:
+  case MYSQL_TYPE_LONG:
+  case MYSQL_TYPE_LONGLONG:
+    return TRUE;
+  default:
+    return FALSE;
+  }
+}
+
+
+/*
+  Create a Bloom filter over the join keys of the records in the join buffer
+
+  SYNOPSIS
+    create_bloom_filter()
+      for_explain  the join cache is created only for EXPLAIN
+
+  DESCRIPTION
+    If the optimizer switch 'join_cache_bloom_filter' is on the function
+    looks for equalities between integer columns of join_tab and integer
+    columns of the preceding tables that any match of a record from join_tab
+    has to satisfy. For BNL these are the top level equality predicates of
+    the condition attached to join_tab. For BNLH these are the components
+    of the hash join key whose value is taken from a column of a preceding
+    table of the same type, with the exception of the components that
+    match NULL values.
+    If such equalities are found a Bloom filter over the values of the
+    columns is created. The number of bits of the filter is chosen for the
+    number of records that are expected to fit into the join buffer.
+    The filter is not used when join_tab is an inner table of an outer
+    join or of a semi-join.
+
+  RETURN VALUE
+    0   the filter has been created or it is not used
+    1   otherwise
+*/
+
+int JOIN_CACHE::create_bloom_filter(bool for_explain)
+{
+  Field *outer[MAX_REF_PARTS];
+  Field *inner[MAX_REF_PARTS];
+  Field **outer_keys, **inner_keys;
+  uint n_keys= 0;
+  TABLE *table= join_tab->table;
+  DBUG_ENTER("JOIN_CACHE::create_bloom_filter");
+
+  if (!optimizer_flag(join->thd, OPTIMIZER_SWITCH_JOIN_CACHE_BLOOM_FILTER) ||
+      with_match_flag || join_tab->first_inner ||
+      join_tab->is_inner_table_of_semijoin() || join_tab->bush_root_tab)
+    DBUG_RETURN(0);
+
+  if (get_join_alg() == BNL_JOIN_ALG)
+  {
+    Item *cond= join_tab->select_cond;
+    List<Item> conds;
+    if (!cond)
+      DBUG_RETURN(0);
+    if (is_cond_and(cond))
+      conds.append(((Item_cond*) cond)->argument_list());
+    else
+      conds.push_back(cond, join->thd->mem_root);
+
+    List_iterator_fast<Item> li(conds);
+    Item *item;
+    while ((item= li++) && n_keys < MAX_REF_PARTS)
+    {
+      if (item->type() != Item::FUNC_ITEM ||
+          ((Item_func*) item)->functype() != Item_func::EQ_FUNC)
+        continue;
+      Item **args= ((Item_func*) item)->arguments();
+      Item *left= args[0]->real_item();
+      Item *right= args[1]->real_item();
+      if (left->type() != Item::FIELD_ITEM || right->type() != Item::FIELD_ITEM)
+        continue;
+      Field *left_field= ((Item_field*) left)->field;
+      Field *right_field= ((Item_field*) right)->field;
+      if (right_field->table == table)
+        swap_variables(Field*, left_field, right_field);
+      if (left_field->table != table || right_field->table == table ||
+          !is_bloom_filter_key_field(left_field) ||
+          !is_bloom_filter_key_field(right_field))
+        continue;
+      inner[n_keys]= left_field;
+      outer[n_keys]= right_field;
+      n_keys++;
+    }
+  }
+  else if (get_join_alg() == BNLH_JOIN_ALG)
+  {
+    TABLE_REF *ref= &join_tab->ref;
+    KEY *keyinfo= join_tab->get_keyinfo_by_key_no(ref->key);
+    if (ref->null_ref_key)
+      DBUG_RETURN(0);
+    for (uint i= 0; i < ref->key_parts; i++)
+    {
+      Item *item= ref->items[i]->real_item();
+      Field *key_field= keyinfo->key_part[i].field;
+      if (item->type() != Item::FIELD_ITEM)
+        continue;
+      Field *field= ((Item_field*) item)->field;
+      if (field->table == table ||
+          (field->maybe_null() &&
+           !(ref->null_rejecting & ((key_part_map) 1 << i))) ||
+          field->real_type() != key_field->real_type() ||
+          MY_TEST(field->flags & UNSIGNED_FLAG) !=
+          MY_TEST(key_field->flags & UNSIGNED_FLAG) ||
+          !is_bloom_filter_key_field(key_field))
+        continue;
+      inner[n_keys]= key_field;
+      outer[n_keys]= field;
+      n_keys++;
+    }
+  }
+
+  if (!n_keys)
+    DBUG_RETURN(0);
+
+  if (!(outer_keys= (Field**) join->thd->memdup(outer, n_keys*sizeof(Field*))) ||
+      !(inner_keys= (Field**) join->thd->memdup(inner, n_keys*sizeof(Field*))) ||
+      !(bloom_filter= new Join_bloom_filter(outer_keys, inner_keys, n_keys,
+                                            buff_size /
+                                            MY_MAX(avg_record_length, 1))))
+    DBUG_RETURN(1);
+  if (!for_explain && bloom_filter->alloc())
+  {
+    bloom_filter= 0;
+    DBUG_RETURN(1);
+  }
+  DBUG_RETURN(0);
+}
+
+
+Join_bloom_filter::Join_bloom_filter(Field **outer, Field **inner, uint n,
+                                     size_t records)
+  :bits(0), bits_set(0), n_keys(n), outer_keys(outer), inner_keys(inner)
+{
+  bit_mask= calc_bit_mask(records);
+}
+
+
+ulonglong Join_bloom_filter::calc_bit_mask(size_t records)
+{
+  ulonglong n_bits= 64;
+  while (n_bits < (ulonglong) records * JOIN_BLOOM_FILTER_BITS_PER_RECORD)
+    n_bits<<= 1;
+  return n_bits - 1;
+}
+
+
+bool Join_bloom_filter::alloc()
+{
+  return !(bits= (uchar*) my_malloc(PSI_INSTRUMENT_ME, size(),
+                                    MYF(MY_WME | MY_ZEROFILL)));
+}
+
+
+/*
+  Size the bit array for a new capacity of the join buffer and clear it,
+  return TRUE if the array cannot be reallocated
+*/
+
+bool Join_bloom_filter::resize(size_t records)
+{
+  ulonglong new_bit_mask= calc_bit_mask(records);
+  if (bits && new_bit_mask == bit_mask)
+  {
+    clear();
+    return FALSE;
+  }
+  free();
+  bit_mask= new_bit_mask;
+  bits_set= 0;
+  return alloc();
+}
+
+
+void Join_bloom_filter::clear()
+{
+  if (bits_set)
+  {
+    bzero(bits, size());
+    bits_set= 0;
+  }
+}
+
+
+/*
+  Calculate the hash value of a join key
+
+  SYNOPSIS
+    hash_key()
+      keys     the columns of the key
+      n_keys   the number of the columns
+      is_null  OUT TRUE if one of the columns is NULL
+
+  DESCRIPTION
+    The integer values of the columns are combined and mixed with the
+    finalizer of MurmurHash3, so that the two halves of the result can
+    be used as independent hash values.
+*/
+
+ulonglong Join_bloom_filter::hash_key(Field **keys, uint n_keys,
+                                      bool *is_null)
+{
+  ulonglong hash= 0;
+  for (Field **key= keys; key < keys + n_keys; key++)
+  {
+    if ((*key)->is_null())
+    {
+      *is_null= TRUE;
+      return 0;
+    }
+    hash= (hash ^ (ulonglong) (*key)->val_int()) + 0x9e3779b97f4a7c15ULL +
+          (hash << 6) + (hash >> 2);
+    hash^= hash >> 33;
+    hash*= 0xff51afd7ed558ccdULL;
+    hash^= hash >> 33;
+    hash*= 0xc4ceb9fe1a85ec53ULL;
+    hash^= hash >> 33;
+  }
+  *is_null= FALSE;
+  return hash;
+}
+
+
+/*
+  Add the join key of the current records of the preceding tables
+
+  DESCRIPTION
+    The bits number h1 + i*h2 (i= 0..JOIN_BLOOM_FILTER_HASHES-1) of the
+    filter are set, where h1 and h2 are the lower and the upper half of the
+    hash value of the key.
+*/
+
+void Join_bloom_filter::add()
+{
+  bool is_null;
+  ulonglong hash= hash_key(outer_keys, n_keys, &is_null);
+  if (is_null)
+    return;
+  ulonglong h1= hash & 0xFFFFFFFFULL;
+  ulonglong h2= (hash >> 32) | 1;
+  for (uint i= 0; i < JOIN_BLOOM_FILTER_HASHES; i++)
+    set_bit((h1 + i * h2) & bit_mask);
+}
+
+
+/*
+  Check whether the join key of the current record of the joined table
+  may have been added to the filter
+
+  RETURN VALUE
+    FALSE   no record in the join buffer can match the record
+    TRUE    otherwise
+*/
+
+bool Join_bloom_filter::may_match() const
+{
+  bool is_null;
+  ulonglong hash= hash_key(inner_keys, n_keys, &is_null);
+  if (is_null)
+    return FALSE;
+  ulonglong h1= hash & 0xFFFFFFFFULL;
+  ulonglong h2= (hash >> 32) | 1;
+  for (uint i= 0; i < JOIN_BLOOM_FILTER_HASHES; i++)
+  {
+    if (!get_bit((h1 + i * h2) & bit_mask))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+
+double Join_bloom_filter::false_positive_rate() const
+{
+  double fill= (double) bits_set / (double) (bit_mask + 1);
+  return pow(fill, JOIN_BLOOM_FILTER_HASHES);
+}
+
+
 /* 
   Check the possibility to read the access keys directly from the join buffer
   SYNOPSIS
@@ -1292,6 +1593,8 @@ bool JOIN_CACHE::check_emb_key_usage()
     If on_precond is attached to join_tab and it is not evaluated to TRUE
     then MATCH_IMPOSSIBLE is placed in the match flag field of the record
     written into the join buffer.
+    If the cache has a Bloom filter the join key of the record is added
+    to it.
        
   RETURN VALUE
     length of the written record data
@@ -1528,6 +1831,9 @@ uint JOIN_CACHE::write_record_data(uchar * link, bool *is_full)
       last_written_is_null_compl= 1;
     }
   } 
+
+  if (bloom_filter)
+    bloom_filter->add();
       
   return (uint) (cp-init_pos);
 }
@@ -1551,7 +1857,8 @@ uint JOIN_CACHE::write_record_data(uchar * link, bool *is_full)
       before the buffer, 
     - 'end_pos' is set to point to the beginning of the join buffer,
     - the size of the auxiliary buffer is reset to 0,
-    - the flag 'last_rec_blob_data_is_in_rec_buff' is set to 0.
+    - the flag 'last_rec_blob_data_is_in_rec_buff' is set to 0,
+    - the Bloom filter over the join keys is emptied if there is any.
     
   RETURN VALUE
     none
@@ -1567,6 +1874,8 @@ void JOIN_CACHE::reset(bool for_writing)
     aux_buff_size= 0;
     end_pos= pos;
     last_rec_blob_data_is_in_rec_buff= 0;
+    if (bloom_filter)
+      bloom_filter->clear();
   }
 }
 
@@ -2739,6 +3048,11 @@ bool JOIN_CACHE::save_explain_data(EXPLAIN_BKA_TYPE *explain)
   default:
     DBUG_ASSERT(0);
   }
+  if (bloom_filter)
+  {
+    explain->bloom_filter_size= bloom_filter->size();
+    explain->bloom_filter_hashes= JOIN_BLOOM_FILTER_HASHES;
+  }
   return 0;
 }
 
@@ -2952,7 +3266,8 @@ int JOIN_CACHE_HASHED::init_hash_table()
   DESCRITION
     The function reallocates the join buffer of the hashed join cache.
     After this it initializes a hash table within the buffer space and
-    resets the join cache for writing.
+    resets the join cache for writing. The Bloom filter, if any, is sized
+    for the new buffer and cleared.
 
   NOTES
     The function assumes that buff_size contains the new value for the join
@@ -2966,6 +3281,9 @@ int JOIN_CACHE_HASHED::init_hash_table()
 int JOIN_CACHE_HASHED::realloc_buffer()
 {
   free();
+  if (bloom_filter &&
+      bloom_filter->resize(buff_size / MY_MAX(avg_record_length, 1)))
+    return 1;
   buff= (uchar*) my_malloc(key_memory_JOIN_CACHE, buff_size,
                                          MYF(MY_THREAD_SPECIFIC));
   init_hash_table();
@@ -3352,6 +3670,34 @@ uint JOIN_CACHE_HASHED::get_hash_idx_complex(uchar *key, uint key_len)
     FALSE      otherwise
 */
 
+/* 
+  Get a hash value of a key that does not depend on the hash table size
+
+  SYNOPSIS
+    get_key_hash_value()
+      key             pointer to the key value
+      
+  DESCRIPTION
+    The function calculates a hash value for a key of the length key_length.
+    As get_hash_idx_complex() does, it returns the same value for any two
+    equal keys that may differ as byte sequences. Unlike the hash functions
+    above it returns the hash value itself rather than an index of the hash
+    entry in the hash table.
+
+  RETURN VALUE
+    the calculated hash value for the given key  
+*/
+
+ulong JOIN_CACHE_HASHED::get_key_hash_value(uchar *key)
+{
+  if (hash_func == &JOIN_CACHE_HASHED::get_hash_idx_complex)
+    return key_hashnr(ref_key_info, ref_used_key_parts, key);
+  ulong nr1= 1, nr2= 4;
+  my_ci_hash_sort(&my_charset_bin, key, key_length, &nr1, &nr2);
+  return nr1;
+}
+
+
 inline
 bool JOIN_CACHE_HASHED::equal_keys_simple(uchar *key1, uchar *key2,
                                           uint key_len)
@@ -3502,6 +3848,9 @@ int JOIN_TAB_SCAN::open()
   save_or_restore_used_tabs(join_tab, FALSE);
   is_first_record= TRUE;
   join_tab->tracker->r_scans++;
+  if (cache->bloom_filter)
+    join_tab->jbuf_bloom_tracker->on_probe(cache->bloom_filter->
+                                           false_positive_rate());
   return join_init_read_record(join_tab);
 }
 
@@ -3516,8 +3865,9 @@ int JOIN_TAB_SCAN::open()
     The function reads the next record from the joined table that can
     match some records in the buffer of the join cache 'cache'. To do
     this the function calls the function that scans table records and
-    looks for the next one that meets the condition pushed to the
-    joined table join_tab.
+    looks for the next one that passes the Bloom filter over the join keys
+    of the records in the buffer, if there is any, and meets the condition
+    pushed to the joined table join_tab.
 
   NOTES
     The function catches the signal that kills the query.
@@ -3527,12 +3877,21 @@ int JOIN_TAB_SCAN::open()
     error code   otherwise     
 */
 
+static inline bool check_bloom_filter(JOIN_TAB *join_tab,
+                                      Join_bloom_filter *filter)
+{
+  bool passed= filter->may_match();
+  join_tab->jbuf_bloom_tracker->on_row_checked(passed);
+  return passed;
+}
+
 int JOIN_TAB_SCAN::next()
 {
   int err= 0;
-  int skip_rc;
+  int skip_rc= 0;
   READ_RECORD *info= &join_tab->read_record;
   SQL_SELECT *select= join_tab->cache_select;
+  Join_bloom_filter *filter= cache->bloom_filter;
   THD *thd= join->thd;
 
   if (is_first_record)
@@ -3545,13 +3904,16 @@ int JOIN_TAB_SCAN::next()
     join_tab->tracker->r_rows++;
   }
 
-  while (!err && select && (skip_rc= select->skip_record(thd)) <= 0)
+  while (!err &&
+         ((filter && !check_bloom_filter(join_tab, filter)) ||
+          (select && (skip_rc= select->skip_record(thd)) <= 0)))
   {
     if (unlikely(thd->check_killed()) || skip_rc < 0)
       return 1;
     /* 
-      Move to the next record if the last retrieved record does not
-      meet the condition pushed to the table join_tab.
+      Move to the next record if the last retrieved record cannot match
+      any record from the join buffer or does not meet the condition
+      pushed to the table join_tab.
     */
     err= info->read_record();
     if (!err)
@@ -3778,7 +4140,10 @@ int JOIN_CACHE_BNL::init(bool for_explain)
   if (!(join_tab_scan= new JOIN_TAB_SCAN(join, join_tab)))
     DBUG_RETURN(1);
 
-  DBUG_RETURN(JOIN_CACHE::init(for_explain));
+  if (JOIN_CACHE::init(for_explain))
+    DBUG_RETURN(1);
+
+  DBUG_RETURN(create_bloom_filter(for_explain));
 }
 
 
@@ -3952,6 +4317,9 @@ void JOIN_CACHE_BNLH::read_next_candidate_for_match(uchar *rec_ptr)
   NOTES
     The function first constructs a companion object of the type JOIN_TAB_SCAN,
     then it calls the init method of the parent class.
+    If the optimizer has chosen to spill the records of the join cache into
+    partition files and this is possible for the cache, a companion object
+    of the type JOIN_TAB_SCAN_SPILL is constructed as well.
     
   RETURN VALUE  
     0   initialization with buffer allocations has been succeeded
@@ -3965,7 +4333,755 @@ int JOIN_CACHE_BNLH::init(bool for_explain)
   if (!(join_tab_scan= new JOIN_TAB_SCAN(join, join_tab)))
     DBUG_RETURN(1);
 
-  DBUG_RETURN(JOIN_CACHE_HASHED::init(for_explain));
+  if (JOIN_CACHE_HASHED::init(for_explain))
+    DBUG_RETURN(1);
+
+  /* The optimizer may have chosen to spill the buffer rather than refill it */
+  if (join_tab->hash_join_partitions && can_spill())
+  {
+    if (!for_explain &&
+        !(spill_scan= new JOIN_TAB_SCAN_SPILL(join, join_tab, this)))
+      DBUG_RETURN(1);
+    spill_partitions= join_tab->hash_join_partitions;
+  }
+  /*
+    A spilling cache is refilled from the partition files, which does not
+    go through the code that builds the filter
+  */
+  else if (create_bloom_filter(for_explain))
+    DBUG_RETURN(1);
+
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Save the information about the BNLH join cache for EXPLAIN
+
+  SYNOPSIS
+    save_explain_data()
+      explain       the structure to save the information to
+
+  DESCRIPTION
+    Additionally to what the default implementation does this function
+    saves the number of partitions the join cache spills its records into.
+
+  RETURN VALUE
+    0   ok
+    1   error
+*/
+
+bool JOIN_CACHE_BNLH::save_explain_data(EXPLAIN_BKA_TYPE *explain)
+{
+  if (JOIN_CACHE::save_explain_data(explain))
+    return 1;
+  explain->spill_partitions= spill_partitions;
+  return 0;
+}
+
+
+/*
+  Check whether the BNLH join cache can spill its records into partition files
+
+  SYNOPSIS
+    can_spill()
+
+  DESCRIPTION
+    A spilled record of the preceding tables is saved as the images of the
+    record buffers of these tables, a spilled record of join_tab as the image
+    of its record buffer. Restoring these images provides everything that is
+    needed to join the record only if:
+     - the cache is not linked to a previous cache,
+     - the records in the cache have no match flags, and join_tab is not
+       an inner table of an outer join or of a semi-join,
+     - no blob data and no rowids of the tables have to be kept,
+     - no table is inside a semi-join materialization nest.
+    Spilling is used only for SELECT statements.
+
+  RETURN VALUE
+    TRUE    the join cache can spill its records
+    FALSE   otherwise
+*/
+
+bool JOIN_CACHE_BNLH::can_spill()
+{
+  TABLE *table= join_tab->table;
+
+  if (prev_cache || with_match_flag || blobs ||
+      join_tab->first_inner || join_tab->is_inner_table_of_semijoin() ||
+      join_tab->bush_root_tab || join_tab->keep_current_rowid ||
+      join->thd->lex->sql_command != SQLCOM_SELECT)
+    return FALSE;
+
+  for (JOIN_TAB *tab= start_tab; tab != join_tab;
+       tab= next_linear_tab(join, tab, WITHOUT_BUSH_ROOTS))
+  {
+    if (tab->bush_root_tab || tab->keep_current_rowid)
+      return FALSE;
+  }
+
+  for (uint *blob= table->s->blob_field,
+            *end= blob + table->s->blob_fields;
+       blob < end; blob++)
+  {
+    if (bitmap_is_set(table->read_set, *blob))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+
+/*
+  Get the partition files for a level of partitioning
+
+  SYNOPSIS
+    get_spill_level()
+      level    the level of partitioning
+
+  DESCRIPTION
+    The function returns the descriptor of the partition files used on
+    the given level of partitioning, creating the files if this has not been
+    done yet. All files are truncated. The files use IO_CACHE buffers, so
+    small partitions never get written to disk.
+
+  RETURN VALUE
+    the descriptor of the partition files, or NULL in case of an error
+*/
+
+JOIN_CACHE_SPILL_LEVEL *JOIN_CACHE_BNLH::get_spill_level(uint level)
+{
+  JOIN_CACHE_SPILL_LEVEL *lvl= spill_levels[level];
+  uint n= spill_partitions;
+
+  DBUG_ASSERT(level <= JOIN_CACHE_MAX_SPILL_DEPTH);
+  if (!lvl)
+  {
+    IO_CACHE *files;
+    ha_rows *rows;
+    if (!my_multi_malloc(key_memory_JOIN_CACHE,
+                         MYF(MY_WME | MY_ZEROFILL | MY_THREAD_SPECIFIC),
+                         &lvl, sizeof(JOIN_CACHE_SPILL_LEVEL),
+                         &files, sizeof(IO_CACHE) * 2 * n,
+                         &rows, sizeof(ha_rows) * 2 * n,
+                         NullS))
+      return NULL;
+    lvl->outer_files= files;
+    lvl->inner_files= files + n;
+    lvl->outer_rows= rows;
+    lvl->inner_rows= rows + n;
+
+    for (uint i= 0; i < 2 * n; i++)
+    {
+      if (open_cached_file(&files[i], mysql_tmpdir, TEMP_PREFIX,
+                           JOIN_CACHE_SPILL_BUFF_SIZE, MYF(MY_WME)))
+      {
+        while (i)
+          close_cached_file(&files[--i]);
+        my_free(lvl);
+        return NULL;
+      }
+    }
+    /* Publish the level only when all its files are open */
+    spill_levels[level]= lvl;
+  }
+  else
+  {
+    for (uint i= 0; i < 2 * n; i++)
+    {
+      if (reinit_io_cache(&lvl->outer_files[i], WRITE_CACHE, 0L, 0, 1))
+        return NULL;
+    }
+  }
+  bzero(lvl->outer_rows, sizeof(ha_rows) * 2 * n);
+  return lvl;
+}
+
+
+/*
+  Close and free the partition files of the BNLH join cache 
+*/
+
+void JOIN_CACHE_BNLH::free_spill_levels()
+{
+  for (uint level= 0; level <= JOIN_CACHE_MAX_SPILL_DEPTH; level++)
+  {
+    JOIN_CACHE_SPILL_LEVEL *lvl= spill_levels[level];
+    if (!lvl)
+      continue;
+    for (uint i= 0; i < 2 * spill_partitions; i++)
+      close_cached_file(&lvl->outer_files[i]);
+    my_free(lvl);
+    spill_levels[level]= 0;
+  }
+  spill_state= SPILL_OFF;
+  spill_error= FALSE;
+}
+
+
+/*
+  Get the number of the partition for a join key
+
+  SYNOPSIS
+    get_spill_partition()
+      key      the join key
+      level    the level of partitioning
+
+  DESCRIPTION
+    The hash value of the key is mixed with the level, so that a partition
+    is split differently on each level, and independently of the way the
+    keys are distributed over the entries of the hash table in the buffer.
+
+  RETURN VALUE
+    the number of the partition for the key
+*/
+
+uint JOIN_CACHE_BNLH::get_spill_partition(uchar *key, uint level)
+{
+  ulonglong nr= ((ulonglong) get_key_hash_value(key) +
+                 (level + 1) * 0x9E3779B97F4A7C15ULL);
+  nr^= nr >> 33;
+  nr*= 0xFF51AFD7ED558CCDULL;
+  nr^= nr >> 33;
+  return (uint) (nr % spill_partitions);
+}
+
+
+/* Get the partition for the record of the preceding tables */
+
+uint JOIN_CACHE_BNLH::get_outer_spill_partition(uint level)
+{
+  TABLE_REF *ref= &join_tab->ref;
+  cp_buffer_from_ref(join->thd, join_tab->table, ref);
+  return get_spill_partition(ref->key_buff, level);
+}
+
+
+/* Get the partition for the record of join_tab */
+
+uint JOIN_CACHE_BNLH::get_inner_spill_partition(uint level)
+{
+  key_copy(key_buff, join_tab->table->record[0], ref_key_info, key_length,
+           TRUE);
+  return get_spill_partition(key_buff, level);
+}
+
+
+/*
+  Write the record of the preceding tables into a partition file
+
+  SYNOPSIS
+    write_outer_spill_record()
+      file     the partition file 
+
+  DESCRIPTION
+    The function writes the null row flag and the record buffer of each
+    table whose fields can be stored in the join cache.
+
+  RETURN VALUE
+    FALSE   ok
+    TRUE    error
+*/
+
+bool JOIN_CACHE_BNLH::write_outer_spill_record(IO_CACHE *file)
+{
+  for (JOIN_TAB *tab= start_tab; tab != join_tab;
+       tab= next_linear_tab(join, tab, WITHOUT_BUSH_ROOTS))
+  {
+    TABLE *table= tab->table;
+    uchar null_row= (uchar) table->null_row;
+    if (my_b_write(file, &null_row, 1) ||
+        my_b_write(file, table->record[0], table->s->reclength))
+      return TRUE;
+    join_tab->jbuf_spill_tracker->on_write(table->s->reclength + 1);
+  }
+  return FALSE;
+}
+
+
+/* Read a record written by write_outer_spill_record() */
+
+bool JOIN_CACHE_BNLH::read_outer_spill_record(IO_CACHE *file)
+{
+  for (JOIN_TAB *tab= start_tab; tab != join_tab;
+       tab= next_linear_tab(join, tab, WITHOUT_BUSH_ROOTS))
+  {
+    TABLE *table= tab->table;
+    uchar null_row;
+    if (my_b_read(file, &null_row, 1) ||
+        my_b_read(file, table->record[0], table->s->reclength))
+      return TRUE;
+    table->null_row= MY_TEST(null_row);
+  }
+  return FALSE;
+}
+
+
+/* Write the record of join_tab into a partition file */
+
+bool JOIN_CACHE_BNLH::write_inner_spill_record(IO_CACHE *file)
+{
+  TABLE *table= join_tab->table;
+  if (my_b_write(file, table->record[0], table->s->reclength))
+    return TRUE;
+  join_tab->jbuf_spill_tracker->on_write(table->s->reclength);
+  return FALSE;
+}
+
+
+/* Read a record written by write_inner_spill_record() */
+
+bool JOIN_CACHE_BNLH::read_inner_spill_record(IO_CACHE *file)
+{
+  TABLE *table= join_tab->table;
+  if (my_b_read(file, table->record[0], table->s->reclength))
+    return TRUE;
+  table->status= 0;
+  table->null_row= 0;
+  return FALSE;
+}
+
+
+/*
+  Add a record into the buffer of a BNLH join cache or into a partition file
+
+  SYNOPSIS
+    put_record()
+
+  DESCRIPTION
+    If the optimizer has chosen to let this join cache spill (see
+    @@join_cache_spill_partitions), the partitioned (grace) hash join
+    algorithm is used instead of refilling the join buffer when it
+    becomes full:
+    - all records from the buffer, and all records of the preceding tables
+      that come after them, are written into spill_partitions partition
+      files according to the hash value of their join key;
+    - when there are no more records, join_records() loads partition 0 
+      into the buffer and reads join_tab once. The records of join_tab from
+      partition 0 are matched right away (hybrid hash join), all other
+      records are written into the partition files for join_tab;
+    - each of the remaining partitions is loaded into the buffer and joined
+      with the records of join_tab from the same partition;
+    - a partition that does not fit into the buffer is split again with
+      another hash function, up to JOIN_CACHE_MAX_SPILL_DEPTH levels. 
+      Deeper partitions are joined by refilling the buffer, re-reading
+      only the partition file for join_tab.
+    Thus join_tab is read only once, and each spilled record is written
+    and read back at most once per level of partitioning.
+
+  RETURN VALUE
+    TRUE    if it has been decided that it should be the last record
+            in the join buffer, or an error occurred,
+    FALSE   otherwise
+*/
+
+bool JOIN_CACHE_BNLH::put_record()
+{
+  if (spill_state == SPILL_WRITING)
+  {
+    JOIN_CACHE_SPILL_LEVEL *lvl= spill_levels[0];
+    uint part= get_outer_spill_partition(0);
+    if (write_outer_spill_record(&lvl->outer_files[part]))
+    {
+      spill_error= TRUE;
+      return TRUE;
+    }
+    lvl->outer_rows[part]++;
+    return FALSE;
+  }
+
+  bool is_full= JOIN_CACHE_HASHED::put_record();
+  if (!is_full || !spill_partitions || spill_state != SPILL_OFF)
+    return is_full;
+
+  /* Move the records from the join buffer into the partition files */
+  JOIN_CACHE_SPILL_LEVEL *lvl;
+  if (!(lvl= get_spill_level(0)))
+  {
+    spill_error= TRUE;
+    return TRUE;
+  }
+  join_tab->jbuf_spill_tracker->on_spill(spill_partitions);
+  reset(FALSE);
+  for (size_t i= 0; i < records; i++)
+  {
+    get_record();
+    uint part= get_outer_spill_partition(0);
+    if (write_outer_spill_record(&lvl->outer_files[part]))
+    {
+      spill_error= TRUE;
+      return TRUE;
+    }
+    lvl->outer_rows[part]++;
+  }
+  reset(TRUE);
+  spill_state= SPILL_WRITING;
+  return FALSE;
+}
+
+
+/*
+  Join records from the join buffer or from the partition files with join_tab
+
+  SYNOPSIS
+    join_records()
+      skip_last    do not find matches for the last record from the buffer
+
+  DESCRIPTION
+    If the join cache has spilled its records into partition files the
+    function joins the partitions as described in the comment before
+    JOIN_CACHE_BNLH::put_record. Otherwise it just calls the default
+    implementation of join_records.
+
+  RETURN VALUE
+    return one of enum_nested_loop_state
+*/
+
+enum_nested_loop_state JOIN_CACHE_BNLH::join_records(bool skip_last)
+{
+  enum_nested_loop_state rc;
+  JOIN_TAB_SCAN *save_join_tab_scan= join_tab_scan;
+  DBUG_ENTER("JOIN_CACHE_BNLH::join_records");
+
+  /*
+    A failure to spill can leave spill_state == SPILL_OFF with a part
+    of the records already moved out of the join buffer
+  */
+  if (spill_error)
+    rc= NESTED_LOOP_ERROR;
+  else if (spill_state == SPILL_OFF)
+    DBUG_RETURN(JOIN_CACHE::join_records(skip_last));
+  else
+  {
+    DBUG_ASSERT(!skip_last);
+    spill_state= SPILL_JOINING;
+    join_tab_scan= spill_scan;
+    rc= join_spilled_records();
+    join_tab_scan= save_join_tab_scan;
+  }
+  spill_state= SPILL_OFF;
+  spill_error= FALSE;
+  reset(TRUE);
+  DBUG_RETURN(rc);
+}
+
+
+/*
+  Load records from a partition file into the join buffer
+
+  SYNOPSIS
+    load_spill_partition()
+      file              the partition file with records of preceding tables
+      rem_rows   in/out the number of records still to be read from the file
+
+  RETURN VALUE
+    -1   an error occurred
+     0   all remaining records have been loaded
+     1   the join buffer is full and some records remain in the file
+*/
+
+int JOIN_CACHE_BNLH::load_spill_partition(IO_CACHE *file, ha_rows *rem_rows)
+{
+  while (*rem_rows)
+  {
+    if (read_outer_spill_record(file))
+      return -1;
+    (*rem_rows)--;
+    if (JOIN_CACHE_HASHED::put_record() && *rem_rows)
+      return 1;
+  }
+  return 0;
+}
+
+
+/*
+  Join the records in the join buffer with the records from a partition file
+*/
+
+enum_nested_loop_state
+JOIN_CACHE_BNLH::join_spill_chunk(IO_CACHE *inner_file, ha_rows inner_rows)
+{
+  if (!records)
+    return NESTED_LOOP_OK;
+  spill_scan->set_file_source(inner_file, inner_rows);
+  return JOIN_CACHE::join_records(FALSE);
+}
+
+
+/*
+  Join a partition of the records of the preceding tables with the partition
+  of the records of join_tab for the same join keys
+
+  SYNOPSIS
+    join_spill_partition()
+      outer_file    the partition file with records of the preceding tables
+      outer_rows    the number of records in outer_file
+      inner_file    the partition file with records of join_tab
+      inner_rows    the number of records in inner_file
+      level         the level of partitioning the files belong to
+
+  DESCRIPTION
+    If the records from outer_file do not fit into the join buffer they
+    are split into sub-partitions together with the records from inner_file
+    unless the maximal level of partitioning has been reached. Otherwise 
+    inner_file is re-read for each refill of the join buffer.
+
+  RETURN VALUE
+    return one of enum_nested_loop_state
+*/
+
+enum_nested_loop_state
+JOIN_CACHE_BNLH::join_spill_partition(IO_CACHE *outer_file, ha_rows outer_rows,
+                                      IO_CACHE *inner_file, ha_rows inner_rows,
+                                      uint level)
+{
+  enum_nested_loop_state rc;
+  ha_rows rem_rows= outer_rows;
+  int res;
+
+  /* No matches are possible if any of the partitions is empty */
+  if (!outer_rows || !inner_rows)
+    return NESTED_LOOP_OK;
+
+  if (reinit_io_cache(outer_file, READ_CACHE, 0L, 0, 0))
+    return NESTED_LOOP_ERROR;
+  reset(TRUE);
+  while ((res= load_spill_partition(outer_file, &rem_rows)) > 0)
+  {
+    if (level < JOIN_CACHE_MAX_SPILL_DEPTH)
+    {
+      reset(TRUE);
+      return split_spill_partition(outer_file, outer_rows,
+                                   inner_file, inner_rows, level + 1);
+    }
+    rc= join_spill_chunk(inner_file, inner_rows);
+    if (rc != NESTED_LOOP_OK && rc != NESTED_LOOP_NO_MORE_ROWS)
+      return rc;
+  }
+  if (res < 0)
+    return NESTED_LOOP_ERROR;
+  return join_spill_chunk(inner_file, inner_rows);
+}
+
+
+/*
+  Split a pair of partitions into sub-partitions and join them
+
+  SYNOPSIS
+    split_spill_partition()
+      outer_file    the partition file with records of the preceding tables
+      outer_rows    the number of records in outer_file
+      inner_file    the partition file with records of join_tab
+      inner_rows    the number of records in inner_file
+      level         the level of the sub-partitions
+
+  RETURN VALUE
+    return one of enum_nested_loop_state
+*/
+
+enum_nested_loop_state
+JOIN_CACHE_BNLH::split_spill_partition(IO_CACHE *outer_file,
+                                       ha_rows outer_rows,
+                                       IO_CACHE *inner_file,
+                                       ha_rows inner_rows,
+                                       uint level)
+{
+  enum_nested_loop_state rc;
+  JOIN_CACHE_SPILL_LEVEL *lvl;
+  THD *thd= join->thd;
+  uint part;
+
+  if (!(lvl= get_spill_level(level)))
+    return NESTED_LOOP_ERROR;
+  join_tab->jbuf_spill_tracker->on_repartition(spill_partitions, level);
+
+  if (reinit_io_cache(outer_file, READ_CACHE, 0L, 0, 0))
+    return NESTED_LOOP_ERROR;
+  for (ha_rows i= 0; i < outer_rows; i++)
+  {
+    if (unlikely(thd->check_killed()))
+      return NESTED_LOOP_KILLED;
+    if (read_outer_spill_record(outer_file))
+      return NESTED_LOOP_ERROR;
+    part= get_outer_spill_partition(level);
+    if (write_outer_spill_record(&lvl->outer_files[part]))
+      return NESTED_LOOP_ERROR;
+    lvl->outer_rows[part]++;
+  }
+
+  if (reinit_io_cache(inner_file, READ_CACHE, 0L, 0, 0))
+    return NESTED_LOOP_ERROR;
+  for (ha_rows i= 0; i < inner_rows; i++)
+  {
+    if (unlikely(thd->check_killed()))
+      return NESTED_LOOP_KILLED;
+    if (read_inner_spill_record(inner_file))
+      return NESTED_LOOP_ERROR;
+    part= get_inner_spill_partition(level);
+    if (write_inner_spill_record(&lvl->inner_files[part]))
+      return NESTED_LOOP_ERROR;
+    lvl->inner_rows[part]++;
+  }
+
+  for (part= 0; part < spill_partitions; part++)
+  {
+    rc= join_spill_partition(&lvl->outer_files[part], lvl->outer_rows[part],
+                             &lvl->inner_files[part], lvl->inner_rows[part],
+                             level);
+    if (rc != NESTED_LOOP_OK && rc != NESTED_LOOP_NO_MORE_ROWS)
+      return rc;
+  }
+  return NESTED_LOOP_OK;
+}
+
+
+/*
+  Read join_tab writing its records into the partition files
+
+  SYNOPSIS
+    partition_join_tab()
+
+  DESCRIPTION
+    The function is used instead of join_matching_records() when no records
+    of partition 0 are in the join buffer. The records of join_tab that
+    the companion JOIN_TAB_SCAN_SPILL object returns are just ignored.
+
+  RETURN VALUE
+    return one of enum_nested_loop_state
+*/
+
+enum_nested_loop_state JOIN_CACHE_BNLH::partition_join_tab()
+{
+  enum_nested_loop_state rc;
+  int error;
+
+  if ((rc= join_tab_execution_startup(join_tab)) < 0)
+    return rc;
+  if (join_tab->need_to_build_rowid_filter &&
+      join_tab->build_range_rowid_filter())
+    return NESTED_LOOP_ERROR;
+
+  if (!(error= spill_scan->open()))
+  {
+    while (!(error= spill_scan->next()))
+    {}
+  }
+  spill_scan->close();
+  return error > 0 ? NESTED_LOOP_ERROR : NESTED_LOOP_OK;
+}
+
+
+/*
+  Join the records of the preceding tables spilled into the partition files
+
+  SYNOPSIS
+    join_spilled_records()
+
+  DESCRIPTION
+    The function reads join_tab once, keeping partition 0 of the records
+    of the preceding tables in the join buffer if it fits there, and then
+    joins the remaining partitions one by one.
+
+  RETURN VALUE
+    return one of enum_nested_loop_state
+*/
+
+enum_nested_loop_state JOIN_CACHE_BNLH::join_spilled_records()
+{
+  enum_nested_loop_state rc;
+  JOIN_CACHE_SPILL_LEVEL *lvl= spill_levels[0];
+  ha_rows rem_rows= lvl->outer_rows[0];
+  bool probe_first;
+  int res;
+
+  reset(TRUE);
+  if (reinit_io_cache(&lvl->outer_files[0], READ_CACHE, 0L, 0, 0) ||
+      (res= load_spill_partition(&lvl->outer_files[0], &rem_rows)) < 0)
+    return NESTED_LOOP_ERROR;
+  if (!(probe_first= (res == 0)))
+    reset(TRUE);
+
+  spill_scan->set_table_source(probe_first);
+  if (records)
+    rc= JOIN_CACHE::join_records(FALSE);
+  else
+    rc= partition_join_tab();
+  if (rc != NESTED_LOOP_OK && rc != NESTED_LOOP_NO_MORE_ROWS)
+    return rc;
+
+  for (uint part= probe_first ? 1 : 0; part < spill_partitions; part++)
+  {
+    rc= join_spill_partition(&lvl->outer_files[part], lvl->outer_rows[part],
+                             &lvl->inner_files[part], lvl->inner_rows[part],
+                             0);
+    if (rc != NESTED_LOOP_OK && rc != NESTED_LOOP_NO_MORE_ROWS)
+      return rc;
+  }
+  return NESTED_LOOP_OK;
+}
+
+
+/* 
+  Initiate the iteration over the records of join_tab for a spilling BNLH cache 
+
+  SYNOPSIS
+    open()
+
+  RETURN VALUE   
+    0            the initiation is a success 
+    error code   otherwise     
+*/
+
+int JOIN_TAB_SCAN_SPILL::open()
+{
+  if (!file)
+    return JOIN_TAB_SCAN::open();
+  save_or_restore_used_tabs(join_tab, FALSE);
+  rem_rows= file_rows;
+  return reinit_io_cache(file, READ_CACHE, 0L, 0, 0);
+}
+
+
+/* 
+  Read the next record of join_tab for a spilling BNLH cache 
+
+  SYNOPSIS
+    next()
+
+  DESCRIPTION
+    When join_tab is scanned the records that do not belong to partition 0,
+    or all records unless probe_first is set, are written into the partition
+    files for join_tab and skipped.
+
+  RETURN VALUE   
+    0            the next record exists and has been successfully read 
+    -1           there are no more records
+    error code   otherwise     
+*/
+
+int JOIN_TAB_SCAN_SPILL::next()
+{
+  int err;
+
+  if (file)
+  {
+    if (!rem_rows)
+      return -1;
+    rem_rows--;
+    return MY_TEST(bnlh_cache->read_inner_spill_record(file));
+  }
+
+  JOIN_CACHE_SPILL_LEVEL *lvl= bnlh_cache->spill_levels[0];
+  while (!(err= JOIN_TAB_SCAN::next()))
+  {
+    uint part= bnlh_cache->get_inner_spill_partition(0);
+    if (part == 0 && probe_first)
+      return 0;
+    if (unlikely(join->thd->check_killed()) ||
+        bnlh_cache->write_inner_spill_record(&lvl->inner_files[part]))
+      return 1;
+    lvl->inner_rows[part]++;
+  }
+  return err;
 }
 
 
@@ -62,9 +62,108 @@ typedef struct st_cache_field {
 
 
 class JOIN_TAB_SCAN;
+class JOIN_TAB_SCAN_SPILL;
 
 class EXPLAIN_BKA_TYPE;
 
+/*
+  The maximum level of recursive re-partitioning of a partition that does
+  not fit into the join buffer when a hashed join cache spills its records
+  into partition files.
+*/
+#define JOIN_CACHE_MAX_SPILL_DEPTH 2
+
+/* Size of the IO_CACHE buffer of a partition file of a hashed join cache */
+#define JOIN_CACHE_SPILL_BUFF_SIZE (IO_SIZE*4)
+
+/*
+  Partition files used on one level of partitioning by a hashed join cache
+  that spills the records of the join operands
+*/
+typedef struct st_join_cache_spill_level
+{
+  /* Files with the records of the preceding tables, one per partition */
+  IO_CACHE *outer_files;
+  /* Files with the records of the joined table, one per partition */
+  IO_CACHE *inner_files;
+  /* Numbers of the records written into the partition files */
+  ha_rows *outer_rows;
+  ha_rows *inner_rows;
+} JOIN_CACHE_SPILL_LEVEL;
+
+/* Number of bits of a join buffer Bloom filter per expected buffered record */
+#define JOIN_BLOOM_FILTER_BITS_PER_RECORD 10
+/* Number of the bits checked in a join buffer Bloom filter for a key */
+#define JOIN_BLOOM_FILTER_HASHES 3
+
+/*
+  A Bloom filter over the join keys of the records in a join buffer.
+
+  The filter is built from the equalities between integer columns of the
+  joined table and integer columns of the preceding tables that any match
+  has to satisfy. The key of every record written into the join buffer is
+  added to the filter, and the rows of the joined table whose key has not
+  been added are skipped before they are matched against the buffer.
+  A row with a NULL key never passes the filter, a record with a NULL key
+  is not added to it.
+*/
+
+class Join_bloom_filter :public Sql_alloc
+{
+  /* The bit array, the number of bits is a power of two */
+  uchar *bits;
+  /* The number of bits minus 1 */
+  ulonglong bit_mask;
+  /* The number of bits set in the array */
+  ulonglong bits_set;
+  /* The number of columns in the join key */
+  uint n_keys;
+  /* The join key columns of the preceding tables */
+  Field **outer_keys;
+  /* The join key columns of the joined table, in the same order */
+  Field **inner_keys;
+
+  static ulonglong hash_key(Field **keys, uint n_keys, bool *is_null);
+  static ulonglong calc_bit_mask(size_t records);
+  void set_bit(ulonglong bit)
+  {
+    uchar *byte= bits + (bit >> 3);
+    uchar mask= (uchar) (1 << (bit & 7));
+    if (!(*byte & mask))
+    {
+      *byte|= mask;
+      bits_set++;
+    }
+  }
+  bool get_bit(ulonglong bit) const
+  {
+    return MY_TEST(bits[bit >> 3] & (1 << (bit & 7)));
+  }
+
+public:
+  Join_bloom_filter(Field **outer, Field **inner, uint n, size_t records);
+
+  /* Allocate the bit array, return TRUE on failure */
+  bool alloc();
+  /* Size and clear the bit array for a new number of records */
+  bool resize(size_t records);
+  void free()
+  {
+    my_free(bits);
+    bits= 0;
+  }
+  void clear();
+
+  /* Add the key of the records of the preceding tables */
+  void add();
+  /* Check whether the key of the record of the joined table may match */
+  bool may_match() const;
+
+  size_t size() const { return (size_t) ((bit_mask + 1) >> 3); }
+  /* The probability that a key that has not been added passes the filter */
+  double false_positive_rate() const;
+};
+
 /*
   JOIN_CACHE is the base class to support the implementations of 
   - Block Nested Loop (BNL) Join Algorithm,
@@ -357,6 +456,13 @@ class JOIN_CACHE :public Sql_alloc
   */
   JOIN_TAB_SCAN *join_tab_scan;
 
+  /*
+    The Bloom filter over the join keys of the records in the buffer that
+    the iterator join_tab_scan checks the records of join_tab against,
+    or NULL if no filter is used
+  */
+  Join_bloom_filter *bloom_filter;
+
   void calc_record_fields();     
   void collect_info_on_key_args();
   int alloc_fields();
@@ -366,6 +472,9 @@ class JOIN_CACHE :public Sql_alloc
   void set_constants();
   int alloc_buffer();
 
+  /* Create a Bloom filter over the join keys of the buffered records */
+  int create_bloom_filter(bool for_explain);
+
   /* Shall reallocate the join buffer */
   virtual int realloc_buffer();
   
@@ -543,6 +652,7 @@ class JOIN_CACHE :public Sql_alloc
     buff= 0;
     min_buff_size= max_buff_size= 0;            // Caches
     not_exists_opt_is_applicable= false;
+    bloom_filter= 0;
   }
 
   /* 
@@ -559,6 +669,7 @@ class JOIN_CACHE :public Sql_alloc
     prev_cache= prev;
     buff= 0;
     min_buff_size= max_buff_size= 0;            // Caches
+    bloom_filter= 0;
     if (prev)
       prev->next_cache= this;
   }
@@ -671,7 +782,7 @@ class JOIN_CACHE :public Sql_alloc
   }
      
   /* Join records from the join buffer with records from the next join table */ 
-  enum_nested_loop_state join_records(bool skip_last);
+  virtual enum_nested_loop_state join_records(bool skip_last);
 
   /* Add a comment on the join algorithm employed by the join cache */
   virtual bool save_explain_data(EXPLAIN_BKA_TYPE *explain);
@@ -680,11 +791,19 @@ class JOIN_CACHE :public Sql_alloc
 
   virtual ~JOIN_CACHE() = default;
   void reset_join(JOIN *j) { join= j; }
-  void free()
+  virtual void free()
   { 
     my_free(buff);
     buff= 0;
   }   
+
+  /* Free the join buffer and the Bloom filter when the cache is dropped */
+  void cleanup()
+  {
+    free();
+    if (bloom_filter)
+      bloom_filter->free();
+  }
   
   friend class JOIN_CACHE_HASHED;
   friend class JOIN_CACHE_BNL;
@@ -984,6 +1103,9 @@ class JOIN_CACHE_HASHED: public JOIN_CACHE
   /* Search for a key in the hash table of the join buffer */
   bool key_search(uchar *key, uint key_len, uchar **key_ref_ptr);
 
+  /* Get a hash value of a key that does not depend on the hash table size */
+  ulong get_key_hash_value(uchar *key);
+
   /* Reallocate the join buffer of a hashed join cache */
   int realloc_buffer() override;
 
@@ -1158,6 +1280,64 @@ class JOIN_CACHE_BNL :public JOIN_CACHE
 
 class JOIN_CACHE_BNLH :public JOIN_CACHE_HASHED
 {
+  friend class JOIN_TAB_SCAN_SPILL;
+
+  /*
+    The state of the partitioned (grace) hash join that is used when the
+    records of the preceding tables do not fit into the join buffer.
+    See the comment before JOIN_CACHE_BNLH::put_record for details.
+  */
+  enum Spill_state
+  {
+    /* All records go to the join buffer */
+    SPILL_OFF,
+    /* The records of the preceding tables are written to partition files */
+    SPILL_WRITING,
+    /* The partitions are joined one by one */
+    SPILL_JOINING
+  };
+  Spill_state spill_state;
+
+  /*
+    The number of partitions the records of the join operands are split into
+    when the join buffer overflows. 0 means that the cache never spills.
+  */
+  uint spill_partitions;
+
+  /* Partition files for each level of partitioning */
+  JOIN_CACHE_SPILL_LEVEL *spill_levels[JOIN_CACHE_MAX_SPILL_DEPTH+1];
+
+  /* The iterator over join_tab records used when the partitions are joined */
+  JOIN_TAB_SCAN_SPILL *spill_scan;
+
+  /* Set when writing or reading a partition file failed */
+  bool spill_error;
+
+  bool can_spill();
+  JOIN_CACHE_SPILL_LEVEL *get_spill_level(uint level);
+  void free_spill_levels();
+  uint get_spill_partition(uchar *key, uint level);
+  uint get_outer_spill_partition(uint level);
+  uint get_inner_spill_partition(uint level);
+  bool write_outer_spill_record(IO_CACHE *file);
+  bool read_outer_spill_record(IO_CACHE *file);
+  bool write_inner_spill_record(IO_CACHE *file);
+  bool read_inner_spill_record(IO_CACHE *file);
+  int load_spill_partition(IO_CACHE *file, ha_rows *rem_rows);
+  enum_nested_loop_state join_spill_chunk(IO_CACHE *inner_file,
+                                          ha_rows inner_rows);
+  enum_nested_loop_state join_spill_partition(IO_CACHE *outer_file,
+                                              ha_rows outer_rows,
+                                              IO_CACHE *inner_file,
+                                              ha_rows inner_rows,
+                                              uint level);
+  enum_nested_loop_state split_spill_partition(IO_CACHE *outer_file,
+                                               ha_rows outer_rows,
+                                               IO_CACHE *inner_file,
+                                               ha_rows inner_rows,
+                                               uint level);
+  enum_nested_loop_state partition_join_tab();
+  enum_nested_loop_state join_spilled_records();
 
 protected:
 
@@ -1197,7 +1377,9 @@ class JOIN_CACHE_BNLH :public JOIN_CACHE_HASHED
     used to join table 'tab' to the result of joining the previous tables 
     specified by the 'j' parameter.
   */   
-  JOIN_CACHE_BNLH(JOIN *j, JOIN_TAB *tab) : JOIN_CACHE_HASHED(j, tab) {}
+  JOIN_CACHE_BNLH(JOIN *j, JOIN_TAB *tab)
+    : JOIN_CACHE_HASHED(j, tab), spill_state(SPILL_OFF), spill_partitions(0),
+      spill_levels(), spill_scan(0), spill_error(FALSE) {}
 
   /* 
     This constructor creates a linked BNLH join cache. The cache is to be 
@@ -1206,7 +1388,8 @@ class JOIN_CACHE_BNLH :public JOIN_CACHE_HASHED
     cache object to which this cache is linked.
   */   
   JOIN_CACHE_BNLH(JOIN *j, JOIN_TAB *tab, JOIN_CACHE *prev) 
-    : JOIN_CACHE_HASHED(j, tab, prev) {}
+    : JOIN_CACHE_HASHED(j, tab, prev), spill_state(SPILL_OFF),
+      spill_partitions(0), spill_levels(), spill_scan(0), spill_error(FALSE) {}
 
   /* Initialize the BNLH cache */       
   int init(bool for_explain) override;
@@ -1215,6 +1398,71 @@ class JOIN_CACHE_BNLH :public JOIN_CACHE_HASHED
 
   bool is_key_access() override { return TRUE; }
 
+  /* Add a record into the join buffer or into a partition file */
+  bool put_record() override;
+
+  /* Join the records from the join buffer or from the partition files */
+  enum_nested_loop_state join_records(bool skip_last) override;
+
+  bool save_explain_data(EXPLAIN_BKA_TYPE *explain) override;
+
+  void free() override
+  {
+    free_spill_levels();
+    JOIN_CACHE_HASHED::free();
+  }
+};
+
+
+/*
+  The class JOIN_TAB_SCAN_SPILL is a companion class for the class
+  JOIN_CACHE_BNLH used when the join cache spills its records into
+  partition files. 
+  If no partition file is set the iterator scans join_tab as JOIN_TAB_SCAN
+  does, but it writes every record that belongs to a partition other than
+  partition 0 into the partition file for the joined table and does not
+  return it. Records of partition 0 are returned only if probe_first is set,
+  otherwise they are written into their partition file as well.
+  If a partition file is set the iterator returns the records read from it.
+*/
+
+class JOIN_TAB_SCAN_SPILL: public JOIN_TAB_SCAN
+{
+  /* The join cache this object is a companion of */
+  JOIN_CACHE_BNLH *bnlh_cache;
+
+  /* The partition file to read the records from, or NULL */
+  IO_CACHE *file;
+  /* The number of records in 'file' */
+  ha_rows file_rows;
+  /* The number of records not read from 'file' yet */
+  ha_rows rem_rows;
+  /* TRUE <=> return the records of partition 0 when scanning join_tab */
+  bool probe_first;
+
+public:
+
+  JOIN_TAB_SCAN_SPILL(JOIN *j, JOIN_TAB *tab, JOIN_CACHE_BNLH *cache_arg)
+    :JOIN_TAB_SCAN(j, tab), bnlh_cache(cache_arg), file(0), file_rows(0),
+     rem_rows(0), probe_first(FALSE) {}
+
+  /* Scan join_tab, partitioning its records */
+  void set_table_source(bool probe_first_arg)
+  {
+    file= 0;
+    probe_first= probe_first_arg;
+  }
+
+  /* Read the records of join_tab from a partition file */
+  void set_file_source(IO_CACHE *file_arg, ha_rows rows)
+  {
+    file= file_arg;
+    file_rows= rows;
+  }
+
+  int open() override;
+
+  int next() override;
 };
 
 
@@ -165,6 +165,7 @@ class With_clause;
 class my_var;
 class select_handler;
 class Pushdown_select;
+class Saved_join_order;
 
 #define ALLOC_ROOT_SET 1024
 
@@ -1008,6 +1009,11 @@ class st_select_lex: public st_select_lex_node
   */
   List<String> *prev_join_using;
   JOIN *join; /* after JOIN::prepare it is pointer to corresponding JOIN */
+  /*
+    Join order chosen by the last execution of a prepared statement,
+    allocated on the statement arena, see @@optimizer_prepared_plan_reuse
+  */
+  Saved_join_order *saved_join_order;
   TABLE_LIST *embedding;          /* table embedding to the above list   */
   table_value_constr *tvc;
 
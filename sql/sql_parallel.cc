@@ -0,0 +1,288 @@
+/*
+   Copyright (c) 2024, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1335  USA */
+
+#include "mariadb.h"
+#include "sql_priv.h"
+#include "sql_class.h"
+#include "sql_parallel.h"
+#include "my_counter.h"
+
+/*
+  The worker threads are kept in a pool that is shared by all jobs of the
+  server. A job reserves its threads from @@max_parallel_threads, puts
+  itself into the queue and lets idle threads of the pool, or new ones if
+  there are not enough, take its worker slots. A thread that has been idle
+  for PARALLEL_THREAD_IDLE_TIMEOUT seconds exits.
+*/
+
+/* Seconds after which an idle worker thread exits */
+#define PARALLEL_THREAD_IDLE_TIMEOUT 60
+
+ulong opt_max_parallel_threads;
+
+struct Parallel_job_state
+{
+  Parallel_job *job;
+  THD *thd;                      /* Checked for being killed, may be NULL */
+  uint n_tasks;
+  Atomic_counter<uint> next_task;
+  /* The following are protected by LOCK_parallel_threads */
+  uint n_workers;                /* Number of worker slots */
+  uint next_worker;              /* Next slot to be taken by a thread */
+  uint running;                  /* Slots that have not finished */
+  Parallel_job_state *next;      /* In parallel_job_queue */
+};
+
+static mysql_mutex_t LOCK_parallel_threads;
+/* Signalled when a job is queued or at shutdown */
+static mysql_cond_t COND_parallel_job_queued;
+/* Signalled when a worker finishes a job or a thread exits */
+static mysql_cond_t COND_parallel_job_done;
+/* Jobs with worker slots that no thread has taken yet */
+static Parallel_job_state *parallel_job_queue;
+/* Threads reserved by the running jobs */
+static uint parallel_threads_reserved;
+/* Threads of the pool, and how many of them wait for a job */
+static uint parallel_threads_total, parallel_threads_idle;
+static bool parallel_threads_shutdown;
+static bool parallel_threads_inited;
+
+#ifdef HAVE_PSI_INTERFACE
+static PSI_mutex_key key_LOCK_parallel_threads;
+static PSI_cond_key key_COND_parallel_job_queued, key_COND_parallel_job_done;
+
+static PSI_mutex_info all_parallel_mutexes[]=
+{
+  { &key_LOCK_parallel_threads, "LOCK_parallel_threads", PSI_FLAG_GLOBAL}
+};
+
+static PSI_cond_info all_parallel_conds[]=
+{
+  { &key_COND_parallel_job_queued, "COND_parallel_job_queued",
+    PSI_FLAG_GLOBAL},
+  { &key_COND_parallel_job_done, "COND_parallel_job_done", PSI_FLAG_GLOBAL}
+};
+#endif
+
+
+void parallel_threads_init()
+{
+#ifdef HAVE_PSI_INTERFACE
+  mysql_mutex_register("sql", all_parallel_mutexes,
+                       array_elements(all_parallel_mutexes));
+  mysql_cond_register("sql", all_parallel_conds,
+                      array_elements(all_parallel_conds));
+#endif
+  mysql_mutex_init(key_LOCK_parallel_threads, &LOCK_parallel_threads,
+                   MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_COND_parallel_job_queued, &COND_parallel_job_queued,
+                  NULL);
+  mysql_cond_init(key_COND_parallel_job_done, &COND_parallel_job_done, NULL);
+  parallel_threads_inited= true;
+}
+
+
+/* Stop the idle worker threads; no job may be running */
+
+void parallel_threads_end()
+{
+  if (!parallel_threads_inited)
+    return;
+  parallel_threads_inited= false;
+  mysql_mutex_lock(&LOCK_parallel_threads);
+  DBUG_ASSERT(!parallel_job_queue);
+  parallel_threads_shutdown= true;
+  mysql_cond_broadcast(&COND_parallel_job_queued);
+  while (parallel_threads_total)
+    mysql_cond_wait(&COND_parallel_job_done, &LOCK_parallel_threads);
+  mysql_mutex_unlock(&LOCK_parallel_threads);
+  mysql_cond_destroy(&COND_parallel_job_done);
+  mysql_cond_destroy(&COND_parallel_job_queued);
+  mysql_mutex_destroy(&LOCK_parallel_threads);
+}
+
+
+/**
+  Reserve worker threads from @@max_parallel_threads
+
+  @param n  Number of threads wanted
+
+  @return Number of threads reserved, at most n; 0 if none is left
+*/
+
+uint parallel_threads_reserve(uint n)
+{
+  mysql_mutex_lock(&LOCK_parallel_threads);
+  uint left= opt_max_parallel_threads > parallel_threads_reserved
+    ? (uint) opt_max_parallel_threads - parallel_threads_reserved : 0;
+  set_if_smaller(n, left);
+  parallel_threads_reserved+= n;
+  mysql_mutex_unlock(&LOCK_parallel_threads);
+  return n;
+}
+
+
+/* Return threads reserved by parallel_threads_reserve() */
+
+void parallel_threads_release(uint n)
+{
+  mysql_mutex_lock(&LOCK_parallel_threads);
+  DBUG_ASSERT(parallel_threads_reserved >= n);
+  parallel_threads_reserved-= n;
+  mysql_mutex_unlock(&LOCK_parallel_threads);
+}
+
+
+static void parallel_job_dequeue(Parallel_job_state *state)
+{
+  mysql_mutex_assert_owner(&LOCK_parallel_threads);
+  for (Parallel_job_state **prev= &parallel_job_queue; *prev;
+       prev= &(*prev)->next)
+  {
+    if (*prev == state)
+    {
+      *prev= state->next;
+      break;
+    }
+  }
+}
+
+
+pthread_handler_t parallel_worker_thread(void *)
+{
+  my_thread_init();
+  my_thread_set_name("parallel_job");
+  mysql_mutex_lock(&LOCK_parallel_threads);
+  for (;;)
+  {
+    Parallel_job_state *state= parallel_job_queue;
+    if (!state)
+    {
+      struct timespec abstime;
+      if (parallel_threads_shutdown)
+        break;
+      set_timespec(abstime, PARALLEL_THREAD_IDLE_TIMEOUT);
+      parallel_threads_idle++;
+      int error= mysql_cond_timedwait(&COND_parallel_job_queued,
+                                      &LOCK_parallel_threads, &abstime);
+      parallel_threads_idle--;
+      if ((error == ETIMEDOUT || error == ETIME) && !parallel_job_queue)
+        break;
+      continue;
+    }
+
+    uint worker= state->next_worker++;
+    if (state->next_worker == state->n_workers)
+      parallel_job_dequeue(state);
+    mysql_mutex_unlock(&LOCK_parallel_threads);
+
+    uint task;
+    while ((task= state->next_task++) < state->n_tasks)
+    {
+      if (state->thd && state->thd->killed)
+        break;
+      state->job->run_task(task, worker);
+    }
+
+    mysql_mutex_lock(&LOCK_parallel_threads);
+    if (!--state->running)
+      mysql_cond_broadcast(&COND_parallel_job_done);
+  }
+  parallel_threads_total--;
+  mysql_cond_broadcast(&COND_parallel_job_done);
+  mysql_mutex_unlock(&LOCK_parallel_threads);
+  my_thread_end();
+  return NULL;
+}
+
+
+/**
+  Run the tasks of a job on worker threads
+
+  @param thd        If not NULL, no more tasks are started once this
+                    connection has been killed
+  @param job        The job
+  @param n_tasks    Number of tasks of the job
+  @param n_threads  Number of worker threads to use
+
+  @note
+    The calling thread only waits for the workers. The threads are
+    reserved from @@max_parallel_threads, so the job may get fewer of
+    them than requested. If some of the threads could not be created
+    the tasks are run by the others.
+
+  @retval FALSE  All tasks have been run, or the connection was killed
+  @retval TRUE   No worker thread was available and no task was run
+*/
+
+bool run_parallel_job(THD *thd, Parallel_job *job, uint n_tasks,
+                      uint n_threads)
+{
+  Parallel_job_state state;
+  uint reserved, create= 0;
+  DBUG_ENTER("run_parallel_job");
+
+  set_if_smaller(n_threads, n_tasks);
+  set_if_smaller(n_threads, MAX_PARALLEL_JOB_THREADS);
+  if (!(reserved= parallel_threads_reserve(n_threads)))
+    DBUG_RETURN(TRUE);
+
+  state.job= job;
+  state.thd= thd;
+  state.n_tasks= n_tasks;
+  state.next_task= 0;
+  state.n_workers= state.running= reserved;
+  state.next_worker= 0;
+
+  mysql_mutex_lock(&LOCK_parallel_threads);
+  state.next= parallel_job_queue;
+  parallel_job_queue= &state;
+  if (parallel_threads_idle)
+    mysql_cond_broadcast(&COND_parallel_job_queued);
+  if (reserved > parallel_threads_idle)
+    create= reserved - parallel_threads_idle;
+  parallel_threads_total+= create;
+  mysql_mutex_unlock(&LOCK_parallel_threads);
+
+  for (uint i= 0; i < create; i++)
+  {
+    pthread_t thread;
+    if (!mysql_thread_create(key_thread_parallel_job, &thread,
+                             &connection_attrib, parallel_worker_thread,
+                             NULL))
+      continue;
+    /* Give up a slot that no thread has taken yet */
+    mysql_mutex_lock(&LOCK_parallel_threads);
+    parallel_threads_total--;
+    if (state.next_worker < state.n_workers)
+    {
+      state.n_workers--;
+      state.running--;
+      if (state.next_worker == state.n_workers)
+        parallel_job_dequeue(&state);
+    }
+    mysql_mutex_unlock(&LOCK_parallel_threads);
+  }
+
+  mysql_mutex_lock(&LOCK_parallel_threads);
+  while (state.running)
+    mysql_cond_wait(&COND_parallel_job_done, &LOCK_parallel_threads);
+  parallel_threads_reserved-= reserved;
+  mysql_mutex_unlock(&LOCK_parallel_threads);
+
+  DBUG_PRINT("info", ("tasks: %u  threads: %u", n_tasks, state.n_workers));
+  DBUG_RETURN(state.n_workers == 0);
+}
@@ -0,0 +1,67 @@
+/*
+   Copyright (c) 2024, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1335  USA */
+
+#ifndef SQL_PARALLEL_INCLUDED
+#define SQL_PARALLEL_INCLUDED
+
+/*
+  Intra-query parallelism helpers
+  -------------------------------
+
+  A Parallel_job is a piece of work of the statement that is split into a
+  number of independent tasks, for example sorting segments of a sort
+  buffer. run_parallel_job() lets a set of worker threads pick the tasks
+  one by one until none is left, and waits for them.
+
+  The worker threads of all jobs are reserved from a server-wide budget,
+  @@max_parallel_threads, and taken from a pool where they wait for the
+  next job. When the budget is exhausted, the work is done serially.
+
+  The worker threads have no THD. Tasks must not use current_thd, raise
+  errors with my_error() or allocate thread specific memory; everything a
+  task needs is prepared by the connection thread, and failures are
+  recorded in the job and reported by the connection thread afterwards.
+*/
+
+class THD;
+
+/* Upper bound for the number of threads of one job */
+#define MAX_PARALLEL_JOB_THREADS 256
+
+class Parallel_job
+{
+public:
+  virtual ~Parallel_job() {}
+  /*
+    Execute task number 'task'. 'worker' is the number of the thread that
+    runs it, less than the number of threads passed to run_parallel_job(),
+    and can be used to give each thread its own working memory.
+  */
+  virtual void run_task(uint task, uint worker)= 0;
+};
+
+bool run_parallel_job(THD *thd, Parallel_job *job, uint n_tasks,
+                      uint n_threads);
+
+/* @@max_parallel_threads */
+extern ulong opt_max_parallel_threads;
+
+uint parallel_threads_reserve(uint n);
+void parallel_threads_release(uint n);
+void parallel_threads_init();
+void parallel_threads_end();
+
+#endif /* SQL_PARALLEL_INCLUDED */
@@ -1398,6 +1398,11 @@ dispatch_command_return do_command(THD *thd, bool blocking)
   /* Restore read timeout value */
   my_net_set_read_timeout(net, thd->variables.net_read_timeout);
 
+#ifndef EMBEDDED_LIBRARY
+  if (thd->client_capabilities & MARIADB_CLIENT_PIPELINE)
+    net_cork_pipeline(net);
+#endif
+
   DBUG_ASSERT(packet_length);
   DBUG_ASSERT(!thd->apc_target.is_enabled());
 
@@ -193,6 +193,8 @@ class Prepared_statement: public Statement
   my_bool iterations;
   my_bool start_param;
   my_bool read_types;
+  /* Join orders have been saved in the selects of the statement */
+  bool has_saved_join_orders;
 
 #ifndef EMBEDDED_LIBRARY
   bool (*set_params)(Prepared_statement *st, uchar *data, uchar *data_end,
@@ -325,6 +327,33 @@ find_prepared_statement(THD *thd, ulong id)
 }
 
 
+/**
+  Record what happened to the saved join order of a select of the prepared
+  statement being executed
+
+  @see @@optimizer_prepared_plan_reuse
+*/
+
+void prepared_stmt_plan_event(THD *thd, enum_ps_plan_event event)
+{
+  DBUG_ASSERT(thd->stmt_arena->type() == Query_arena::PREPARED_STATEMENT);
+  Prepared_statement *stmt= (Prepared_statement *) thd->stmt_arena;
+
+  switch (event) {
+  case PS_PLAN_HIT:
+    MYSQL_PLAN_PS(stmt->m_prepared_stmt, PSI_PS_PLAN_HIT);
+    break;
+  case PS_PLAN_MISS:
+    stmt->has_saved_join_orders= true;
+    MYSQL_PLAN_PS(stmt->m_prepared_stmt, PSI_PS_PLAN_MISS);
+    break;
+  case PS_PLAN_INVALIDATE:
+    MYSQL_PLAN_PS(stmt->m_prepared_stmt, PSI_PS_PLAN_INVALIDATE);
+    break;
+  }
+}
+
+
 /**
   Send prepared statement id and metadata to the client after prepare.
 
@@ -3891,6 +3920,7 @@ Prepared_statement::Prepared_statement(THD *thd_arg)
   iterations(0),
   start_param(0),
   read_types(0),
+  has_saved_join_orders(false),
   m_sql_mode(thd->variables.sql_mode),
   m_prepare_time_thd_used_flags(0),
   m_prepare_time_charset_collation_map_version(0)
@@ -4760,6 +4790,12 @@ Prepared_statement::reprepare()
   if (likely(!error))
   {
     MYSQL_REPREPARE_PS(m_prepared_stmt);
+    /* The join orders saved in the old selects are lost */
+    if (has_saved_join_orders)
+    {
+      MYSQL_PLAN_PS(m_prepared_stmt, PSI_PS_PLAN_INVALIDATE);
+      has_saved_join_orders= false;
+    }
     swap_prepared_statement(&copy);
     swap_parameter_array(param_array, copy.param_array, param_count);
 #ifdef DBUG_ASSERT_EXISTS
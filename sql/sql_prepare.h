@@ -95,6 +95,15 @@ void mysqld_stmt_reset(THD *thd, char *packet);
 void mysql_stmt_get_longdata(THD *thd, char *pos, ulong packet_length);
 void reinit_stmt_before_use(THD *thd, LEX *lex);
 
+/* What happened to the saved join order of a select */
+enum enum_ps_plan_event
+{
+  PS_PLAN_HIT,                                  /* It was used */
+  PS_PLAN_MISS,                                 /* A new order was saved */
+  PS_PLAN_INVALIDATE                            /* It could not be used */
+};
+void prepared_stmt_plan_event(THD *thd, enum_ps_plan_event event);
+
 my_bool bulk_parameters_iterations(THD *thd);
 my_bool bulk_parameters_set(THD *thd);
 /**
@@ -175,6 +175,8 @@
 #define OPTIMIZER_SWITCH_HASH_JOIN_CARDINALITY     (1ULL << 35)
 #define OPTIMIZER_SWITCH_CSET_NARROWING            (1ULL << 36)
 #define OPTIMIZER_SWITCH_SARGABLE_CASEFOLD         (1ULL << 37)
+#define OPTIMIZER_SWITCH_JOIN_ORDER_GOO            (1ULL << 38)
+#define OPTIMIZER_SWITCH_JOIN_CACHE_BLOOM_FILTER   (1ULL << 39)
 
 
 /*
@@ -65,6 +65,10 @@
 #include "sp_head.h"
 #include "sp_rcontext.h"
 #include "rowid_filter.h"
+#include "sql_batch_filter.h"
+#include "sql_group_hash.h"
+#include "opt_join_order_cache.h"
+#include "sql_prepare.h"                   // prepared_stmt_plan_event
 #include "select_handler.h"
 #include "my_json_writer.h"
 #include "opt_trace.h"
@@ -148,6 +152,9 @@ static bool get_quick_record_count(THD *thd, SQL_SELECT *select,
 static void optimize_straight_join(JOIN *join, table_map join_tables);
 static bool greedy_search(JOIN *join, table_map remaining_tables,
                           uint depth, uint use_cond_selectivity);
+static void goo_join_order(JOIN *join, table_map remaining_tables);
+static bool apply_cached_join_order(JOIN *join, table_map remaining_tables,
+                                    const uchar *order);
 
 enum enum_best_search {
   SEARCH_ABORT= -2,
@@ -220,6 +227,7 @@ bool const_expression_in_where(COND *conds,Item *item, Item **comp_item);
 static int do_select(JOIN *join, Procedure *procedure);
 
 static enum_nested_loop_state evaluate_join_record(JOIN *, JOIN_TAB *, int);
+static enum_nested_loop_state sub_select_batched(JOIN *, JOIN_TAB *);
 static enum_nested_loop_state
 evaluate_null_complemented_join_record(JOIN *join, JOIN_TAB *join_tab);
 static enum_nested_loop_state
@@ -230,6 +238,8 @@ static enum_nested_loop_state
 end_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
 static enum_nested_loop_state
 end_unique_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
+static enum_nested_loop_state
+end_hash_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
 
 static int join_read_const_table(THD *thd, JOIN_TAB *tab, POSITION *pos);
 static int join_read_system(JOIN_TAB *tab);
@@ -480,6 +490,7 @@ POSITION::POSITION()
   inner_tables_handled_with_other_sjs= 0;
   type= JT_UNKNOWN;
   key_dependent= 0;
+  hash_join_partitions= 0;
   dups_weedout_picker.set_empty();
   firstmatch_picker.set_empty();
   loosescan_picker.set_empty();
@@ -2611,6 +2622,8 @@ JOIN::optimize_inner()
     sum_funcs= &tmp_sum_funcs;
     res= opt_sum_query(thd, select_lex->leaf_tables, all_fields, conds);
     sum_funcs= save_func_sums;
+    if (!res)
+      res= opt_parallel_sum_query(this);
 
     if (res)
     {
@@ -8549,6 +8562,7 @@ struct best_plan
   SplM_plan_info *spl_plan;
   table_map ref_depends_map;
   ulonglong refills;                     // Join cache refills
+  uint hash_join_partitions;             // Partitions instead of refills
   enum join_type type;
   uint forced_index;
   uint max_key_part;
@@ -8616,6 +8630,7 @@ best_access_path(JOIN      *join,
   best.found_ref= 0;
   best.ref_depends_map= 0;
   best.refills= 0;
+  best.hash_join_partitions= 0;
   best.use_join_buffer= FALSE;
   best.spl_plan= 0;
 
@@ -9383,6 +9398,8 @@ best_access_path(JOIN      *join,
     Json_writer_object trace_access_hash(thd);
     double refills, row_copy_cost, copy_cost, cur_cost, where_cost;
     double matching_combinations, fanout= 0.0, join_sel;
+    double spill_cost= 0.0;
+    uint hash_join_partitions= 0;
     trace_access_hash.add("type", "hash");
     trace_access_hash.add("index", "hj-key");
     /* Estimate the cost of the hash join access to the table */
@@ -9440,11 +9457,38 @@ best_access_path(JOIN      *join,
     else
       cur_cost= s->cached_scan_and_compare_time;
 
+    row_copy_cost= (ROW_COPY_COST_THD(thd) *
+                    JOIN_CACHE_ROW_COPY_COST_FACTOR(thd));
+
     /* We read the table as many times as join buffer becomes full. */
     refills= (1.0 + floor((double) cache_record_length(join,idx) *
                           record_count /
                           (double) thd->variables.join_buff_size));
-    cur_cost= COST_MULT(cur_cost, refills);
+    if (refills > 1.0 && thd->variables.join_cache_spill_partitions)
+    {
+      /*
+        Instead of refilling the join buffer the records of both join
+        operands can be spilled into partition files while the table is
+        read once. Each partition is then joined separately. The spilled
+        records are written and read back once.
+      */
+      double spill_bytes= ((double) cache_record_length(join,idx) *
+                           record_count +
+                           (double) table->s->reclength * rnd_records);
+      spill_cost= (2.0 * spill_bytes / IO_SIZE * DISK_READ_COST_THD(thd) +
+                   2.0 * (record_count + rnd_records) * row_copy_cost);
+      if (COST_ADD(cur_cost, spill_cost) < COST_MULT(cur_cost, refills))
+      {
+        double partitions= MY_MIN(2.0 * ceil(refills),
+                                  (double) thd->variables.
+                                  join_cache_spill_partitions);
+        hash_join_partitions= (uint) MY_MAX(partitions, 2.0);
+      }
+    }
+    if (hash_join_partitions)
+      cur_cost= COST_ADD(cur_cost, spill_cost);
+    else
+      cur_cost= COST_MULT(cur_cost, refills);
 
 
     /*
@@ -9453,8 +9497,6 @@ best_access_path(JOIN      *join,
       We assume here that, thanks to the hash, we don't have to compare all
       row combinations, only a fanout or HASH_FANOUT (10%) rows in the cache.
     */
-    row_copy_cost= (ROW_COPY_COST_THD(thd) *
-                    JOIN_CACHE_ROW_COPY_COST_FACTOR(thd));
     matching_combinations= fanout * join_sel * record_count;
     copy_cost= (record_count * row_copy_cost +
                 matching_combinations *
@@ -9470,8 +9512,16 @@ best_access_path(JOIN      *join,
     best.use_join_buffer= TRUE;
     best.filter= 0;
     best.type= JT_HASH;
-    best.refills= double_to_ulonglong(ceil(refills));
+    /* The table is read once if the join buffer spills */
+    best.refills= (hash_join_partitions ? 1 :
+                   double_to_ulonglong(ceil(refills)));
+    best.hash_join_partitions= hash_join_partitions;
     if (unlikely(trace_access_hash.trace_started()))
+    {
+      if (hash_join_partitions)
+        trace_access_hash.
+          add("partitions", hash_join_partitions).
+          add("spill_cost", spill_cost);
       trace_access_hash.
         add("rows", rnd_records).
         add("rows_after_hash", fanout * join_sel).
@@ -9480,6 +9530,7 @@ best_access_path(JOIN      *join,
         add("extra_cond_check_cost", where_cost).
         add("total_cost", best.cost).
         add("chosen", true);
+    }
   }
 
   /*
@@ -9848,6 +9899,7 @@ best_access_path(JOIN      *join,
                                 (join->allowed_outer_join_with_cache ||
                                  !(s->table->map & join->outer_join)));
       best.refills= refills;
+      best.hash_join_partitions= 0;
       best.spl_plan= 0;
       best.type= type;
       trace_access_scan.add("chosen", true);
@@ -9890,6 +9942,7 @@ best_access_path(JOIN      *join,
   pos->key_dependent= (best.type == JT_EQ_REF ? (table_map) 0 :
                        key_dependent & remaining_tables);
   pos->refills=  best.refills;
+  pos->hash_join_partitions= best.hash_join_partitions;
 
   loose_scan_opt.save_to_position(s, record_count, pos->records_out,
                                   loose_scan_pos);
@@ -10052,6 +10105,7 @@ choose_plan(JOIN *join, table_map join_tables, TABLE_LIST *emb_sjm_nest)
   bool straight_join= MY_TEST(join->select_options & SELECT_STRAIGHT_JOIN);
   THD *thd= join->thd;
   qsort2_cmp jtab_sort_func;
+  ulonglong start_time= microsecond_interval_timer();
   DBUG_ENTER("choose_plan");
 
   join->limit_optimization_mode= false;
@@ -10129,48 +10183,147 @@ choose_plan(JOIN *join, table_map join_tables, TABLE_LIST *emb_sjm_nest)
       join->extra_heuristic_pruning= true;
     }
 
-    double limit_cost= DBL_MAX;
-    double limit_record_count;
-    POSITION *limit_plan= NULL;
+    /*
+      Joins of several tables without semi-joins and ORDER BY ... LIMIT
+      short-cutting may take their join order from the previous execution
+      of the prepared statement or from the join order cache, and have it
+      chosen by goo_join_order() when they have more tables than the search
+      depth.
+    */
+    uchar cache_key[JOIN_ORDER_CACHE_KEY_SIZE];
+    uchar saved_key[JOIN_ORDER_CACHE_KEY_SIZE];
+    bool use_saved= false, use_cache= false, use_goo= false;
+    if (!join->emb_sjm_nest && !join->limit_shortcut_applicable &&
+        join->select_lex->sj_nests.is_empty() &&
+        join->table_count - join->const_tables > 1)
+    {
+      use_saved= (thd->variables.optimizer_prepared_plan_reuse &&
+                  thd->stmt_arena->type() ==
+                  Query_arena::PREPARED_STATEMENT &&
+                  saved_join_order_key(join, saved_key));
+      use_cache= (join_order_cache_size &&
+                  join_order_cache_key(join, cache_key));
+      use_goo= (optimizer_flag(thd, OPTIMIZER_SWITCH_JOIN_ORDER_GOO) &&
+                join->table_count - join->const_tables > search_depth);
+    }
 
-    /* First, build a join plan that can short-cut ORDER BY...LIMIT */
-    if (join->limit_shortcut_applicable && !join->emb_sjm_nest)
+    if (use_saved || use_cache || use_goo)
     {
-      bool res;
-      Json_writer_object wrapper(join->thd);
-      Json_writer_array trace(join->thd, "join_limit_shortcut_plan_search");
-      join->limit_optimization_mode= true;
-      res= greedy_search(join, join_tables, search_depth,
-                         use_cond_selectivity);
-      join->limit_optimization_mode= false;
+      uchar order[MAX_TABLES];
+      Saved_join_order *saved= join->select_lex->saved_join_order;
+      bool saved_hit= false, cache_hit= false;
 
-      if (res)
-        DBUG_RETURN(TRUE);
-      DBUG_ASSERT(join->best_read != DBL_MAX);
+      if (use_saved && saved &&
+          saved_join_order_is_usable(join, saved, saved_key,
+                                     thd->variables.
+                                     optimizer_prepared_plan_reuse_ratio) &&
+          !apply_cached_join_order(join, join_tables, saved->order))
+      {
+        saved_hit= true;
+        prepared_stmt_plan_event(thd, PS_PLAN_HIT);
+      }
+      else if (use_cache &&
+               join_order_cache_lookup(cache_key, order, join->table_count) &&
+               !apply_cached_join_order(join, join_tables, order))
+      {
+        cache_hit= true;
+        status_var_increment(thd->status_var.optimizer_join_order_cache_hits);
+      }
+      else
+      {
+        if (use_cache)
+          status_var_increment(thd->status_var.
+                               optimizer_join_order_cache_misses);
+        if (use_goo)
+          goo_join_order(join, join_tables);
+        else if (greedy_search(join, join_tables, search_depth,
+                               use_cond_selectivity))
+          DBUG_RETURN(TRUE);
+      }
 
-      /*
-        We've built a join order. Adjust its cost based on ORDER BY...LIMIT
-        short-cutting.
-      */
-      limit_plan= join_limit_shortcut_finalize_plan(join, &limit_cost);
-      limit_record_count= join->join_record_count;
-    }
+      /* Compute the plan of the chosen order with the current statistics */
+      if (saved_hit || cache_hit || use_goo)
+        optimize_straight_join(join, join_tables);
 
-    /* The main call to search for the query plan: */
-    if (greedy_search(join, join_tables, search_depth, use_cond_selectivity))
-      DBUG_RETURN(TRUE);
+      if (!saved_hit && !cache_hit)
+      {
+        for (uint i= join->const_tables; i < join->table_count; i++)
+          order[i]= (uchar) join->best_positions[i].table->table->tablenr;
+        if (use_cache)
+          join_order_cache_store(cache_key, order, join->table_count);
+      }
 
-    DBUG_ASSERT(join->best_read != DBL_MAX);
-    if (limit_plan && limit_cost < join->best_read)
+      if (use_saved && !saved_hit)
+      {
+        if (saved)
+          prepared_stmt_plan_event(thd, PS_PLAN_INVALIDATE);
+        if ((join->select_lex->saved_join_order=
+             save_join_order(join, saved, saved_key, order)))
+          prepared_stmt_plan_event(thd, PS_PLAN_MISS);
+      }
+
+      if (unlikely(thd->trace_started()))
+      {
+        trace_plan.end();
+        Json_writer_object trace_search(thd, "join_order_search");
+        trace_search.add("algorithm", saved_hit ? "saved" :
+                                      cache_hit ? "cached" :
+                                      use_goo ? "goo" : "greedy");
+        if (use_saved)
+          trace_search.add("saved_plan_hit", saved_hit);
+        if (use_cache && !saved_hit)
+          trace_search.add("cache_hit", cache_hit);
+        trace_search.add("time_ms",
+                         (microsecond_interval_timer() - start_time) / 1000.0);
+      }
+    }
+    else
     {
-      /* Plan that uses ORDER BY ... LIMIT shortcutting is better. */
-      memcpy((uchar*)join->best_positions, (uchar*)limit_plan,
-             sizeof(POSITION)*join->table_count);
-      join->best_read= limit_cost;
-      join->join_record_count= limit_record_count;
+      double limit_cost= DBL_MAX;
+      double limit_record_count;
+      POSITION *limit_plan= NULL;
+
+      /* First, build a join plan that can short-cut ORDER BY...LIMIT */
+      if (join->limit_shortcut_applicable && !join->emb_sjm_nest)
+      {
+        bool res;
+        Json_writer_object wrapper(join->thd);
+        Json_writer_array trace(join->thd, "join_limit_shortcut_plan_search");
+        join->limit_optimization_mode= true;
+        res= greedy_search(join, join_tables, search_depth,
+                           use_cond_selectivity);
+        join->limit_optimization_mode= false;
+
+        if (res)
+          DBUG_RETURN(TRUE);
+        DBUG_ASSERT(join->best_read != DBL_MAX);
+
+        /*
+          We've built a join order. Adjust its cost based on ORDER BY...LIMIT
+          short-cutting.
+        */
+        limit_plan= join_limit_shortcut_finalize_plan(join, &limit_cost);
+        limit_record_count= join->join_record_count;
+      }
+
+      /* The main call to search for the query plan: */
+      if (greedy_search(join, join_tables, search_depth, use_cond_selectivity))
+        DBUG_RETURN(TRUE);
+
+      DBUG_ASSERT(join->best_read != DBL_MAX);
+      if (limit_plan && limit_cost < join->best_read)
+      {
+        /* Plan that uses ORDER BY ... LIMIT shortcutting is better. */
+        memcpy((uchar*)join->best_positions, (uchar*)limit_plan,
+               sizeof(POSITION)*join->table_count);
+        join->best_read= limit_cost;
+        join->join_record_count= limit_record_count;
+      }
     }
   }
 
+  thd->status_var.optimizer_join_order_time+=
+    (ulong) (microsecond_interval_timer() - start_time);
   join->emb_sjm_nest= 0;
   DBUG_RETURN(FALSE);
 }
@@ -10532,6 +10685,164 @@ optimize_straight_join(JOIN *join, table_map remaining_tables)
 }
 
 
+/**
+  Choose the join order of a join by Greedy Operator Ordering (GOO)
+
+    GOO builds the join by joining first the two relations that give the
+    smallest intermediate result. As the executor only runs left-deep plans,
+    the algorithm is restricted here to extending a single join prefix:
+
+    - the first table is the one that starts the pair of tables with the
+      smallest number of result rows,
+    - each next table is the one that gives the smallest number of rows of
+      the extended prefix.
+
+    Ties are broken by the cost of the access method. The number of calls
+    of best_access_path() is O(N^2), where N is the number of tables to
+    join, compared to O(N^search_depth) for greedy_search().
+
+    The tables are put in the chosen order in join->best_ref. The plan itself
+    is computed afterwards by optimize_straight_join().
+
+  @param join              pointer to the structure providing all context info
+                           for the query
+  @param remaining_tables  set of the tables to order
+*/
+
+static void
+goo_join_order(JOIN *join, table_map remaining_tables)
+{
+  bool disable_jbuf= join->thd->variables.join_cache_level == 0;
+  double record_count= 1.0;
+  POSITION pos, best_pos, pair_pos, loose_scan_pos;
+  DBUG_ENTER("goo_join_order");
+
+  for (uint idx= join->const_tables; remaining_tables; idx++)
+  {
+    JOIN_TAB **best= NULL;
+    double best_records= DBL_MAX, best_cost= DBL_MAX;
+    table_map allowed= join->get_allowed_nj_tables(idx) & remaining_tables;
+    /* Look one table further for the first table of the join */
+    bool pairs= (idx == join->const_tables &&
+                 (remaining_tables & (remaining_tables - 1)));
+
+    for (JOIN_TAB **ref= join->best_ref + idx; *ref; ref++)
+    {
+      JOIN_TAB *s= *ref;
+      if (!(allowed & s->table->map) || (remaining_tables & s->dependent))
+        continue;
+
+      best_access_path(join, s, remaining_tables, join->positions, idx,
+                       disable_jbuf, record_count, &pos, &loose_scan_pos);
+      double records= COST_MULT(record_count, pos.records_out);
+      double cost= pos.read_time;
+
+      if (pairs)
+      {
+        table_map rest= remaining_tables & ~s->table->map;
+        double pair_records= DBL_MAX, pair_cost= DBL_MAX;
+
+        join->positions[idx]= pos;
+        check_interleaving_with_nj(s);
+        table_map allowed_next= join->get_allowed_nj_tables(idx + 1) & rest;
+        for (JOIN_TAB **next= join->best_ref + idx; *next; next++)
+        {
+          JOIN_TAB *t= *next;
+          if (!(allowed_next & t->table->map) || (rest & t->dependent))
+            continue;
+          best_access_path(join, t, rest, join->positions, idx + 1,
+                           disable_jbuf, records, &pair_pos, &loose_scan_pos);
+          double rows= COST_MULT(records, pair_pos.records_out);
+          double rows_cost= COST_ADD(cost, pair_pos.read_time);
+          if (rows < pair_records ||
+              (rows == pair_records && rows_cost < pair_cost))
+          {
+            pair_records= rows;
+            pair_cost= rows_cost;
+          }
+        }
+        restore_prev_nj_state(s);
+        if (pair_records != DBL_MAX)
+        {
+          records= pair_records;
+          cost= pair_cost;
+        }
+      }
+
+      if (records < best_records ||
+          (records == best_records && cost < best_cost))
+      {
+        best= ref;
+        best_records= records;
+        best_cost= cost;
+        best_pos= pos;
+      }
+    }
+    DBUG_ASSERT(best);
+
+    join->positions[idx]= best_pos;
+    check_interleaving_with_nj(*best);
+    swap_variables(JOIN_TAB*, join->best_ref[idx], *best);
+    record_count= COST_MULT(record_count, join->positions[idx].records_out);
+    remaining_tables&= ~join->best_ref[idx]->table->map;
+  }
+
+  /* Let optimize_straight_join() start from an empty join prefix */
+  reset_nj_counters(join, join->join_list);
+  join->cur_embedding_map= 0;
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Put the tables of a join in a join order taken from the join order cache
+
+  @param join              pointer to the structure providing all context info
+                           for the query
+  @param remaining_tables  set of the tables to order
+  @param order             TABLE::tablenr of the tables, in the join order
+
+  @retval
+    FALSE       ok, the order is in join->best_ref
+  @retval
+    TRUE        the order is not a valid order of the join; join->best_ref is
+                left unchanged
+*/
+
+static bool
+apply_cached_join_order(JOIN *join, table_map remaining_tables,
+                        const uchar *order)
+{
+  JOIN_TAB *saved_ref[MAX_TABLES];
+  uint n_tables= join->table_count - join->const_tables;
+  bool error= false;
+
+  memcpy(saved_ref, join->best_ref + join->const_tables,
+         n_tables * sizeof(JOIN_TAB*));
+  for (uint idx= join->const_tables; idx < join->table_count; idx++)
+  {
+    JOIN_TAB **ref= join->best_ref + idx;
+    while (*ref && (*ref)->table->tablenr != order[idx])
+      ref++;
+    if (!*ref || (remaining_tables & (*ref)->dependent) ||
+        check_interleaving_with_nj(*ref))
+    {
+      error= true;
+      break;
+    }
+    swap_variables(JOIN_TAB*, join->best_ref[idx], *ref);
+    remaining_tables&= ~join->best_ref[idx]->table->map;
+  }
+
+  reset_nj_counters(join, join->join_list);
+  join->cur_embedding_map= 0;
+  if (error)
+    memcpy(join->best_ref + join->const_tables, saved_ref,
+           n_tables * sizeof(JOIN_TAB*));
+  return error;
+}
+
+
 /**
   Find a good, possibly optimal, query execution plan (QEP) by a greedy search.
 
@@ -13249,6 +13560,7 @@ bool JOIN::get_best_combination()
     j->records_out=  cur_pos->records_out;
     j->join_read_time= cur_pos->read_time;
     j->join_loops=     cur_pos->loops;
+    j->hash_join_partitions= cur_pos->hash_join_partitions;
 
   loop_end:
     j->cond_selectivity= cur_pos->cond_selectivity;
@@ -15201,7 +15513,7 @@ void set_join_cache_denial(JOIN_TAB *join_tab)
     if (join_tab->cache->next_cache)
       join_tab->cache->next_cache->prev_cache= 0;
 
-    join_tab->cache->free();
+    join_tab->cache->cleanup();
     join_tab->cache= 0;
   }
   if (join_tab->use_join_cache)
@@ -16216,6 +16528,10 @@ make_join_readinfo(JOIN *join, ulonglong options, uint no_jbuf_after)
       /* purecov: end */
     }
     tab->cached_pfs_batch_update= tab->pfs_batch_update();
+    tab->need_to_build_batch_filter= MY_TEST(join->thd->variables.
+                                             join_batch_filter_rows);
+    tab->scan_batch_buf= 0;
+    tab->scan_batch_rows= (uint) join->thd->variables.scan_batch_rows;
 
     DBUG_EXECUTE("where",
                  char buff[256];
@@ -16377,6 +16693,67 @@ void JOIN_TAB::clear_range_rowid_filter()
   range_rowid_filter_info= 0;
 }
 
+
+/**
+   build_batch_filter()
+
+   Build the batch pre-filter for the attached condition of the join tab.
+   This function should only be called if need_to_build_batch_filter is
+   true. Not being able to use a batch filter is not an error.
+
+  @retval
+    0	ok
+  @retval
+    1	Error
+*/
+
+bool JOIN_TAB::build_batch_filter()
+{
+  DBUG_ASSERT(need_to_build_batch_filter && !batch_filter);
+  need_to_build_batch_filter= false;
+  batch_filter= Batch_filter::create(join->thd, this);
+  return join->thd->is_error();
+}
+
+
+/**
+  Read the rows of a table scan set up by join_init_read_record() in
+  batches of scan_batch_rows rows, if the scan allows it.
+
+  @details
+    The rows are read ahead, so the scan must not lock rows or need the
+    position of the handler for the current row. The buffer is allocated
+    on the first scan and is limited by join_buffer_size.
+*/
+
+void JOIN_TAB::init_scan_batch()
+{
+  if (keep_current_rowid || table->s->tmp_table != NO_TMP_TABLE ||
+      table->reginfo.lock_type >= TL_FIRST_WRITE || table->vfield)
+    return;
+
+  if (!scan_batch_buf)
+  {
+    THD *thd= join->thd;
+    size_t reclength= table->s->reclength;
+    set_if_smaller(scan_batch_rows,
+                   (uint) MY_MIN(thd->variables.join_buff_size / reclength,
+                                 UINT_MAX32));
+    if (scan_batch_rows < 2 ||
+        !(scan_batch_buf= (uchar*) thd->alloc(scan_batch_rows * reclength)))
+    {
+      scan_batch_rows= 0;
+      return;
+    }
+    /* The columns that are not read keep their default values */
+    for (uint i= 0; i < scan_batch_rows; i++)
+      memcpy(scan_batch_buf + i * reclength, table->s->default_values,
+             reclength);
+  }
+  init_read_record_batch(&read_record, scan_batch_buf, scan_batch_rows);
+}
+
+
 /**
   cleanup JOIN_TAB.
 
@@ -16398,9 +16775,14 @@ void JOIN_TAB::cleanup()
   quick= 0;
   if (rowid_filter)
     clear_range_rowid_filter();
+  delete batch_filter;
+  batch_filter= 0;
+  need_to_build_batch_filter= false;
+  scan_batch_buf= 0;
+  scan_batch_rows= 0;
   if (cache)
   {
-    cache->free();
+    cache->cleanup();
     cache= 0;
   }
   limit= 0;
@@ -16940,6 +17322,8 @@ void JOIN::cleanup(bool full)
         {
           if (curr_tab->aggr)
           {
+            if (curr_tab->aggr->group_hash)
+              curr_tab->aggr->group_hash->free();
             free_tmp_table(thd, curr_tab->table);
             curr_tab->table= NULL;
             delete curr_tab->tmp_table_param;
@@ -23359,8 +23743,22 @@ void set_postjoin_aggr_write_func(JOIN_TAB *tab)
     */
     if (table->s->keys && !table->s->have_unique_constraint())
     {
-      DBUG_PRINT("info",("Using end_update"));
-      aggr->set_write_func(end_update);
+      THD *thd= join->thd;
+      if (thd->variables.group_by_hash && Group_hash::is_usable(table) &&
+          (aggr->group_hash ||
+           (aggr->group_hash= new (thd->mem_root)
+              Group_hash(table, tmp_tbl->group_length,
+                         (size_t) MY_MIN(thd->variables.tmp_memory_table_size,
+                                         thd->variables.max_heap_table_size)))))
+      {
+        DBUG_PRINT("info",("Using end_hash_update"));
+        aggr->set_write_func(end_hash_update);
+      }
+      else
+      {
+        DBUG_PRINT("info",("Using end_update"));
+        aggr->set_write_func(end_update);
+      }
     }
     else
     {
@@ -24026,6 +24424,10 @@ sub_select(JOIN *join,JOIN_TAB *join_tab,bool end_of_records)
       rc= NESTED_LOOP_NO_MORE_ROWS;
   }
 
+  if (unlikely(join_tab->need_to_build_batch_filter) &&
+      join_tab->build_batch_filter())
+    DBUG_RETURN(NESTED_LOOP_ERROR);
+
   join->return_tab= join_tab;
 
   if (join_tab->last_inner)
@@ -24056,10 +24458,15 @@ sub_select(JOIN *join,JOIN_TAB *join_tab,bool end_of_records)
 
   if (rc != NESTED_LOOP_NO_MORE_ROWS)
   {
-    error= (*join_tab->read_first_record)(join_tab);
-    if (!error && join_tab->keep_current_rowid)
-      join_tab->table->file->position(join_tab->table->record[0]);    
-    rc= evaluate_join_record(join, join_tab, error);
+    if (join_tab->batch_filter)
+      rc= sub_select_batched(join, join_tab);
+    else
+    {
+      error= (*join_tab->read_first_record)(join_tab);
+      if (!error && join_tab->keep_current_rowid)
+        join_tab->table->file->position(join_tab->table->record[0]);
+      rc= evaluate_join_record(join, join_tab, error);
+    }
   }
 
   bool skip_over= FALSE;
@@ -24117,6 +24524,81 @@ sub_select(JOIN *join,JOIN_TAB *join_tab,bool end_of_records)
   DBUG_RETURN(rc);
 }
 
+/**
+  @brief Read all rows of a join tab in batches and pre-filter them.
+
+  @details
+    This is used by sub_select() instead of the row-by-row read loop when
+    the join tab has a batch filter. Rows are read the same way, but they
+    are accumulated in the buffer of the batch filter until it is full or
+    the scan ends. The batch kernels then reject the rows that cannot
+    satisfy the attached condition, and the remaining rows are passed to
+    evaluate_join_record() one by one.
+
+  @param  join     - The join object
+  @param  join_tab - The join_tab being read
+
+  @return Nested loop state. NESTED_LOOP_NO_MORE_ROWS is returned when all
+          rows have been read.
+*/
+
+static enum_nested_loop_state
+sub_select_batched(JOIN *join, JOIN_TAB *join_tab)
+{
+  THD *thd= join->thd;
+  Batch_filter *filter= join_tab->batch_filter;
+  READ_RECORD *info= &join_tab->read_record;
+  Diagnostics_area *da= thd->get_stmt_da();
+  enum_nested_loop_state rc;
+  int error;
+  DBUG_ENTER("sub_select_batched");
+
+  error= (*join_tab->read_first_record)(join_tab);
+  for (;;)
+  {
+    uint n_rows= 0;
+    while (!error)
+    {
+      filter->store_row(n_rows);
+      if (++n_rows == filter->capacity())
+        break;
+      error= info->read_record();
+    }
+    if (error > 0 || unlikely(thd->is_error()))
+      DBUG_RETURN(NESTED_LOOP_ERROR);
+    if (unlikely(thd->check_killed()))
+      DBUG_RETURN(NESTED_LOOP_KILLED);
+
+    uint n_selected= filter->evaluate(n_rows);
+    ha_rows n_rejected= n_rows - n_selected;
+    join_tab->tracker->on_batch_filtered(n_rows, n_selected);
+    /*
+      Rejected rows were read, but they never reach the attached condition:
+      r_filtered is computed over the rows that passed the kernels only.
+    */
+    join_tab->tracker->r_rows+= n_rejected;
+    thd->inc_examined_row_count_fast(n_rejected);
+
+    for (uint i= 0; i < n_rows; i++)
+    {
+      if (!filter->is_selected(i))
+      {
+        da->inc_current_row_for_warning();
+        continue;
+      }
+      filter->restore_row(i);
+      rc= evaluate_join_record(join, join_tab, 0);
+      if (rc != NESTED_LOOP_OK || join->return_tab < join_tab)
+        DBUG_RETURN(rc);
+    }
+
+    if (error)
+      DBUG_RETURN(NESTED_LOOP_NO_MORE_ROWS);
+    error= info->read_record();
+  }
+}
+
+
 /**
   @brief Process one row of the nested loop join.
 
@@ -25113,6 +25595,9 @@ int join_init_read_record(JOIN_TAB *tab)
     if (init_read_record(&tab->read_record, tab->join->thd, tab->table,
                          tab->select, tab->filesort_result, 1, 1, FALSE))
       return 1;
+    if (tab->scan_batch_rows &&
+        tab->read_record.read_record_func == rr_sequential)
+      tab->init_scan_batch();
   }
   tab->read_record.copy_field=     save_copy;
   tab->read_record.copy_field_end= save_copy_end;
@@ -25676,6 +26161,32 @@ end_write(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
 }
 
 
+/**
+  Make the key of the group of the current row in tmp_table_param->group_buff
+*/
+
+static inline void make_group_key(TABLE *table)
+{
+  for (ORDER *group= table->group ; group ; group= group->next)
+  {
+    Item *item= *group->item;
+    if (group->fast_field_copier_setup != group->field)
+    {
+      DBUG_PRINT("info", ("new setup %p -> %p",
+                          group->fast_field_copier_setup,
+                          group->field));
+      group->fast_field_copier_setup= group->field;
+      group->fast_field_copier_func=
+        item->setup_fast_field_copier(group->field);
+    }
+    item->save_org_in_field(group->field, group->fast_field_copier_func);
+    /* Store in the used key if the field was 0 */
+    if (item->maybe_null())
+      group->buff[-1]= (char) group->field->is_null();
+  }
+}
+
+
 /*
   @brief
     Perform GROUP BY operation over rows coming in arbitrary order: use
@@ -25705,7 +26216,6 @@ end_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
 	   bool end_of_records)
 {
   TABLE *const table= join_tab->table;
-  ORDER   *group;
   int	  error;
   DBUG_ENTER("end_update");
 
@@ -25714,24 +26224,7 @@ end_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
 
   join->found_records++;
   copy_fields(join_tab->tmp_table_param);	// Groups are copied twice.
-  /* Make a key of group index */
-  for (group=table->group ; group ; group=group->next)
-  {
-    Item *item= *group->item;
-    if (group->fast_field_copier_setup != group->field)
-    {
-      DBUG_PRINT("info", ("new setup %p -> %p",
-                          group->fast_field_copier_setup,
-                          group->field));
-      group->fast_field_copier_setup= group->field;
-      group->fast_field_copier_func=
-        item->setup_fast_field_copier(group->field);
-    }
-    item->save_org_in_field(group->field, group->fast_field_copier_func);
-    /* Store in the used key if the field was 0 */
-    if (item->maybe_null())
-      group->buff[-1]= (char) group->field->is_null();
-  }
+  make_group_key(table);
   if (!table->file->ha_index_read_map(table->record[1],
                                       join_tab->tmp_table_param->group_buff,
                                       HA_WHOLE_KEY,
@@ -25848,6 +26341,126 @@ end_unique_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
 }
 
 
+/**
+  Write the groups collected in join_tab->aggr->group_hash into the tmp table
+
+  @param[out] next_func  The write function for the rows that are not
+                         collected in the hash any more
+
+  @details
+    If the HEAP table gets full it is converted to a disk based table and
+    the remaining groups are written into that one.
+
+  @retval FALSE  ok
+  @retval TRUE   error
+*/
+
+static bool flush_group_hash(JOIN *join, JOIN_TAB *join_tab,
+                             Next_select_func *next_func)
+{
+  TABLE *const table= join_tab->table;
+  Group_hash *hash= join_tab->aggr->group_hash;
+  bool converted= false;
+  int error;
+  DBUG_ENTER("flush_group_hash");
+
+  for (uchar *rec= hash->first_record(); rec; rec= hash->next_record(rec))
+  {
+    memcpy(table->record[0], rec, table->s->reclength);
+    if (unlikely((error= table->file->ha_write_tmp_row(table->record[0]))))
+    {
+      if (create_internal_tmp_table_from_heap(join->thd, table,
+                                       join_tab->tmp_table_param->start_recinfo,
+                                              &join_tab->tmp_table_param->recinfo,
+                                              error, 0, NULL))
+        DBUG_RETURN(true);                  // Not a table_is_full error
+      converted= true;
+    }
+  }
+  hash->reset();
+
+  if (converted)
+  {
+    if (unlikely((error= table->file->ha_index_init(0, 0))))
+    {
+      table->file->print_error(error, MYF(0));
+      DBUG_RETURN(true);
+    }
+  }
+  *next_func= (converted || table->s->have_unique_constraint()) ?
+              end_unique_update : end_update;
+  DBUG_RETURN(false);
+}
+
+
+/**
+  Like end_update, but the groups are collected in a Group_hash and written
+  into the tmp table at the end of records
+
+  @details
+    When a new group does not fit into the memory of the hash, the groups
+    collected so far are written into the tmp table and the rest of the rows
+    are handled by end_update().
+
+  @seealso Group_hash
+*/
+
+static enum_nested_loop_state
+end_hash_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records)
+{
+  TABLE *const table= join_tab->table;
+  TMP_TABLE_PARAM *const tmp_table_param= join_tab->tmp_table_param;
+  Group_hash *const hash= join_tab->aggr->group_hash;
+  Next_select_func next_func;
+  uchar *rec;
+  DBUG_ENTER("end_hash_update");
+
+  if (end_of_records)
+    DBUG_RETURN(flush_group_hash(join, join_tab, &next_func) ?
+                NESTED_LOOP_ERROR : NESTED_LOOP_OK);
+
+  copy_fields(tmp_table_param);                 // Groups are copied twice.
+  make_group_key(table);
+  ulong hash_value= hash->hash_key(tmp_table_param->group_buff);
+  if ((rec= hash->find(tmp_table_param->group_buff, hash_value)))
+  {
+    /* Update the group in the hash */
+    memcpy(table->record[0], rec, table->s->reclength);
+    update_tmptable_sum_func(join->sum_funcs, table);
+    memcpy(rec, table->record[0], table->s->reclength);
+  }
+  else
+  {
+    if (hash->is_full())
+    {
+      /* Out of memory for the hash: continue in the tmp table */
+      if (flush_group_hash(join, join_tab, &next_func))
+        DBUG_RETURN(NESTED_LOOP_ERROR);
+      if (hash->tracker)
+        hash->tracker->on_spill();
+      join_tab->aggr->set_write_func(next_func);
+      DBUG_RETURN((*next_func)(join, join_tab, end_of_records));
+    }
+    init_tmptable_sum_functions(join->sum_funcs);
+    if (unlikely(copy_funcs(tmp_table_param->items_to_copy, join->thd)))
+      DBUG_RETURN(NESTED_LOOP_ERROR);           /* purecov: inspected */
+    if (unlikely(!hash->insert(tmp_table_param->group_buff, hash_value,
+                               table->record[0])))
+      DBUG_RETURN(NESTED_LOOP_ERROR);           /* purecov: inspected */
+    if (hash->tracker)
+      hash->tracker->on_group();
+    join_tab->send_records++;
+  }
+  join->found_records++;
+  join->accepted_rows++;                        // For rownum()
+  if (unlikely(join->thd->check_killed()))
+  {
+    DBUG_RETURN(NESTED_LOOP_KILLED);             /* purecov: inspected */
+  }
+  DBUG_RETURN(NESTED_LOOP_OK);
+}
+
+
 /*
   @brief
     Perform OrderedGroupBy operation and write the output into the temporary
@@ -30448,6 +31061,8 @@ bool JOIN_TAB::save_explain_data(Explain_table_access *eta,
   jbuf_tracker= &eta->jbuf_tracker;
   jbuf_loops_tracker= &eta->jbuf_loops_tracker;
   jbuf_unpack_tracker= &eta->jbuf_unpack_tracker;
+  jbuf_spill_tracker= &eta->jbuf_spill_tracker;
+  jbuf_bloom_tracker= &eta->jbuf_bloom_tracker;
 
   /* Enable the table access time tracker only for "ANALYZE stmt" */
   if (unlikely(thd->lex->analyze_stmt ||
@@ -30924,9 +31539,15 @@ bool save_agg_explain_data(JOIN *join, Explain_select *xpl_sel)
   {
     // Each aggregate means a temp.table
     prev_node= node;
-    if (!(node= new (thd->mem_root) Explain_aggr_tmp_table))
+    Explain_aggr_tmp_table *tmp_node;
+    if (!(node= tmp_node= new (thd->mem_root) Explain_aggr_tmp_table))
       return 1;
     node->child= prev_node;
+    if (join_tab->aggr && join_tab->aggr->group_hash)
+    {
+      tmp_node->hash_group= true;
+      join_tab->aggr->group_hash->tracker= &tmp_node->hash_tracker;
+    }
 
     if (join_tab->window_funcs_step)
     {
@@ -33114,6 +33735,12 @@ AGGR_OP::prepare_tmp_table()
       return true;
     (void) table->file->extra(HA_EXTRA_WRITE_CACHE);
   }
+  if (group_hash)
+  {
+    /* Start collecting the groups in the hash again */
+    group_hash->reset();
+    write_func= end_hash_update;
+  }
   /* If it wasn't already, start index scan for grouping using table index. */
   if (!table->file->inited && table->group &&
       join_tab->tmp_table_param->sum_func_count && table->s->keys)
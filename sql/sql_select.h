@@ -253,6 +253,8 @@ class AGGR_OP;
 class Filesort;
 struct SplM_plan_info;
 class SplM_opt_info;
+class Batch_filter;
+class Group_hash;
 
 typedef struct st_join_table {
   TABLE		*table;
@@ -315,6 +317,8 @@ typedef struct st_join_table {
   Table_access_tracker *jbuf_tracker;
   Time_and_counter_tracker *jbuf_unpack_tracker;
   Counter_tracker  *jbuf_loops_tracker;
+  Join_spill_tracker *jbuf_spill_tracker;
+  Join_bloom_tracker *jbuf_bloom_tracker;
 
   //  READ_RECORD::Setup_func materialize_table;
   READ_RECORD::Setup_func read_first_record;
@@ -450,6 +454,11 @@ typedef struct st_join_table {
   /* TRUE <=> it is prohibited to join this table using join buffer */
   bool          no_forced_join_cache;
   uint          used_join_cache_level;
+  /*
+    >0 <=> the optimizer has chosen to let the hashed join cache spill its
+    records into this number of partition files rather than to refill it
+  */
+  uint          hash_join_partitions;
   JOIN_CACHE	*cache;
   /*
     Index condition for BKA access join
@@ -597,6 +606,20 @@ typedef struct st_join_table {
   bool build_range_rowid_filter();
   void clear_range_rowid_filter();
 
+  /* Batch pre-filter for the attached condition, see sql_batch_filter.h */
+  Batch_filter *batch_filter;
+  /* True if a batch filter may be used and it's not built yet */
+  bool need_to_build_batch_filter;
+
+  bool build_batch_filter();
+
+  /* Buffer for reading a table scan in batches (@@scan_batch_rows) */
+  uchar *scan_batch_buf;
+  /* Rows in scan_batch_buf, 0 if the scan is read row by row */
+  uint scan_batch_rows;
+
+  void init_scan_batch();
+
   void cleanup();
   inline bool is_using_loose_index_scan()
   {
@@ -1102,6 +1125,8 @@ class POSITION
   Sj_materialization_picker sjmat_picker;
 
   ulonglong refills;
+  /* Number of partitions to spill the hash join operands to, 0 if none */
+  uint hash_join_partitions;
   /*
     Current optimization state: Semi-join strategy to be used for this
     and preceding join tables.
@@ -1181,8 +1206,10 @@ class AGGR_OP :public Sql_alloc
 {
 public:
   JOIN_TAB *join_tab;
+  /* Collects the groups before they are written into the tmp table */
+  Group_hash *group_hash;
 
-  AGGR_OP(JOIN_TAB *tab) : join_tab(tab), write_func(NULL)
+  AGGR_OP(JOIN_TAB *tab) : join_tab(tab), group_hash(NULL), write_func(NULL)
   {};
 
   enum_nested_loop_state put_record() { return put_record(false); };
@@ -2026,6 +2053,10 @@ bool simple_pred(Item_func *func_item, Item **args, bool *inv_order);
 int opt_sum_query(THD* thd,
                   List<TABLE_LIST> &tables, List<Item> &all_fields, COND *conds);
 
+/* from opt_parallel_sum.cc */
+int opt_parallel_sum_query(JOIN *join);
+void parallel_sum_decimal(longlong sum_hi, ulonglong sum_lo, my_decimal *to);
+
 /* from sql_delete.cc, used by opt_range.cc */
 extern "C" int refpos_order_cmp(void* arg, const void *a,const void *b);
 
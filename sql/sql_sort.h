@@ -31,6 +31,12 @@ struct TABLE;
 #define MERGEBUFF		7
 #define MERGEBUFF2		15
 
+/*
+  Minimal number of keys of a sort buffer that is worth sorting by a
+  separate thread, see Sort_param::max_threads
+*/
+#define MIN_SORT_KEYS_PER_THREAD 8192
+
 /*
    The structure SORT_ADDON_FIELD describes a fixed layout
    for field values appended to sorted values in records to be sorted
@@ -576,6 +582,11 @@ class Sort_param {
 
   uchar *unique_buff;
   bool not_killable;
+  /*
+    Maximal number of threads that may sort the sort buffer and merge the
+    sorted chunks (@@max_sort_threads). 0 or 1 means no parallelism.
+  */
+  uint max_threads;
   String tmp_buffer;
   // The fields below are used only by Unique class.
   qsort2_cmp compare;
@@ -22,6 +22,7 @@
 #include "filesort.h"
 #include "sql_base.h"
 #include "sql_window.h"
+#include "sql_parallel.h"
 
 
 bool
@@ -2287,6 +2288,235 @@ class Frame_scan_cursor : public Frame_cursor
   }
 };
 
+/*
+  A cursor that computes MIN or MAX over the rows between the top and the
+  bottom bound of the frame without rescanning the frame for every row.
+
+  The cursor keeps a deque of the rows of the frame that can still become
+  the minimum (maximum) of a later frame: the row numbers in the deque are
+  increasing and the values are strictly increasing (decreasing), so the
+  front of the deque is the minimum (maximum) of the current frame.
+  When the bottom bound moves, the new rows are appended at the back after
+  removing the rows whose values are not smaller (larger) than theirs.
+  When the top bound moves, the rows that left the frame are removed from
+  the front. Every row of the partition is read and compared a constant
+  number of times on the average, instead of once for every row of every
+  frame it belongs to.
+
+  The values of the rows in the deque are kept in Item_cache objects that
+  are reused as the rows enter and leave the deque. NULL values are never
+  the result of MIN or MAX and are not put into the deque.
+
+  NOTE:
+    The cursor does not alter the top and bottom cursors, like
+    Frame_scan_cursor does.
+*/
+class Frame_min_max_cursor : public Frame_cursor
+{
+public:
+  Frame_min_max_cursor(THD *thd,
+                       const Frame_cursor &top_bound,
+                       const Frame_cursor &bottom_bound,
+                       Item_sum_min_max *item_sum) :
+    top_bound(top_bound), bottom_bound(bottom_bound), thd(thd),
+    item_sum(item_sum), arg(item_sum->get_arg(0)),
+    sign(item_sum->sum_func() == Item_sum::MIN_FUNC ? 1 : -1),
+    entries(NULL), capacity(0), head(0), size(0), next_rownum(0)
+  {
+    add_sum_func(item_sum);
+  }
+
+  ~Frame_min_max_cursor() override
+  {
+    my_free(entries);
+  }
+
+  void init(READ_RECORD *info) override
+  {
+    cursor.init(info);
+  }
+
+  void pre_next_partition(ha_rows rownum) override
+  {
+    curr_rownum= rownum;
+    next_rownum= rownum;
+    head= size= 0;
+    clear_sum_functions();
+  }
+
+  void next_partition(ha_rows rownum) override
+  {
+    compute_values_for_current_row();
+  }
+
+  void pre_next_row() override
+  {
+    clear_sum_functions();
+  }
+
+  void next_row() override
+  {
+    curr_rownum++;
+    compute_values_for_current_row();
+  }
+
+  ha_rows get_curr_rownum() const override
+  {
+    return curr_rownum;
+  }
+
+private:
+  struct Entry
+  {
+    ha_rows rownum;
+    Item_cache *value;
+  };
+
+  const Frame_cursor &top_bound;
+  const Frame_cursor &bottom_bound;
+  Table_read_cursor cursor;
+  ha_rows curr_rownum;
+  THD *thd;
+  Item_sum_min_max *item_sum;
+  /* The argument of MIN/MAX */
+  Item *arg;
+  /* 1 for MIN, -1 for MAX */
+  int sign;
+
+  /*
+    The deque is a circular buffer of 'capacity' entries, a power of two,
+    that starts at the entry 'head' and has 'size' entries.
+  */
+  Entry *entries;
+  size_t capacity;
+  size_t head;
+  size_t size;
+  /* The number of the first row that has not been added to the deque */
+  ha_rows next_rownum;
+
+  /* Compare the values of two entries */
+  Item_cache *cmp_value1, *cmp_value2;
+  Arg_comparator cmp;
+
+  Entry *entry(size_t i) { return entries + ((head + i) & (capacity - 1)); }
+
+  /* Make space for one more entry at the back of the deque */
+  bool reserve()
+  {
+    if (size < capacity)
+      return false;
+    size_t new_capacity= capacity ? capacity * 2 : 64;
+    Entry *new_entries= (Entry*) my_malloc(PSI_INSTRUMENT_ME,
+                                           new_capacity * sizeof(Entry),
+                                           MYF(MY_WME));
+    if (!new_entries)
+      return true;
+    for (size_t i= 0; i < capacity; i++)
+      new_entries[i]= *entry(i);
+    for (size_t i= capacity; i < new_capacity; i++)
+    {
+      new_entries[i].value= arg->get_cache(thd);
+      if (!new_entries[i].value)
+      {
+        my_free(new_entries);
+        return true;
+      }
+      new_entries[i].value->setup(thd, arg);
+      /* Don't cache the value, as it will change */
+      if (!arg->const_item())
+        new_entries[i].value->set_used_tables(RAND_TABLE_BIT);
+    }
+    if (!entries)
+    {
+      /* Set up the comparison of the values of the entries */
+      cmp_value1= new_entries[0].value;
+      cmp_value2= new_entries[1].value;
+      if (cmp.set_cmp_func(thd, item_sum, arg->type_handler_for_comparison(),
+                           (Item**) &cmp_value1, (Item**) &cmp_value2,
+                           FALSE))
+      {
+        my_free(new_entries);
+        return true;
+      }
+    }
+    my_free(entries);
+    entries= new_entries;
+    capacity= new_capacity;
+    head= 0;
+    return false;
+  }
+
+  /* Add the row that has been fetched into record[0] to the deque */
+  bool add_row(ha_rows rownum)
+  {
+    if (reserve())
+      return true;
+    Entry *last= entry(size);
+    last->value->store(arg);
+    last->value->cache_value();
+    if (last->value->null_value)
+      return false;
+    cmp_value2= last->value;
+    while (size)
+    {
+      cmp_value1= entry(size - 1)->value;
+      if (cmp.compare() * sign < 0)
+        break;
+      /* The back entry can not be the result anymore, reuse its value */
+      Entry *back= entry(size - 1);
+      swap_variables(Item_cache*, back->value, last->value);
+      last= back;
+      size--;
+    }
+    last->rownum= rownum;
+    size++;
+    return false;
+  }
+
+  void compute_values_for_current_row()
+  {
+    if (top_bound.is_outside_computation_bounds() ||
+        bottom_bound.is_outside_computation_bounds())
+      return;
+
+    ha_rows start_rownum= top_bound.get_curr_rownum();
+    ha_rows bottom_rownum= bottom_bound.get_curr_rownum();
+    DBUG_PRINT("info", ("COMPUTING (%llu %llu)", start_rownum, bottom_rownum));
+
+    set_if_bigger(next_rownum, start_rownum);
+    if (next_rownum <= bottom_rownum)
+    {
+      cursor.move_to(next_rownum);
+      for (; next_rownum <= bottom_rownum; next_rownum++)
+      {
+        if (cursor.fetch()) //EOF
+          break;
+        if (add_row(next_rownum))
+          return;
+        if (cursor.next()) // EOF
+        {
+          next_rownum++;
+          break;
+        }
+      }
+    }
+
+    /* Remove the rows that are above the top of the frame */
+    while (size && entries[head].rownum < start_rownum)
+    {
+      head= (head + 1) & (capacity - 1);
+      size--;
+    }
+
+    if (size)
+    {
+      item_sum->direct_add(entries[head].value);
+      item_sum->add();
+    }
+  }
+};
+
+
 /* A cursor that follows a target cursor. Each time a new row is added,
    the window functions are cleared and only have the row at which the target
    is point at added to them.
@@ -2676,6 +2906,22 @@ static bool is_computed_with_remove(Item_sum::Sumfunctype sum_func)
       return true;
   }
 }
+
+/*
+  Check whether the top bound of the frame is UNBOUNDED PRECEDING, that is,
+  whether rows never leave the frame until the end of the partition
+*/
+static bool is_frame_top_unbounded(Window_spec *spec)
+{
+  Window_frame *frame= spec->window_frame;
+  /* No frame clause means RANGE BETWEEN UNBOUNDED PRECEDING AND CURRENT ROW */
+  if (!frame)
+    return true;
+  return (frame->top_bound->precedence_type ==
+          Window_frame_bound::PRECEDING &&
+          frame->top_bound->offset == NULL);
+}
+
 /*
    Create required frame cursors for the list of window functions.
    Register all functions to their appropriate cursors.
@@ -2754,14 +3000,28 @@ void get_window_functions_required_cursors(
     */
     cursor_manager->add_cursor(frame_bottom);
     cursor_manager->add_cursor(frame_top);
+    /*
+      Functions that do not support removal are recomputed for every row,
+      unless the top of the frame never moves within the partition: then
+      the rows are only added, and the regular cursors suffice.
+      MIN and MAX are computed with a deque of the candidate rows.
+    */
     if (is_computed_with_remove(sum_func->sum_func()) &&
-        !sum_func->supports_removal())
+        !sum_func->supports_removal() &&
+        !is_frame_top_unbounded(item_win_func->window_spec))
     {
       frame_bottom->set_no_action();
       frame_top->set_no_action();
-      Frame_cursor *scan_cursor= new Frame_scan_cursor(*frame_top,
-                                                       *frame_bottom);
-      scan_cursor->add_sum_func(sum_func);
+      Frame_cursor *scan_cursor;
+      if (sum_func->sum_func() == Item_sum::MIN_FUNC ||
+          sum_func->sum_func() == Item_sum::MAX_FUNC)
+        scan_cursor= new Frame_min_max_cursor(thd, *frame_top, *frame_bottom,
+                                              (Item_sum_min_max*) sum_func);
+      else
+      {
+        scan_cursor= new Frame_scan_cursor(*frame_top, *frame_bottom);
+        scan_cursor->add_sum_func(sum_func);
+      }
       cursor_manager->add_cursor(scan_cursor);
 
     }
@@ -2769,6 +3029,8 @@ void get_window_functions_required_cursors(
   }
 }
 
+static bool update_window_function_row(TABLE *tbl);
+
 /**
   Helper function that takes a list of window functions and writes
   their values in the current table record.
@@ -2778,12 +3040,24 @@ bool save_window_function_values(List<Item_window_func>& window_functions,
                                  TABLE *tbl, uchar *rowid_buf)
 {
   List_iterator_fast<Item_window_func> iter(window_functions);
-  JOIN_TAB *join_tab= tbl->reginfo.join_tab;
   tbl->file->ha_rnd_pos(tbl->record[0], rowid_buf);
   store_record(tbl, record[1]);
   while (Item_window_func *item_win= iter++)
     item_win->save_in_field(item_win->result_field, true);
 
+  return update_window_function_row(tbl);
+}
+
+
+/*
+  Write the row in tbl->record[0], which has new values of window functions,
+  to the temporary table. tbl->record[1] is the row before the change.
+*/
+
+static bool update_window_function_row(TABLE *tbl)
+{
+  JOIN_TAB *join_tab= tbl->reginfo.join_tab;
+
   /*
     In case we have window functions present, an extra step is required
     to compute all the fields from the temporary table.
@@ -2956,6 +3230,627 @@ bool compute_window_func(THD *thd,
   return ret;
 }
 
+
+/////////////////////////////////////////////////////////////////////////////
+// Parallel computation of window functions
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+  When @@max_window_threads > 1, the window functions of a
+  Window_func_runner are computed by several threads if all of them are
+  among
+
+    ROW_NUMBER(), RANK(), DENSE_RANK(),
+    COUNT(*), COUNT(col), SUM(col), MIN(col), MAX(col)
+
+  where col is an integer column (except BIGINT UNSIGNED), all have a
+  PARTITION BY clause, and all frames end either at the current row or at
+  the end of the partition:
+
+    <no frame clause>
+    {ROWS | RANGE} BETWEEN UNBOUNDED PRECEDING AND CURRENT ROW
+    {ROWS | RANGE} BETWEEN UNBOUNDED PRECEDING AND UNBOUNDED FOLLOWING
+
+  The connection thread reads the sorted rows, notes where partitions and
+  peer groups start and copies the arguments into a batch. The batch is
+  cut at the last row that starts a partition of every function, the rows
+  before it are split into tasks made of whole partitions, and the tasks
+  compute the values of the window functions for their rows. The
+  connection thread then writes the values to the temporary table, and
+  carries the rows after the cut over to the next batch.
+
+  A batch that has no cut grows up to @@sort_buffer_size bytes (at least
+  WINDOW_PARALLEL_BATCH_ROWS rows). If a partition does not fit even then,
+  the job stops, and the window functions of all rows are computed again
+  by the connection thread.
+
+  The worker threads are taken from the pool of sql_parallel.cc, so that
+  the threads of one batch are reused for the next ones.
+
+  The handler of the temporary table and the items are only used by the
+  connection thread, the worker threads work on the arrays of the batch.
+*/
+
+/* The least number of rows per thread */
+#define WINDOW_PARALLEL_MIN_ROWS_PER_THREAD 1000
+/* Number of rows of the first batch, and the least limit of a batch */
+#define WINDOW_PARALLEL_BATCH_ROWS 65536
+
+/* Flags of a row in Window_parallel_func::flags */
+#define WINDOW_PARTITION_START 1
+#define WINDOW_PEER_START      2
+#define WINDOW_ARG_NULL        4
+
+/* Value of a window function for one row */
+
+struct Window_parallel_value
+{
+  ulonglong count;      /* The result of COUNT() and of ranking functions */
+  ulonglong sum_lo;     /* SUM() as sum_hi * 2^64 + sum_lo */
+  longlong sum_hi;
+  longlong value;       /* MIN() or MAX() */
+};
+
+
+struct Window_parallel_func
+{
+  Item_window_func *item;
+  Item_sum::Sumfunctype func;
+  /* The argument, NULL for ranking functions and COUNT(*) */
+  Field *arg;
+  /*
+    The frame ends at the current row (ROWS), at the last peer of the
+    current row (RANGE), or at the end of the partition.
+  */
+  enum { FRAME_ROWS, FRAME_PEERS, FRAME_PARTITION } frame;
+  Group_bound_tracker *partition_tracker;
+  Group_bound_tracker *peer_tracker;
+
+  /* The rows of the batch */
+  uchar *flags;
+  longlong *args;
+  Window_parallel_value *values;
+};
+
+
+class Window_parallel_job : public Parallel_job
+{
+public:
+  Window_parallel_job() : funcs(NULL), n_funcs(0), ref_length(0),
+    rowids(NULL), boundaries(NULL), n_rows(0), max_rows(0),
+    max_batch_rows(0) {}
+  ~Window_parallel_job();
+
+  bool init(THD *thd, List<Item_window_func> &window_functions, TABLE *tbl);
+  bool exec(THD *thd, TABLE *tbl, SORT_INFO *filesort_result,
+            uint n_threads, bool *done);
+  void run_task(uint task, uint worker) override;
+
+private:
+  bool alloc_rows(ha_rows rows);
+  void read_row(TABLE *tbl);
+  ha_rows last_boundary() const;
+  void compute(THD *thd, ha_rows end, uint n_threads);
+  bool save_rows(TABLE *tbl, ha_rows end);
+  void remove_rows(ha_rows end);
+  void compute_func(Window_parallel_func *f, ha_rows start, ha_rows end);
+
+  Window_parallel_func *funcs;
+  uint n_funcs;
+  uint ref_length;
+  uchar *rowids;
+  /* TRUE for the rows that start a partition of every function */
+  bool *boundaries;
+  ha_rows n_rows, max_rows;
+  /* The batch may not grow beyond this */
+  ha_rows max_batch_rows;
+  /* Task i computes the rows from task_start[i] to task_start[i + 1] */
+  ha_rows task_start[MAX_PARALLEL_JOB_THREADS * 4 + 1];
+};
+
+
+Window_parallel_job::~Window_parallel_job()
+{
+  for (uint i= 0; i < n_funcs; i++)
+  {
+    Window_parallel_func *f= funcs + i;
+    delete f->partition_tracker;
+    delete f->peer_tracker;
+    my_free(f->flags);
+    my_free(f->args);
+    my_free(f->values);
+  }
+  my_free(rowids);
+  my_free(boundaries);
+}
+
+
+/*
+  Check if the window functions can be computed by several threads, and
+  prepare their computation.
+
+  @return FALSE if they can not
+*/
+
+bool Window_parallel_job::init(THD *thd,
+                               List<Item_window_func> &window_functions,
+                               TABLE *tbl)
+{
+  List_iterator_fast<Item_window_func> it(window_functions);
+  Item_window_func *win_func;
+
+  if (!(funcs= (Window_parallel_func *)
+        thd->calloc(sizeof(Window_parallel_func) * window_functions.elements)))
+    return false;
+
+  while ((win_func= it++))
+  {
+    Window_parallel_func *f= funcs + n_funcs;
+    Window_spec *spec= win_func->window_spec;
+    Window_frame *frame= spec->window_frame;
+    Item_sum *sum_func= win_func->window_func();
+
+    if (!spec->partition_list->elements)
+      return false;
+
+    f->item= win_func;
+    f->func= sum_func->sum_func();
+    f->arg= NULL;
+    switch (f->func) {
+    case Item_sum::ROW_NUMBER_FUNC:
+    case Item_sum::RANK_FUNC:
+    case Item_sum::DENSE_RANK_FUNC:
+      break;
+    case Item_sum::COUNT_FUNC:
+    case Item_sum::SUM_FUNC:
+    case Item_sum::MIN_FUNC:
+    case Item_sum::MAX_FUNC:
+    {
+      Item *arg= sum_func->get_arg(0);
+      if (f->func == Item_sum::COUNT_FUNC && arg->const_item() &&
+          !arg->is_expensive() && !arg->maybe_null())
+        break;                                  // COUNT(*)
+      Item *real= arg->real_item();
+      if (real->type() != Item::FIELD_ITEM)
+        return false;
+      Field *field= ((Item_field *) real)->field;
+      if (field->table != tbl)
+        return false;
+      switch (field->real_type()) {
+      case MYSQL_TYPE_TINY:
+      case MYSQL_TYPE_SHORT:
+      case MYSQL_TYPE_INT24:
+      case MYSQL_TYPE_LONG:
+        break;
+      case MYSQL_TYPE_LONGLONG:
+        if (((Field_num *) field)->unsigned_flag)
+          return false;
+        break;
+      default:
+        return false;
+      }
+      if (f->func == Item_sum::SUM_FUNC &&
+          sum_func->result_type() != DECIMAL_RESULT)
+        return false;
+      f->arg= field;
+      break;
+    }
+    default:
+      return false;
+    }
+
+    if (!frame)
+      f->frame= Window_parallel_func::FRAME_PEERS;
+    else if (!is_frame_top_unbounded(spec) ||
+             frame->exclusion != Window_frame::EXCL_NONE)
+      return false;
+    else if (frame->bottom_bound->precedence_type ==
+             Window_frame_bound::CURRENT)
+      f->frame= frame->units == Window_frame::UNITS_ROWS ?
+                Window_parallel_func::FRAME_ROWS :
+                Window_parallel_func::FRAME_PEERS;
+    else if (frame->bottom_bound->precedence_type ==
+             Window_frame_bound::FOLLOWING &&
+             frame->bottom_bound->is_unbounded())
+      f->frame= Window_parallel_func::FRAME_PARTITION;
+    else
+      return false;
+
+    n_funcs++;
+    f->partition_tracker= new Group_bound_tracker(thd, spec->partition_list);
+    f->partition_tracker->init();
+    bool is_ranking= !f->arg && f->func != Item_sum::COUNT_FUNC;
+    if (is_ranking ? f->func != Item_sum::ROW_NUMBER_FUNC :
+                     f->frame == Window_parallel_func::FRAME_PEERS)
+    {
+      f->peer_tracker= new Group_bound_tracker(thd, spec->order_list);
+      f->peer_tracker->init();
+    }
+  }
+
+  ref_length= tbl->file->ref_length;
+  size_t row_size= ref_length + sizeof(bool) +
+                   n_funcs * (1 + sizeof(longlong) +
+                              sizeof(Window_parallel_value));
+  max_batch_rows= MY_MAX(thd->variables.sortbuff_size / row_size,
+                         WINDOW_PARALLEL_BATCH_ROWS);
+  return !alloc_rows(WINDOW_PARALLEL_BATCH_ROWS);
+}
+
+
+/*
+  Make room for 'rows' rows in the batch. On failure, the arrays that
+  could not be reallocated are freed.
+*/
+
+bool Window_parallel_job::alloc_rows(ha_rows rows)
+{
+  myf flags= MYF(MY_WME | MY_ALLOW_ZERO_PTR | MY_FREE_ON_ERROR);
+  if (!(rowids= (uchar *) my_realloc(PSI_INSTRUMENT_ME, rowids,
+                                     (size_t) rows * ref_length, flags)) ||
+      !(boundaries= (bool *) my_realloc(PSI_INSTRUMENT_ME, boundaries,
+                                        (size_t) rows * sizeof(bool), flags)))
+    return true;
+  for (uint i= 0; i < n_funcs; i++)
+  {
+    Window_parallel_func *f= funcs + i;
+    if (!(f->flags= (uchar *) my_realloc(PSI_INSTRUMENT_ME, f->flags,
+                                         (size_t) rows, flags)) ||
+        !(f->args= (longlong *) my_realloc(PSI_INSTRUMENT_ME, f->args,
+                                           (size_t) rows * sizeof(longlong),
+                                           flags)) ||
+        !(f->values= (Window_parallel_value *)
+          my_realloc(PSI_INSTRUMENT_ME, f->values,
+                     (size_t) rows * sizeof(Window_parallel_value), flags)))
+      return true;
+  }
+  max_rows= rows;
+  return false;
+}
+
+
+/* Add the row in tbl->record[0] to the batch */
+
+void Window_parallel_job::read_row(TABLE *tbl)
+{
+  tbl->file->position(tbl->record[0]);
+  memcpy(rowids + n_rows * ref_length, tbl->file->ref, ref_length);
+
+  bool boundary= true;
+  for (uint i= 0; i < n_funcs; i++)
+  {
+    Window_parallel_func *f= funcs + i;
+    uchar flags= 0;
+    /* Both trackers must see every row to remember its values */
+    if (f->partition_tracker->check_if_next_group())
+      flags|= WINDOW_PARTITION_START | WINDOW_PEER_START;
+    else
+      boundary= false;
+    if (f->peer_tracker && f->peer_tracker->check_if_next_group())
+      flags|= WINDOW_PEER_START;
+    if (f->arg)
+    {
+      if (f->arg->is_null())
+        flags|= WINDOW_ARG_NULL;
+      else
+        f->args[n_rows]= f->arg->val_int();
+    }
+    f->flags[n_rows]= flags;
+  }
+  boundaries[n_rows]= boundary;
+  n_rows++;
+}
+
+
+/* The last row of the batch, except the first one, that is a boundary */
+
+ha_rows Window_parallel_job::last_boundary() const
+{
+  for (ha_rows row= n_rows - 1; row > 0; row--)
+  {
+    if (boundaries[row])
+      return row;
+  }
+  return 0;
+}
+
+
+/* Compute the values of the first 'end' rows of the batch */
+
+void Window_parallel_job::compute(THD *thd, ha_rows end, uint n_threads)
+{
+  uint n_tasks= 0;
+  ha_rows row= 0;
+
+  set_if_smaller(n_threads, MAX_PARALLEL_JOB_THREADS);
+  uint max_tasks= n_threads * 4;
+  ha_rows task_rows= (end + max_tasks - 1) / max_tasks;
+
+  /* Every task starts at a boundary, and has at least task_rows rows */
+  while (row < end)
+  {
+    task_start[n_tasks++]= row;
+    ha_rows next= row + task_rows;
+    for (row= MY_MIN(next, end); row < end && !boundaries[row]; row++)
+    {}
+  }
+  task_start[n_tasks]= end;
+
+  if (n_tasks < 2 || run_parallel_job(thd, this, n_tasks, n_threads))
+  {
+    for (uint task= 0; task < n_tasks; task++)
+      run_task(task, 0);
+  }
+}
+
+
+void Window_parallel_job::run_task(uint task, uint worker)
+{
+  for (uint i= 0; i < n_funcs; i++)
+    compute_func(funcs + i, task_start[task], task_start[task + 1]);
+}
+
+
+/*
+  Compute the values of one function for the rows from 'start' to 'end',
+  which is a range of whole partitions of the function.
+*/
+
+void Window_parallel_job::compute_func(Window_parallel_func *f,
+                                       ha_rows start, ha_rows end)
+{
+  Window_parallel_value state;
+
+  if (!f->arg && f->func != Item_sum::COUNT_FUNC)
+  {
+    /* ROW_NUMBER(), RANK(), DENSE_RANK() */
+    ulonglong row_number= 0, rank= 0, dense_rank= 0;
+    for (ha_rows row= start; row < end; row++)
+    {
+      uchar flags= f->flags[row];
+      if (flags & WINDOW_PARTITION_START)
+        row_number= rank= dense_rank= 0;
+      row_number++;
+      if (flags & WINDOW_PEER_START)
+      {
+        rank= row_number;
+        dense_rank++;
+      }
+      f->values[row].count= f->func == Item_sum::ROW_NUMBER_FUNC ?
+                            row_number :
+                            f->func == Item_sum::RANK_FUNC ? rank :
+                            dense_rank;
+    }
+    return;
+  }
+
+  uchar end_mask= f->frame == Window_parallel_func::FRAME_PARTITION ?
+                  WINDOW_PARTITION_START : WINDOW_PEER_START;
+  for (ha_rows row= start; row < end; )
+  {
+    if (f->flags[row] & WINDOW_PARTITION_START)
+      memset(&state, 0, sizeof(state));
+
+    /* Add the rows that enter the frame along with this one */
+    ha_rows last= row + 1;
+    if (f->frame != Window_parallel_func::FRAME_ROWS)
+    {
+      while (last < end && !(f->flags[last] & end_mask))
+        last++;
+    }
+    for (ha_rows r= row; r < last; r++)
+    {
+      if (f->flags[r] & WINDOW_ARG_NULL)
+        continue;
+      if (f->arg)
+      {
+        longlong value= f->args[r];
+        ulonglong lo= state.sum_lo + (ulonglong) value;
+        if (value >= 0)
+          state.sum_hi+= lo < state.sum_lo;
+        else
+          state.sum_hi-= lo > state.sum_lo;
+        state.sum_lo= lo;
+        if (!state.count ||
+            (f->func == Item_sum::MIN_FUNC && value < state.value) ||
+            (f->func == Item_sum::MAX_FUNC && value > state.value))
+          state.value= value;
+      }
+      state.count++;
+    }
+    for (; row < last; row++)
+      f->values[row]= state;
+  }
+}
+
+
+/* Write the values of the first 'end' rows of the batch to the table */
+
+bool Window_parallel_job::save_rows(TABLE *tbl, ha_rows end)
+{
+  for (ha_rows row= 0; row < end; row++)
+  {
+    if (tbl->file->ha_rnd_pos(tbl->record[0], rowids + row * ref_length))
+      return true;
+    store_record(tbl, record[1]);
+    for (uint i= 0; i < n_funcs; i++)
+    {
+      Window_parallel_func *f= funcs + i;
+      const Window_parallel_value *value= f->values + row;
+      Field *to= f->item->result_field;
+
+      switch (f->func) {
+      case Item_sum::SUM_FUNC:
+      case Item_sum::MIN_FUNC:
+      case Item_sum::MAX_FUNC:
+        if (!value->count)
+        {
+          to->set_null();
+          continue;
+        }
+        to->set_notnull();
+        if (f->func == Item_sum::SUM_FUNC)
+        {
+          my_decimal sum;
+          if (value->sum_hi == ((longlong) value->sum_lo < 0 ? -1 : 0))
+            int2my_decimal(E_DEC_FATAL_ERROR, (longlong) value->sum_lo, FALSE,
+                           &sum);
+          else
+            parallel_sum_decimal(value->sum_hi, value->sum_lo, &sum);
+          to->store_decimal(&sum);
+        }
+        else
+          to->store(value->value, FALSE);
+        break;
+      default:
+        to->set_notnull();
+        to->store((longlong) value->count, FALSE);
+        break;
+      }
+    }
+    if (update_window_function_row(tbl))
+      return true;
+  }
+  return false;
+}
+
+
+/* Remove the first 'end' rows from the batch */
+
+void Window_parallel_job::remove_rows(ha_rows end)
+{
+  size_t rows= (size_t) (n_rows - end);
+  memmove(rowids, rowids + end * ref_length, rows * ref_length);
+  memmove(boundaries, boundaries + end, rows * sizeof(bool));
+  for (uint i= 0; i < n_funcs; i++)
+  {
+    Window_parallel_func *f= funcs + i;
+    memmove(f->flags, f->flags + end, rows);
+    memmove(f->args, f->args + end, rows * sizeof(longlong));
+  }
+  n_rows-= end;
+}
+
+
+/*
+  Compute the window functions of all rows.
+
+  @param[out] done  FALSE if a partition did not fit into a batch, and
+                    the functions must be computed by the caller
+
+  @return TRUE on error
+*/
+
+bool Window_parallel_job::exec(THD *thd, TABLE *tbl,
+                               SORT_INFO *filesort_result, uint n_threads,
+                               bool *done)
+{
+  READ_RECORD info;
+  bool eof= false, ret= false;
+
+  *done= true;
+  if (init_read_record(&info, thd, tbl, NULL/*select*/, filesort_result,
+                       0, 1, FALSE))
+    return true;
+
+  while (!eof)
+  {
+    while (n_rows < max_rows)
+    {
+      if (info.read_record())
+      {
+        eof= true;
+        break;
+      }
+      read_row(tbl);
+    }
+    if (unlikely(thd->is_error() || thd->check_killed()))
+    {
+      ret= true;
+      break;
+    }
+    if (!n_rows)
+      break;
+
+    ha_rows end= eof ? n_rows : last_boundary();
+    if (!end)
+    {
+      /* A partition of the batch may continue: make the batch larger */
+      if (max_rows >= max_batch_rows)
+      {
+        *done= false;
+        break;
+      }
+      if (alloc_rows(MY_MIN(max_rows * 2, max_batch_rows)))
+      {
+        ret= true;
+        break;
+      }
+      continue;
+    }
+
+    compute(thd, end, n_threads);
+    if (thd->check_killed() || save_rows(tbl, end))
+    {
+      ret= true;
+      break;
+    }
+    remove_rows(end);
+  }
+
+  end_read_record(&info);
+  return ret;
+}
+
+
+/*
+  Compute the window functions by several threads, if possible.
+
+  @param[out] done  TRUE if the functions were computed
+
+  @return TRUE on error
+*/
+
+static bool compute_window_func_parallel(THD *thd,
+                                         List<Item_window_func> &window_functions,
+                                         TABLE *tbl,
+                                         SORT_INFO *filesort_result,
+                                         bool *done)
+{
+  *done= false;
+  if (thd->variables.max_window_threads <= 1 || !filesort_result)
+    return false;
+
+  ha_rows n_threads= filesort_result->return_rows /
+                     WINDOW_PARALLEL_MIN_ROWS_PER_THREAD;
+  set_if_smaller(n_threads, thd->variables.max_window_threads);
+  if (n_threads < 2)
+    return false;
+
+  Window_parallel_job job;
+  if (!job.init(thd, window_functions, tbl))
+    return thd->is_error();
+
+  /* The values are stored in the result fields by the job */
+  List_iterator_fast<Item_window_func> it(window_functions);
+  Item_window_func *win_func;
+  while ((win_func= it++))
+    win_func->set_phase_to_retrieval();
+
+  DBUG_PRINT("info", ("functions: %u  threads: %u",
+                      window_functions.elements, (uint) n_threads));
+  if (job.exec(thd, tbl, filesort_result, (uint) n_threads, done))
+    return true;
+  if (!*done)
+  {
+    DBUG_PRINT("info", ("a partition does not fit into a batch"));
+    it.rewind();
+    while ((win_func= it++))
+      win_func->set_phase_to_computation();
+  }
+  return false;
+}
+
 /* Make a list that is a concation of two lists of ORDER elements */
 
 static ORDER* concat_order_lists(MEM_ROOT *mem_root, ORDER *list1, ORDER *list2)
@@ -3051,22 +3946,27 @@ bool Window_func_runner::exec(THD *thd, TABLE *tbl, SORT_INFO *filesort_result)
   }
   it.rewind();
 
-  List<Cursor_manager> cursor_managers;
-  get_window_functions_required_cursors(thd, window_functions,
-                                        &cursor_managers);
+  bool done;
+  bool is_error= compute_window_func_parallel(thd, window_functions, tbl,
+                                              filesort_result, &done);
+  if (!done && !is_error)
+  {
+    List<Cursor_manager> cursor_managers;
+    get_window_functions_required_cursors(thd, window_functions,
+                                          &cursor_managers);
 
-  /* Go through the sorted array and compute the window function */
-  bool is_error= compute_window_func(thd,
-                                     window_functions,
-                                     cursor_managers,
-                                     tbl, filesort_result);
+    /* Go through the sorted array and compute the window function */
+    is_error= compute_window_func(thd,
+                                  window_functions,
+                                  cursor_managers,
+                                  tbl, filesort_result);
+    cursor_managers.delete_elements();
+  }
   while ((win_func= it++))
   {
     win_func->set_phase_to_retrieval();
   }
 
-  cursor_managers.delete_elements();
-
   return is_error;
 }
 
@@ -49,6 +49,8 @@
 #include "derror.h"  // read_texts
 #include "sql_base.h"                           // close_cached_tables
 #include "hostname.h"                           // host_cache_size
+#include "opt_join_order_cache.h"               // join_order_cache_size
+#include "sql_parallel.h"                      // opt_max_parallel_threads
 #include <myisam.h>
 #include "debug_sync.h"                         // DEBUG_SYNC
 #include "sql_show.h"
@@ -1920,6 +1922,13 @@ static Sys_var_ulong Sys_metadata_locks_hash_instances(
        BLOCK_SIZE(1), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0), ON_UPDATE(0),
        DEPRECATED(1105, ""));
 
+static Sys_var_mybool Sys_metadata_locks_fast_path(
+       "metadata_locks_fast_path",
+       "Grant the shared metadata locks taken by DML statements without "
+       "locking the metadata lock object, as long as no conflicting lock "
+       "is granted or requested",
+       GLOBAL_VAR(mdl_fast_path), CMD_LINE(OPT_ARG), DEFAULT(FALSE));
+
 static Sys_var_on_access_session<Sys_var_ulonglong,
                                  PRIV_SET_SYSTEM_SESSION_VAR_PSEUDO_THREAD_ID>
 Sys_pseudo_thread_id(
@@ -2680,6 +2689,63 @@ static Sys_var_ulong Sys_max_sort_length(
        SESSION_VAR(max_sort_length), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(64, 8192*1024L), DEFAULT(1024), BLOCK_SIZE(1));
 
+static Sys_var_ulong Sys_max_parallel_threads(
+       "max_parallel_threads",
+       "Maximum number of worker threads that the parallel sorts, scans and "
+       "window function computations of all connections may use at the "
+       "same time. When they are all in use, the work is done by the "
+       "connection thread. The session values of max_sort_threads, "
+       "max_scan_threads and max_window_threads cannot exceed it",
+       GLOBAL_VAR(opt_max_parallel_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 65536), DEFAULT(64), BLOCK_SIZE(1));
+
+/*
+  Only a privileged user can change @@max_parallel_threads, so that it
+  bounds the session values of the threads of one parallel operation
+*/
+static bool check_parallel_threads(sys_var *self, THD *thd, set_var *var)
+{
+  ulonglong v= var->save_result.ulonglong_value;
+  ulonglong max= MY_MAX(opt_max_parallel_threads, 1);
+  if (var->type != OPT_GLOBAL && v > max)
+  {
+    var->save_result.ulonglong_value= max;
+    return throw_bounds_warning(thd, self->name.str, true, true, v);
+  }
+  return false;
+}
+
+static Sys_var_ulong Sys_max_sort_threads(
+       "max_sort_threads",
+       "Maximum number of threads one filesort without LIMIT may use to "
+       "sort the sort buffer and to merge the sorted chunks written to "
+       "disk. 1 means that the sort is done by the connection thread only",
+       SESSION_VAR(max_sort_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 256), DEFAULT(1), BLOCK_SIZE(1), NO_MUTEX_GUARD,
+       NOT_IN_BINLOG, ON_CHECK(check_parallel_threads));
+
+static Sys_var_ulong Sys_max_scan_threads(
+       "max_scan_threads",
+       "Maximum number of threads that may read the table of a single-table "
+       "query with implicit grouping, like SELECT COUNT(*), SUM(a) FROM t1, "
+       "to compute its aggregate functions. 1 means that the table is read "
+       "by the connection thread only",
+       SESSION_VAR(max_scan_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 256), DEFAULT(1), BLOCK_SIZE(1), NO_MUTEX_GUARD,
+       NOT_IN_BINLOG, ON_CHECK(check_parallel_threads));
+
+static Sys_var_ulong Sys_max_window_threads(
+       "max_window_threads",
+       "Maximum number of threads that may compute the window functions of "
+       "one sorting of the rows, when all of them use PARTITION BY. Only "
+       "ranking functions and COUNT, SUM, MIN, MAX of integer columns with "
+       "frames ending at the current row or at the end of the partition are "
+       "computed in parallel. 1 means that the window functions are "
+       "computed by the connection thread only",
+       SESSION_VAR(max_window_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 256), DEFAULT(1), BLOCK_SIZE(1), NO_MUTEX_GUARD,
+       NOT_IN_BINLOG, ON_CHECK(check_parallel_threads));
+
 static Sys_var_ulong Sys_max_sp_recursion_depth(
        "max_sp_recursion_depth",
        "Maximum stored procedure recursion depth",
@@ -2957,6 +3023,42 @@ static Sys_var_ulong Sys_optimizer_extra_pruning_depth(
        SESSION_VAR(optimizer_extra_pruning_depth), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(0, MAX_TABLES+1), DEFAULT(8), BLOCK_SIZE(1));
 
+static bool fix_join_order_cache_size(sys_var *, THD *, enum_var_type)
+{
+  join_order_cache_resize((uint) join_order_cache_size);
+  return false;
+}
+
+static Sys_var_ulong Sys_optimizer_join_order_cache_size(
+       "optimizer_join_order_cache_size",
+       "Number of join orders chosen by the optimizer that are kept for "
+       "the next optimization of the same join, as long as the row "
+       "estimates of its tables stay within a factor of two. Changing the "
+       "value empties the cache. 0 disables the cache",
+       GLOBAL_VAR(join_order_cache_size), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 65536), DEFAULT(0), BLOCK_SIZE(1),
+       NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
+       ON_UPDATE(fix_join_order_cache_size));
+
+static Sys_var_mybool Sys_optimizer_prepared_plan_reuse(
+       "optimizer_prepared_plan_reuse",
+       "Keep the join orders chosen by an execution of a prepared statement "
+       "and use them in the next executions of the statement, as long as "
+       "the row estimates of the tables stay within "
+       "optimizer_prepared_plan_reuse_ratio and the tables have not been "
+       "altered or analyzed",
+       SESSION_VAR(optimizer_prepared_plan_reuse), CMD_LINE(OPT_ARG),
+       DEFAULT(FALSE));
+
+static Sys_var_ulong Sys_optimizer_prepared_plan_reuse_ratio(
+       "optimizer_prepared_plan_reuse_ratio",
+       "The saved join order of a prepared statement is not used when the "
+       "estimated number of rows of one of its tables differs by more than "
+       "this factor from the estimate of the execution that saved it",
+       SESSION_VAR(optimizer_prepared_plan_reuse_ratio),
+       CMD_LINE(REQUIRED_ARG), VALID_RANGE(1, UINT_MAX32), DEFAULT(4),
+       BLOCK_SIZE(1));
+
 /* this is used in the sigsegv handler */
 export const char *optimizer_switch_names[]=
 {
@@ -2990,6 +3092,8 @@ export const char *optimizer_switch_names[]=
   "hash_join_cardinality",
   "cset_narrowing",
   "sargable_casefold",
+  "join_order_goo",
+  "join_cache_bloom_filter",
   "default",
   NullS
 };
@@ -3069,6 +3173,13 @@ static Sys_var_uint Sys_protocol_version(
        READ_ONLY GLOBAL_VAR(protocol_version), CMD_LINE_HELP_ONLY,
        VALID_RANGE(0, ~0U), DEFAULT(PROTOCOL_VERSION), BLOCK_SIZE(1));
 
+static Sys_var_uint Sys_protocol_compression_level(
+       "protocol_compression_level",
+       "Compression level of the new connections that use the zstd "
+       "compressed protocol. Connections that use zlib are not affected",
+       GLOBAL_VAR(protocol_compression_level), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 22), DEFAULT(3), BLOCK_SIZE(1));
+
 static Sys_var_proxy_user Sys_proxy_user(
        "proxy_user", "The proxy user account name used when logging in");
 
@@ -3383,6 +3494,14 @@ static Sys_var_ulong Sys_query_cache_min_res_unit(
        BLOCK_SIZE(8), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
        ON_UPDATE(fix_qcache_min_res_unit));
 
+static Sys_var_ulong Sys_query_cache_shards(
+       "query_cache_shards",
+       "Number of independent parts of the query cache, each with its own "
+       "lock and an equal share of query_cache_size. A query is cached in "
+       "the part chosen by the hash of its text",
+       READ_ONLY GLOBAL_VAR(query_cache_shards), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, QUERY_CACHE_MAX_SHARDS), DEFAULT(1), BLOCK_SIZE(1));
+
 static const char *query_cache_type_names[]= { "OFF", "ON", "DEMAND", 0 };
 
 static bool check_query_cache_type(sys_var *self, THD *thd, set_var *var)
@@ -4164,6 +4283,15 @@ static Sys_var_uint Sys_table_cache_instances(
        READ_ONLY GLOBAL_VAR(tc_instances), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(1, 64), DEFAULT(8), BLOCK_SIZE(1));
 
+static Sys_var_mybool Sys_table_cache_per_cpu(
+       "table_open_cache_per_cpu",
+       "Use all table_open_cache_instances from startup and pick the "
+       "instance by the CPU the thread runs on. Unused tables are taken "
+       "from other instances instead of being opened again, and moved to "
+       "instances with free space instead of being closed when an instance "
+       "is full",
+       READ_ONLY GLOBAL_VAR(tc_per_cpu), CMD_LINE(OPT_ARG), DEFAULT(FALSE));
+
 static Sys_var_ulong Sys_thread_cache_size(
        "thread_cache_size",
        "How many threads we should keep in a cache for reuse. These are freed after 5 minutes of idle time",
@@ -4333,6 +4461,27 @@ Sys_threadpool_dedicated_listener(
   GLOBAL_VAR(threadpool_dedicated_listener), CMD_LINE(OPT_ARG), DEFAULT(FALSE),
   NO_MUTEX_GUARD, NOT_IN_BINLOG
 );
+
+static Sys_var_on_access_global<Sys_var_mybool,
+                                PRIV_SET_SYSTEM_GLOBAL_VAR_THREAD_POOL>
+Sys_threadpool_numa(
+  "thread_pool_numa",
+  "If set to 1, the thread groups are bound to the NUMA nodes round robin, "
+  "and new connections are assigned to the least loaded group of the "
+  "least loaded node",
+  READ_ONLY GLOBAL_VAR(threadpool_numa), CMD_LINE(OPT_ARG), DEFAULT(FALSE)
+);
+
+static Sys_var_on_access_global<Sys_var_mybool,
+                                PRIV_SET_SYSTEM_GLOBAL_VAR_THREAD_POOL>
+Sys_threadpool_work_stealing(
+  "thread_pool_work_stealing",
+  "If set to 1, a worker thread that has no work in its own group takes "
+  "queued requests from the other groups, and the timer wakes idle workers "
+  "to help stalled groups",
+  GLOBAL_VAR(threadpool_work_stealing), CMD_LINE(OPT_ARG), DEFAULT(FALSE),
+  NO_MUTEX_GUARD, NOT_IN_BINLOG
+);
 #endif /* HAVE_POOL_OF_THREADS */
 
 /**
@@ -6793,6 +6942,43 @@ static Sys_var_ulong Sys_join_cache_level(
        SESSION_VAR(join_cache_level), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(0, 8), DEFAULT(2), BLOCK_SIZE(1));
 
+static Sys_var_ulong Sys_join_batch_filter_rows(
+       "join_batch_filter_rows",
+       "Number of rows of a table scan that are buffered to check simple "
+       "conditions on integer columns batch-at-a-time before the per-row "
+       "condition check. The buffer is limited by join_buffer_size. "
+       "0 disables batch evaluation",
+       SESSION_VAR(join_batch_filter_rows), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 65536), DEFAULT(0), BLOCK_SIZE(1));
+
+static Sys_var_ulong Sys_join_cache_spill_partitions(
+       "join_cache_spill_partitions",
+       "Maximum number of partitions a hashed join buffer (BNLH) may spill "
+       "the records of both join operands into when the records of the "
+       "preceding tables do not fit into the buffer. The optimizer uses "
+       "spilling when it is cheaper than refilling the buffer and re-reading "
+       "the joined table. 0 disables spilling",
+       SESSION_VAR(join_cache_spill_partitions), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 64), DEFAULT(0), BLOCK_SIZE(1));
+
+static Sys_var_ulong Sys_scan_batch_rows(
+       "scan_batch_rows",
+       "Number of rows a table scan of a join reads from the storage engine "
+       "with one call, if the engine supports it. The rows are read ahead "
+       "only for scans that don't lock rows. The buffer is limited by "
+       "join_buffer_size. 0 or 1 reads the rows one by one",
+       SESSION_VAR(scan_batch_rows), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 65536), DEFAULT(0), BLOCK_SIZE(1));
+
+static Sys_var_mybool Sys_group_by_hash(
+       "group_by_hash",
+       "Collect the groups of GROUP BY in an in-memory hash table before "
+       "they are written into the temporary table. When the hash table "
+       "would exceed the limit of in-memory temporary tables, the groups "
+       "are written into the temporary table and the rest of the rows are "
+       "aggregated there",
+       SESSION_VAR(group_by_hash), CMD_LINE(OPT_ARG), DEFAULT(FALSE));
+
 static Sys_var_ulong Sys_mrr_buffer_size(
        "mrr_buffer_size",
        "Size of buffer to use when using MRR with range access",
@@ -6906,6 +7092,16 @@ static Sys_var_harows Sys_expensive_subquery_limit(
        SESSION_VAR(expensive_subquery_limit), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(0, HA_POS_ERROR), DEFAULT(100), BLOCK_SIZE(1));
 
+static Sys_var_ulonglong Sys_subquery_cache_hash_size(
+       "subquery_cache_hash_size",
+       "The maximum memory used by the cache of a correlated subquery that "
+       "depends on one integer or string value and returns an integer. "
+       "Such caches are kept in an in-memory hash table and the least "
+       "recently used results are evicted when it is full. 0 means that "
+       "all subquery caches use temporary tables",
+       SESSION_VAR(subquery_cache_hash_size), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, SIZE_T_MAX), DEFAULT(0), BLOCK_SIZE(1024));
+
 static Sys_var_mybool Sys_encrypt_tmp_disk_tables(
        "encrypt_tmp_disk_tables",
        "Encrypt temporary on-disk tables (created as part of query execution)",
@@ -891,6 +891,11 @@ struct TABLE_SHARE
   bool optimizer_costs_inited;
 
   ulonglong table_map_id;               /* for row-based replication */
+  /*
+    Incremented by ANALYZE TABLE. Saved plans of prepared statements that
+    read the table are not reused after the statistics have been refreshed.
+  */
+  uint32 stats_version;
 
   /*
     Things that are incompatible between the stored version and the
@@ -57,6 +57,7 @@
 ulong tdc_size; /**< Table definition cache threshold for LRU eviction. */
 ulong tc_size; /**< Table cache threshold for LRU eviction. */
 uint32 tc_instances;
+my_bool tc_per_cpu; /**< Pick instances by CPU, share unused TABLEs. */
 static size_t tc_allocated_size;
 static std::atomic<uint32_t> tc_active_instances(1);
 static std::atomic<bool> tc_contention_warning_reported;
@@ -223,6 +224,27 @@ struct Table_cache_instance
 static Table_cache_instance *tc;
 
 
+/**
+  Get table cache instance of the thread.
+
+  With table_open_cache_per_cpu threads running on the same CPU share an
+  instance, so that its mutex is rarely contended whatever thread ids are.
+*/
+
+static inline uint32_t tc_instance(THD *thd, uint32_t n_instances)
+{
+#ifdef HAVE_SCHED_GETCPU
+  if (tc_per_cpu)
+  {
+    int cpu= sched_getcpu();
+    if (cpu >= 0)
+      return (uint32_t) cpu % n_instances;
+  }
+#endif
+  return (uint32_t) (thd->thread_id % n_instances);
+}
+
+
 static void intern_close_table(TABLE *table)
 {
   delete table->triggers;
@@ -325,6 +347,54 @@ void tc_purge()
 }
 
 
+/**
+  Move unused TABLE object of a full instance to another instance.
+
+  Used by table_open_cache_per_cpu instead of evicting LRU object, so that
+  objects of tables used on other CPUs are not closed and reopened. Mutexes
+  of other instances are only tried, as mutex of the full instance is held.
+
+  @pre object is removed from free lists of instance from, whose
+       LOCK_table_cache is locked.
+
+  @return
+    @retval true  object moved
+    @retval false no other instance has room, object should be evicted
+*/
+
+static bool tc_migrate_table(TABLE *table, uint32_t from)
+{
+  uint32_t n_instances= tc_active_instances.load(std::memory_order_relaxed);
+  TDC_element *element= table->s->tdc;
+
+  if (table->needs_reopen())
+    return false;
+  for (uint32_t k= 1; k < n_instances; k++)
+  {
+    uint32_t j= (from + k) % n_instances;
+    if (mysql_mutex_trylock(&tc[j].LOCK_table_cache))
+      continue;
+    /*
+      Share is marked flushed before its unused objects are purged from
+      each instance, so either we see the flag or the purge sees the object.
+    */
+    if (tc[j].records < tc_size && !element->flushed)
+    {
+      tc[from].records--;
+      tc[j].records++;
+      table->instance= j;
+      element->free_tables[j].list.push_front(table);
+      /* Least recently used in the old instance, so it goes first here too */
+      tc[j].free_tables.push_front(table);
+      mysql_mutex_unlock(&tc[j].LOCK_table_cache);
+      return true;
+    }
+    mysql_mutex_unlock(&tc[j].LOCK_table_cache);
+  }
+  return false;
+}
+
+
 /**
   Add new TABLE object to table cache.
 
@@ -335,7 +405,8 @@ void tc_purge()
   While locked:
   - add object to TABLE_SHARE::tdc.all_tables
   - increment tc_count
-  - evict LRU object from table cache if we reached threshold
+  - evict LRU object from table cache if we reached threshold, or move it
+    to another instance with table_open_cache_per_cpu
 
   While unlocked:
   - free evicted object
@@ -344,7 +415,7 @@ void tc_purge()
 void tc_add_table(THD *thd, TABLE *table)
 {
   uint32_t i=
-    thd->thread_id % tc_active_instances.load(std::memory_order_relaxed);
+    tc_instance(thd, tc_active_instances.load(std::memory_order_relaxed));
   TABLE *LRU_table= 0;
   TDC_element *element= table->s->tdc;
 
@@ -363,6 +434,14 @@ void tc_add_table(THD *thd, TABLE *table)
     if ((LRU_table= tc[i].free_tables.pop_front()))
     {
       LRU_table->s->tdc->free_tables[i].list.remove(LRU_table);
+      if (tc_per_cpu && tc_migrate_table(LRU_table, i))
+      {
+        /* Moved object made room for the new one */
+        tc[i].records++;
+        mysql_mutex_unlock(&tc[i].LOCK_table_cache);
+        status_var_increment(thd->status_var.table_open_cache_migrations);
+        return;
+      }
       /* Needed if MDL deadlock detector chimes in before tc_remove_table() */
       LRU_table->in_use= thd;
       mysql_mutex_unlock(&tc[i].LOCK_table_cache);
@@ -385,6 +464,54 @@ void tc_add_table(THD *thd, TABLE *table)
 }
 
 
+/**
+  Acquire unused TABLE object from another instance.
+
+  Used by table_open_cache_per_cpu when instance of the thread has no unused
+  objects of the share, instead of opening a new object. Mutexes of other
+  instances are only tried, never waited for. If instance of the thread has
+  room, the object moves there, so that it is released to this instance.
+
+  @return TABLE object, or NULL if no unused objects.
+*/
+
+static TABLE *tc_acquire_table_handoff(THD *thd, TDC_element *element,
+                                       uint32_t i, uint32_t n_instances)
+{
+  for (uint32_t k= 1; k < n_instances; k++)
+  {
+    uint32_t j= (i + k) % n_instances;
+    TABLE *table;
+
+    if (mysql_mutex_trylock(&tc[j].LOCK_table_cache))
+      continue;
+    if ((table= element->free_tables[j].list.pop_front()))
+    {
+      DBUG_ASSERT(!table->in_use);
+      table->in_use= thd;
+      DBUG_ASSERT(table->db_stat && table->file);
+      DBUG_ASSERT(!table->file->extra(HA_EXTRA_IS_ATTACHED_CHILDREN));
+      tc[j].free_tables.remove(table);
+      if (!mysql_mutex_trylock(&tc[i].LOCK_table_cache))
+      {
+        if (tc[i].records < tc_size)
+        {
+          tc[j].records--;
+          tc[i].records++;
+          table->instance= i;
+        }
+        mysql_mutex_unlock(&tc[i].LOCK_table_cache);
+      }
+      mysql_mutex_unlock(&tc[j].LOCK_table_cache);
+      status_var_increment(thd->status_var.table_open_cache_handoffs);
+      return table;
+    }
+    mysql_mutex_unlock(&tc[j].LOCK_table_cache);
+  }
+  return NULL;
+}
+
+
 /**
   Acquire TABLE object from table cache.
 
@@ -398,7 +525,7 @@ void tc_add_table(THD *thd, TABLE *table)
 TABLE *tc_acquire_table(THD *thd, TDC_element *element)
 {
   uint32_t n_instances= tc_active_instances.load(std::memory_order_relaxed);
-  uint32_t i= thd->thread_id % n_instances;
+  uint32_t i= tc_instance(thd, n_instances);
   TABLE *table;
 
   tc[i].lock_and_check_contention(n_instances, i);
@@ -414,6 +541,8 @@ TABLE *tc_acquire_table(THD *thd, TDC_element *element)
     tc[i].free_tables.remove(table);
   }
   mysql_mutex_unlock(&tc[i].LOCK_table_cache);
+  if (!table && tc_per_cpu && n_instances > 1)
+    table= tc_acquire_table_handoff(thd, element, i, n_instances);
   return table;
 }
 
@@ -613,6 +742,9 @@ bool tdc_init(void)
     DBUG_RETURN(true);
   tc_allocated_size= (tc_instances + 1) * sizeof *tc;
   update_malloc_size(tc_allocated_size, 0);
+  /* Instances are picked by CPU rather than activated on contention */
+  if (tc_per_cpu)
+    tc_active_instances.store(tc_instances, std::memory_order_relaxed);
   tdc_inited= true;
   mysql_mutex_init(key_LOCK_unused_shares, &LOCK_unused_shares,
                    MY_MUTEX_INIT_FAST);
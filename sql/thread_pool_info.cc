@@ -35,6 +35,7 @@ static ST_FIELD_INFO groups_fields_info[] =
   Column("QUEUE_LENGTH",    SLong(6), NOT_NULL),
   Column("HAS_LISTENER",    STiny(1), NOT_NULL),
   Column("IS_STALLED",      STiny(1), NOT_NULL),
+  Column("NUMA_NODE",       SLong(6), NULLABLE),
   CEnd()
 };
 
@@ -68,6 +69,12 @@ static int groups_fill_table(THD* thd, TABLE_LIST* tables, COND*)
     table->field[6]->store((longlong)(group->listener != 0), true);
     /* IS_STALLED */
     table->field[7]->store(group->stalled, true);
+    /* NUMA_NODE */
+    if (group->numa_node >= 0)
+    {
+      table->field[8]->set_notnull();
+      table->field[8]->store(group->numa_node, true);
+    }
 
     if (schema_table_store_record(thd, table))
       return 1;
@@ -173,6 +180,9 @@ static ST_FIELD_INFO stats_fields_info[] =
   Column("POLLS_BY_WORKER",               SLonglong(19), NOT_NULL),
   Column("DEQUEUES_BY_LISTENER",          SLonglong(19), NOT_NULL),
   Column("DEQUEUES_BY_WORKER",            SLonglong(19), NOT_NULL),
+  Column("QUEUE_WAIT_MICROSECONDS",       SLonglong(19), NOT_NULL),
+  Column("STEALS",                        SLonglong(19), NOT_NULL),
+  Column("STOLEN_WAIT_MICROSECONDS",      SLonglong(19), NOT_NULL),
   CEnd()
 };
 
@@ -202,6 +212,9 @@ static int stats_fill_table(THD* thd, TABLE_LIST* tables, COND*)
     table->field[8]->store(counters->polls[(int)operation_origin::WORKER], true);
     table->field[9]->store(counters->dequeues[(int)operation_origin::LISTENER], true);
     table->field[10]->store(counters->dequeues[(int)operation_origin::WORKER], true);
+    table->field[11]->store(counters->queue_wait_time, true);
+    table->field[12]->store(counters->steals, true);
+    table->field[13]->store(counters->stolen_wait_time, true);
     mysql_mutex_unlock(&group->mutex);
     if (schema_table_store_record(thd, table))
       return 1;
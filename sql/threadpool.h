@@ -28,6 +28,8 @@ extern uint threadpool_oversubscribe;  /* Maximum active threads in group */
 extern uint threadpool_prio_kickup_timer;  /* Time before low prio item gets prio boost */
 extern my_bool threadpool_exact_stats; /* Better queueing time stats for information_schema, at small performance cost */
 extern my_bool threadpool_dedicated_listener; /* Listener thread does not pick up work items. */
+extern my_bool threadpool_numa; /* Bind thread groups to NUMA nodes, place connections by load */
+extern my_bool threadpool_work_stealing; /* Idle workers take queued events of other groups */
 #ifdef _WIN32
 extern uint threadpool_mode; /* Thread pool implementation , windows or generic */
 #define TP_MODE_WINDOWS 0
@@ -51,6 +53,10 @@ struct TP_STATISTICS
 {
   /* Current number of worker thread. */
   Atomic_counter<uint32_t> num_worker_threads;
+  /* Connections taken by idle workers from the queues of other groups */
+  Atomic_counter<uint64_t> steals;
+  /* Time the stolen connections spent in the queue, in microseconds */
+  Atomic_counter<uint64_t> stolen_wait_time;
 };
 
 extern TP_STATISTICS tp_stats;
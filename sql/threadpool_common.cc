@@ -47,6 +47,8 @@ uint threadpool_mode;
 uint threadpool_prio_kickup_timer;
 my_bool threadpool_exact_stats;
 my_bool threadpool_dedicated_listener;
+my_bool threadpool_numa;
+my_bool threadpool_work_stealing;
 
 /* Stats */
 TP_STATISTICS tp_stats;
@@ -382,11 +384,19 @@ static void handle_wait_timeout(THD *thd)
   thd->net.error= 2;
 }
 
-/** Check if some client data is cached in thd->net or thd->net.vio */
+/**
+  Check if some client data is cached in thd->net or thd->net.vio.
+
+  A client that pipelines its commands has usually sent the next command
+  already, so also the socket is checked: the command is then executed
+  without going through the scheduler again.
+*/
 static bool has_unread_data(THD* thd)
 {
   NET *net= &thd->net;
   Vio *vio= net->vio;
+  if (thd->client_capabilities & MARIADB_CLIENT_PIPELINE)
+    return net_has_pending_input(net);
   return vio->has_data(vio) || has_unread_compressed_data(net);
 }
 
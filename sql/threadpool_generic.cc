@@ -29,6 +29,9 @@
 #include <sql_plist.h>
 #include <threadpool.h>
 #include <algorithm>
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#endif
 #ifdef _WIN32
 #include "threadpool_winsockets.h"
 #define OPTIONAL_IO_POLL_READ_PARAM this
@@ -92,6 +95,9 @@ static PSI_thread_info	thread_list[] =
 
 thread_group_t *all_groups;
 static uint group_count;
+/* Number of NUMA nodes that the groups are bound to, 0 if not bound */
+static uint numa_node_count;
+#define MAX_NUMA_NODES 64
 static Atomic_counter<uint32_t> shutdown_group_count;
 
 /**
@@ -121,6 +127,7 @@ static int  wake_or_create_thread(thread_group_t *thread_group, bool due_to_stal
 static int  create_worker(thread_group_t *thread_group, bool due_to_stall);
 static void *worker_main(void *param);
 static void check_stall(thread_group_t *thread_group);
+static void wake_thieves();
 static void set_next_timeout_check(ulonglong abstime);
 static void print_pool_blocked_message(bool);
 
@@ -465,6 +472,10 @@ static TP_connection_generic* queue_get(thread_group_t* group, operation_origin
   if (ret)
   {
     TP_INCREMENT_GROUP_COUNTER(group, dequeues[(int)origin]);
+    ulonglong now= threadpool_exact_stats ? microsecond_interval_timer() :
+                                            pool_timer.current_microtime;
+    if (now > ret->enqueue_time)
+      group->counters.queue_wait_time+= now - ret->enqueue_time;
   }
   return ret;
 }
@@ -588,6 +599,8 @@ static void* timer_thread(void *param)
         if(all_groups[i].connection_count)
            check_stall(&all_groups[i]);
       }
+      if (threadpool_work_stealing)
+        wake_thieves();
 
       /* Check if any client exceeded wait_timeout */
       if (timer->next_timeout_check.load(std::memory_order_relaxed) <=
@@ -945,6 +958,10 @@ static int wake_or_create_thread(thread_group_t *thread_group, bool due_to_stall
   if (thread_group->shutdown)
    DBUG_RETURN(0);
 
+  /* Leave a stalled group to the workers of the other groups */
+  DBUG_EXECUTE_IF("threadpool_stall_no_wakeup",
+                  if (due_to_stall) DBUG_RETURN(-1););
+
   if (wake_thread(thread_group, due_to_stall) == 0)
   {
     DBUG_RETURN(0);
@@ -990,6 +1007,7 @@ int thread_group_init(thread_group_t *thread_group, pthread_attr_t* thread_attr)
   thread_group->pollfd= INVALID_HANDLE_VALUE;
   thread_group->shutdown_pipe[0]= -1;
   thread_group->shutdown_pipe[1]= -1;
+  thread_group->numa_node= -1;
   queue_init(thread_group);
   DBUG_RETURN(0);
 }
@@ -1140,6 +1158,94 @@ static bool too_many_threads(thread_group_t *thread_group)
 }
 
 
+/**
+  Take a queued connection of another group
+
+  Used by a worker that has nothing to do in its own group. The groups
+  of the same NUMA node are tried first. The mutexes of the other groups
+  are only tried, the caller must not hold the mutex of its group.
+
+  Connections are taken in the order of queue_get(), so that the high
+  priority queue of the other group is still served first. The stolen
+  connection moves to the group of the worker, like in change_group().
+
+  @return stolen connection, or NULL
+*/
+
+static TP_connection_generic *steal_connection(thread_group_t *thief)
+{
+  uint n_groups= group_count;
+  uint thief_id= (uint) (thief - all_groups);
+  uint n_nodes= numa_node_count ? numa_node_count : 1;
+
+  if (n_groups < 2 || thief_id >= n_groups)
+    return NULL;
+
+  for (uint pass= 0; pass < 2; pass++)
+  {
+    for (uint i= 1; i < n_groups; i++)
+    {
+      thread_group_t *victim= &all_groups[(thief_id + i) % n_groups];
+      bool same_node= (victim - all_groups) % n_nodes == thief_id % n_nodes;
+      if (same_node != (pass == 0))
+        continue;
+
+      /* Unprotected read, to not lock the groups that have no backlog */
+      if (victim->queues[TP_PRIORITY_HIGH].is_empty() &&
+          victim->queues[TP_PRIORITY_LOW].is_empty())
+        continue;
+      if (mysql_mutex_trylock(&victim->mutex))
+        continue;
+
+      TP_connection_generic *c= NULL;
+      if (!victim->shutdown && (c= queue_get(victim)))
+      {
+        if (c->bound_to_poll_descriptor)
+        {
+          io_poll_disassociate_fd(victim->pollfd, c->fd);
+          c->bound_to_poll_descriptor= false;
+        }
+        victim->connection_count--;
+      }
+      mysql_mutex_unlock(&victim->mutex);
+      if (c)
+        return c;
+    }
+  }
+  return NULL;
+}
+
+
+/**
+  Wake an idle worker to steal from the stalled groups
+
+  Called by the timer, after check_stall() of all groups
+*/
+
+static void wake_thieves()
+{
+  uint n_groups= group_count;
+  bool stalled= false;
+
+  for (uint i= 0; i < n_groups && !stalled; i++)
+    stalled= all_groups[i].stalled;
+  if (!stalled)
+    return;
+
+  for (uint i= 0; i < n_groups; i++)
+  {
+    thread_group_t *group= &all_groups[i];
+    mysql_mutex_lock(&group->mutex);
+    /* Not due to a stall of this group: it is idle */
+    bool woken= is_queue_empty(group) && !group->stalled &&
+                !wake_thread(group, false);
+    mysql_mutex_unlock(&group->mutex);
+    if (woken)
+      break;
+  }
+}
+
+
 /**
   Retrieve a connection with pending event.
 
@@ -1163,6 +1269,7 @@ TP_connection_generic *get_event(worker_thread_t *current_thread,
 {
   DBUG_ENTER("get_event");
   TP_connection_generic *connection = NULL;
+  bool tried_steal= false;
 
 
   mysql_mutex_lock(&thread_group->mutex);
@@ -1220,6 +1327,34 @@ TP_connection_generic *get_event(worker_thread_t *current_thread,
       }
     }
 
+    /*
+      Before sleeping, help the other groups. The own mutex is released
+      while stealing, so the own queue is checked again afterwards.
+    */
+    if (!oversubscribed && threadpool_work_stealing && !tried_steal)
+    {
+      tried_steal= true;
+      mysql_mutex_unlock(&thread_group->mutex);
+      connection= steal_connection(thread_group);
+      mysql_mutex_lock(&thread_group->mutex);
+      if (connection)
+      {
+        connection->thread_group= thread_group;
+        thread_group->connection_count++;
+
+        ulonglong now= threadpool_exact_stats ? microsecond_interval_timer() :
+                                                pool_timer.current_microtime;
+        ulonglong wait= now > connection->enqueue_time ?
+                        now - connection->enqueue_time : 0;
+        TP_INCREMENT_GROUP_COUNTER(thread_group, steals);
+        thread_group->counters.stolen_wait_time+= wait;
+        tp_stats.steals++;
+        tp_stats.stolen_wait_time+= wait;
+        break;
+      }
+      continue;
+    }
+
 
     /* And now, finally sleep */
     current_thread->woken = false; /* wake() sets this to true */
@@ -1255,6 +1390,7 @@ TP_connection_generic *get_event(worker_thread_t *current_thread,
 
     if (err)
       break;
+    tried_steal= false;
   }
 
   thread_group->stalled= false;
@@ -1390,6 +1526,55 @@ static size_t get_group_id(my_thread_id tid)
 }
 
 
+/* Load of a group, for the placement of new connections */
+static int group_load(const thread_group_t *group)
+{
+  return group->connection_count +
+    (int) (group->queues[TP_PRIORITY_HIGH].elements() +
+           group->queues[TP_PRIORITY_LOW].elements());
+}
+
+
+/**
+  Find the least loaded group of the least loaded NUMA node
+
+  The counters are read without the mutexes of the groups: the
+  placement only needs to be approximately balanced.
+*/
+
+static thread_group_t *least_loaded_group()
+{
+  int node_load[MAX_NUMA_NODES]= {0};
+  uint n_groups= group_count;
+  uint best_node= 0;
+
+  for (uint i= 0; i < n_groups; i++)
+    node_load[i % numa_node_count]+= group_load(&all_groups[i]);
+  for (uint node= 1; node < numa_node_count && node < n_groups; node++)
+  {
+    if (node_load[node] < node_load[best_node])
+      best_node= node;
+  }
+
+  thread_group_t *best= &all_groups[best_node];
+  for (uint i= best_node + numa_node_count; i < n_groups; i+= numa_node_count)
+  {
+    if (group_load(&all_groups[i]) < group_load(best))
+      best= &all_groups[i];
+  }
+  return best;
+}
+
+
+/** Choose the group of a new connection */
+static thread_group_t *connection_group(my_thread_id tid)
+{
+  if (numa_node_count)
+    return least_loaded_group();
+  return &all_groups[get_group_id(tid)];
+}
+
+
 TP_connection_generic::TP_connection_generic(CONNECT *c):
   TP_connection(c),
   thread_group(0),
@@ -1410,8 +1595,7 @@ TP_connection_generic::TP_connection_generic(CONNECT *c):
 #endif
 
   /* Assign connection to a group. */
-  thread_group_t *group=
-    &all_groups[get_group_id(c->thread_id)];
+  thread_group_t *group= connection_group(c->thread_id);
   thread_group=group;
 
   mysql_mutex_lock(&group->mutex);
@@ -1497,11 +1681,14 @@ int TP_connection_generic::start_io()
 
     So we recalculate in which group the connection should be, based
     on thread_id and current group count, and migrate if necessary.
+    With thread_pool_numa, only connections of the removed groups move.
   */
   if (fix_group)
   {
     fix_group = false;
-    thread_group_t *new_group= &all_groups[get_group_id(thd->thread_id)];
+    thread_group_t *new_group=
+      numa_node_count && thread_group < all_groups + group_count ?
+      thread_group : connection_group(thd->thread_id);
 
     if (new_group != thread_group)
     {
@@ -1540,6 +1727,18 @@ static void *worker_main(void *param)
 
   thread_group_t *thread_group = (thread_group_t *)param;
 
+#ifdef HAVE_LIBNUMA
+  /*
+    Run on the CPUs of the node of the group, and allocate the memory of
+    the thread, e.g the THDs of the connections, from the same node
+  */
+  if (thread_group->numa_node >= 0)
+  {
+    numa_run_on_node(thread_group->numa_node);
+    numa_set_preferred(thread_group->numa_node);
+  }
+#endif
+
   /* Init per-thread structure */
   mysql_cond_init(key_worker_cond, &this_thread.cond, NULL);
   this_thread.thread_group= thread_group;
@@ -1578,6 +1777,37 @@ static void *worker_main(void *param)
 
 TP_pool_generic::TP_pool_generic() = default;
 
+
+/**
+  Assign the thread groups to the NUMA nodes the server may run on,
+  round robin
+*/
+
+static void numa_init()
+{
+#ifdef HAVE_LIBNUMA
+  if (numa_available() >= 0)
+  {
+    int nodes[MAX_NUMA_NODES];
+    struct bitmask *allowed= numa_get_run_node_mask();
+    for (int node= 0; node <= numa_max_node() &&
+         numa_node_count < MAX_NUMA_NODES; node++)
+    {
+      if (numa_bitmask_isbitset(allowed, node))
+        nodes[numa_node_count++]= node;
+    }
+    numa_bitmask_free(allowed);
+    for (uint i= 0; numa_node_count && i < threadpool_max_size; i++)
+      all_groups[i].numa_node= nodes[i % numa_node_count];
+  }
+#endif
+  if (!numa_node_count)
+    sql_print_warning("thread_pool_numa is ignored: NUMA is not available");
+  else
+    sql_print_information("Thread pool groups are bound to %u NUMA nodes",
+                          numa_node_count);
+}
+
 int TP_pool_generic::init()
 {
   DBUG_ENTER("TP_pool_generic::TP_pool_generic");
@@ -1600,6 +1830,8 @@ int TP_pool_generic::init()
   {
     thread_group_init(&all_groups[i], get_connection_attrib());
   }
+  if (threadpool_numa)
+    numa_init();
   set_pool_size(threadpool_size);
   if(group_count == 0)
   {
@@ -126,6 +126,9 @@ struct thread_group_counters_t
   ulonglong stalls;
   ulonglong dequeues[2];
   ulonglong polls[2];
+  ulonglong queue_wait_time; /* microseconds, of the dequeued connections */
+  ulonglong steals;          /* connections taken from other groups */
+  ulonglong stolen_wait_time; /* microseconds, of the stolen connections */
 };
 
 struct thread_group_t
@@ -146,6 +149,7 @@ struct thread_group_t
   int  shutdown_pipe[2];
   bool shutdown;
   bool stalled;
+  int  numa_node; /* -1 if the workers are not bound to a node */
   thread_group_counters_t counters;
   char pad[CPU_LEVEL1_DCACHE_LINESIZE];
 };
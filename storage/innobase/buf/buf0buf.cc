@@ -1301,6 +1301,7 @@ bool buf_pool_t::create()
 
   chunk_t::map_ref= chunk_t::map_reg;
   buf_LRU_old_ratio_update(100 * 3 / 8, false);
+  buf_LRU_ghost_create(curr_size);
   btr_search_sys_create();
 
 #ifdef __linux__
@@ -1361,6 +1362,7 @@ void buf_pool_t::close()
   chunks= nullptr;
   page_hash.free();
   zip_hash.free();
+  buf_LRU_ghost_free();
 
   io_buf.close();
   UT_DELETE(chunk_t::map_reg);
@@ -2011,6 +2013,7 @@ inline void buf_pool_t::resize()
 
 	curr_size = new_size;
 	n_chunks_new = n_chunks;
+	buf_LRU_ghost_resize(curr_size);
 
 	if (chunks_old) {
 		ut_free(chunks_old);
@@ -99,6 +99,134 @@ least this many milliseconds ago.  Not protected by any mutex or latch. */
 uint	buf_LRU_old_threshold_ms;
 /* @} */
 
+/** innodb_lru_make_young_trylock: whether buf_page_make_young() skips
+the move when buf_pool.mutex is busy */
+my_bool buf_LRU_make_young_trylock;
+
+/** innodb_lru_policy; set at startup */
+ulong buf_LRU_policy;
+
+/** Identifiers of pages that were evicted from the "old" blocks of
+buf_pool.LRU, for innodb_lru_policy=2Q. This is a direct-mapped table:
+a newer entry replaces any older one in the same slot. That only
+affects the hit rate. Protected by buf_pool.mutex. */
+static struct
+{
+  /** page_id_t::raw() of evicted pages; ~0ULL for empty slots */
+  ulonglong *ids;
+  /** number of slots minus 1 */
+  ulint mask;
+} buf_LRU_ghost;
+
+/** Allocate an empty table of evicted page identifiers.
+@param n_pages  size of the buffer pool, in pages
+@param mask     number of slots minus 1
+@return the table
+@retval nullptr if out of memory */
+static ulonglong *buf_LRU_ghost_alloc(ulint n_pages, ulint &mask)
+{
+  /* Like the A1out queue of 2Q, remember half as many pages as the
+  buffer pool can hold. */
+  ulint n= 1;
+  while (n < n_pages / 2)
+    n<<= 1;
+
+  ulonglong *ids= static_cast<ulonglong*>(ut_malloc_nokey(n * sizeof *ids));
+  if (ids)
+  {
+    memset(ids, 0xff, n * sizeof *ids);
+    mask= n - 1;
+  }
+  return ids;
+}
+
+/** Allocate the memory of evicted page identifiers for innodb_lru_policy=2Q.
+@param n_pages  size of the buffer pool, in pages */
+void buf_LRU_ghost_create(ulint n_pages)
+{
+  ut_ad(!buf_LRU_ghost.ids);
+  if (buf_LRU_policy == BUF_LRU_2Q)
+    buf_LRU_ghost.ids= buf_LRU_ghost_alloc(n_pages, buf_LRU_ghost.mask);
+}
+
+/** Resize the table of evicted page identifiers to the buffer pool.
+@param n_pages  new size of the buffer pool, in pages */
+void buf_LRU_ghost_resize(ulint n_pages)
+{
+  mysql_mutex_assert_owner(&buf_pool.mutex);
+  if (buf_LRU_policy != BUF_LRU_2Q)
+    return;
+
+  ulint mask;
+  ulonglong *ids= buf_LRU_ghost_alloc(n_pages, mask);
+  if (!ids)
+    /* Keep the old table; it only affects the hit rate. */
+    return;
+
+  if (buf_LRU_ghost.ids)
+  {
+    /* Carry over the pages that were evicted most recently. When the
+    table shrinks, some of them will share a slot and be forgotten. */
+    for (ulint i= 0; i <= buf_LRU_ghost.mask; i++)
+    {
+      const ulonglong raw= buf_LRU_ghost.ids[i];
+      if (raw != ~0ULL)
+        ids[page_id_t{raw}.fold() & mask]= raw;
+    }
+    ut_free(buf_LRU_ghost.ids);
+  }
+
+  buf_LRU_ghost.ids= ids;
+  buf_LRU_ghost.mask= mask;
+}
+
+/** Free the memory of evicted page identifiers. */
+void buf_LRU_ghost_free()
+{
+  ut_free(buf_LRU_ghost.ids);
+  buf_LRU_ghost.ids= nullptr;
+}
+
+/** Check whether a page that is being read was evicted recently.
+@param id  page identifier
+@return whether the page should be added to the start of buf_pool.LRU */
+bool buf_LRU_ghost_hit(const page_id_t id)
+{
+  mysql_mutex_assert_owner(&buf_pool.mutex);
+  if (!buf_LRU_ghost.ids)
+    return false;
+  ulonglong &slot= buf_LRU_ghost.ids[id.fold() & buf_LRU_ghost.mask];
+  if (slot != id.raw())
+    return false;
+  slot= ~0ULL;
+  MONITOR_INC(MONITOR_LRU_GHOST_HITS);
+  return true;
+}
+
+/** Account for the eviction of a page from buf_pool.LRU.
+@param bpage  page that is being evicted */
+static void buf_LRU_evicted(const buf_page_t &bpage)
+{
+  mysql_mutex_assert_owner(&buf_pool.mutex);
+  const bool old= bpage.is_old();
+
+  if (!bpage.is_accessed())
+    MONITOR_INC(MONITOR_LRU_EVICT_UNACCESSED);
+  else if (old)
+    MONITOR_INC(MONITOR_LRU_EVICT_OLD);
+  else
+    MONITOR_INC(MONITOR_LRU_EVICT_YOUNG);
+
+  /* Only pages that are evicted from the "old" blocks are remembered,
+  whether or not they were accessed there. If such a page is read again
+  soon, it will skip the "old" blocks. */
+  if (buf_LRU_ghost.ids && old && !bpage.is_freed())
+  {
+    const page_id_t id{bpage.id()};
+    buf_LRU_ghost.ids[id.fold() & buf_LRU_ghost.mask]= id.raw();
+  }
+}
+
 /** Remove bpage from buf_pool.LRU and buf_pool.page_hash.
 
 If !bpage->frame && bpage->oldest_modification() <= 1,
@@ -402,6 +530,13 @@ buf_block_t* buf_LRU_get_free_block(buf_LRU_get get)
 
     ut_d(bool signalled = false);
 
+    /* Unless the caller needs it, release buf_pool.mutex before
+    acquiring buf_pool.flush_list_mutex. When the free list is short,
+    as it will be during a large scan, this would otherwise be done
+    on every allocation while holding buf_pool.mutex. */
+    if (UNIV_LIKELY(get != have_mutex))
+      mysql_mutex_unlock(&buf_pool.mutex);
+
     if (UNIV_UNLIKELY(available < scan_depth) && LRU_size > BUF_LRU_MIN_LEN)
     {
       mysql_mutex_lock(&buf_pool.flush_list_mutex);
@@ -413,9 +548,6 @@ buf_block_t* buf_LRU_get_free_block(buf_LRU_get get)
       mysql_mutex_unlock(&buf_pool.flush_list_mutex);
     }
 
-    if (UNIV_LIKELY(get != have_mutex))
-      mysql_mutex_unlock(&buf_pool.mutex);
-
     DBUG_EXECUTE_IF("ib_free_page_sleep",
     {
       static bool do_sleep = true;
@@ -743,7 +875,16 @@ void buf_page_make_young(buf_page_t *bpage)
 
   ut_ad(bpage->in_file());
 
-  mysql_mutex_lock(&buf_pool.mutex);
+  /* Moving the block is only a hint for the replacement policy.
+  If requested, rather than queue up for buf_pool.mutex behind threads
+  that are allocating or evicting blocks, let a subsequent access retry. */
+  if (!buf_LRU_make_young_trylock)
+    mysql_mutex_lock(&buf_pool.mutex);
+  else if (mysql_mutex_trylock(&buf_pool.mutex))
+  {
+    ++buf_pool.stat.n_pages_young_skipped;
+    return;
+  }
 
   if (UNIV_UNLIKELY(bpage->old))
     buf_pool.stat.n_pages_made_young++;
@@ -848,6 +989,10 @@ bool buf_LRU_free_page(buf_page_t *bpage, bool zip)
 
 	ut_ad(bpage->can_relocate());
 
+	if (!b) {
+		buf_LRU_evicted(*bpage);
+	}
+
 	if (!buf_LRU_block_remove_hashed(bpage, id, chain, zip)) {
 		ut_ad(!b);
 		mysql_mutex_assert_not_owner(&buf_pool.flush_list_mutex);
@@ -125,8 +125,9 @@ static buf_page_t *buf_page_init_for_read(const page_id_t page_id,
     buf_pool.page_hash.append(chain, bpage);
     hash_lock.unlock();
 
-    /* The block must be put to the LRU list, to the old blocks */
-    buf_LRU_add_block(bpage, true/* to old blocks */);
+    /* The block must be put to the LRU list, to the old blocks,
+    unless it was evicted recently */
+    buf_LRU_add_block(bpage, !buf_LRU_ghost_hit(page_id));
 
     if (UNIV_UNLIKELY(zip_size))
     {
@@ -183,9 +184,10 @@ static buf_page_t *buf_page_init_for_read(const page_id_t page_id,
       buf_pool.page_hash.append(chain, bpage);
     }
 
-    /* The block must be put to the LRU list, to the old blocks.
+    /* The block must be put to the LRU list, to the old blocks,
+    unless it was evicted recently.
     The zip size is already set into the page zip */
-    buf_LRU_add_block(bpage, true/* to old blocks */);
+    buf_LRU_add_block(bpage, !buf_LRU_ghost_hit(page_id));
   }
 
   buf_pool.stat.n_pages_read++;
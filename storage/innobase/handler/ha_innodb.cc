@@ -429,6 +429,21 @@ static TYPELIB innodb_instant_alter_column_allowed_typelib = {
 	NULL
 };
 
+/** Allowed values of innodb_lru_policy */
+static const char* innodb_lru_policy_names[] = {
+	"midpoint", /* BUF_LRU_MIDPOINT */
+	"2q", /* BUF_LRU_2Q */
+	NullS
+};
+
+/** Enumeration of innodb_lru_policy */
+static TYPELIB innodb_lru_policy_typelib = {
+	array_elements(innodb_lru_policy_names) - 1,
+	"innodb_lru_policy_typelib",
+	innodb_lru_policy_names,
+	NULL
+};
+
 /** Retrieve the FTS Relevance Ranking result for doc with doc_id
 of m_prebuilt->fts_doc_id
 @param[in,out]	fts_hdl	FTS handler
@@ -613,7 +628,9 @@ is defined */
 static PSI_thread_info	all_innodb_threads[] = {
   {&page_cleaner_thread_key, "page_cleaner", 0},
   {&trx_rollback_clean_thread_key, "trx_rollback", 0},
-  {&thread_pool_thread_key,"ib_tpool_worker", 0}
+  {&thread_pool_thread_key,"ib_tpool_worker", 0},
+  {&log_writer_thread_key, "ib_log_writer", 0},
+  {&log_flusher_thread_key, "ib_log_flusher", 0}
 };
 # endif /* UNIV_PFS_THREAD */
 
@@ -955,6 +972,8 @@ static SHOW_VAR innodb_status_variables[]= {
    &buf_pool.stat.n_pages_not_made_young, SHOW_SIZE_T},
   {"buffer_pool_pages_made_young",
    &buf_pool.stat.n_pages_made_young, SHOW_SIZE_T},
+  {"buffer_pool_pages_made_young_skipped",
+   &export_vars.innodb_buffer_pool_pages_made_young_skipped, SHOW_SIZE_T},
   {"buffer_pool_pages_misc",
    &export_vars.innodb_buffer_pool_pages_misc, SHOW_SIZE_T},
   {"buffer_pool_pages_old", &buf_pool.LRU_old_len, SHOW_SIZE_T},
@@ -1007,6 +1026,14 @@ static SHOW_VAR innodb_status_variables[]= {
   {"pages_created", &buf_pool.stat.n_pages_created, SHOW_SIZE_T},
   {"pages_read", &buf_pool.stat.n_pages_read, SHOW_SIZE_T},
   {"pages_written", &buf_pool.stat.n_pages_written, SHOW_SIZE_T},
+  {"recovery_apply_time", &export_vars.innodb_recovery_apply_time,
+   SHOW_ULONGLONG},
+  {"recovery_pages_applied", &export_vars.innodb_recovery_pages_applied,
+   SHOW_SIZE_T},
+  {"recovery_pages_applied_per_thread",
+   &export_vars.innodb_recovery_pages_applied_per_thread, SHOW_CHAR},
+  {"recovery_parse_time", &export_vars.innodb_recovery_parse_time,
+   SHOW_ULONGLONG},
   {"row_lock_current_waits", &export_vars.innodb_row_lock_current_waits,
    SHOW_SIZE_T},
   {"row_lock_time", &export_vars.innodb_row_lock_time, SHOW_LONGLONG},
@@ -9442,6 +9469,54 @@ ha_innobase::rnd_next(
 	DBUG_RETURN(error);
 }
 
+/** Read the next rows of a table scan into a buffer of the caller.
+The rows are converted by row_search_mvcc() directly into the buffer,
+instead of passing through the fetch cache of the prebuilt struct one
+at a time. Only consistent reads of rows without BLOBs are supported.
+@param buf       buffer for max_rows rows in the MySQL format
+@param stride    distance of the rows in buf
+@param max_rows  capacity of buf in rows
+@param n_rows    number of rows read
+@return 0, HA_ERR_END_OF_FILE, HA_ERR_UNSUPPORTED or error number */
+int
+ha_innobase::rnd_next_batch(uchar* buf, size_t stride, uint max_rows,
+			    uint* n_rows)
+{
+	int	error;
+	DBUG_ENTER("rnd_next_batch");
+
+	ut_ad(stride >= m_prebuilt->mysql_row_len);
+
+	if (m_start_of_scan || m_prebuilt->n_fetch_cached) {
+		/* Position the cursor, or return the rows that were
+		prefetched by rnd_next(), one at a time. The template
+		is only known after the cursor has been positioned. */
+		error = rnd_next(buf);
+		*n_rows = !error;
+		DBUG_RETURN(error);
+	}
+
+	if (m_prebuilt->select_lock_type != LOCK_NONE
+	    || m_prebuilt->templ_contains_blob
+	    || m_prebuilt->pk_filter || m_prebuilt->idx_cond
+	    || m_prebuilt->used_in_HANDLER
+	    || m_prebuilt->in_fts_query) {
+		DBUG_RETURN(HA_ERR_UNSUPPORTED);
+	}
+
+	m_prebuilt->bulk_buf = buf;
+	m_prebuilt->bulk_stride = stride;
+	m_prebuilt->bulk_max = max_rows;
+	m_prebuilt->n_bulk = 0;
+
+	error = general_fetch(buf, ROW_SEL_NEXT, 0);
+
+	*n_rows = error ? 0 : uint(m_prebuilt->n_bulk);
+	m_prebuilt->bulk_buf = NULL;
+
+	DBUG_RETURN(error);
+}
+
 /**********************************************************************//**
 Fetches a row from the table based on a row reference.
 @return 0, HA_ERR_KEY_NOT_FOUND, or error code */
@@ -9471,6 +9546,74 @@ ha_innobase::rnd_pos(
 	DBUG_RETURN(error);
 }
 
+/** Pass a row of row_search_parallel() to the Parallel_scan_rows.
+@param arg     Parallel_scan_rows
+@param worker  number of the thread
+@param rec     row in the MySQL format
+@return whether the scan should stop */
+static bool innobase_parallel_add_row(void *arg, ulint worker,
+				      const byte *rec)
+{
+	return static_cast<Parallel_scan_rows*>(arg)->add_row(
+		uint(worker), rec);
+}
+
+/** Read all rows of the table by several threads.
+Only consistent (non-locking) reads of the clustered index of persistent
+tables are supported, and only for columns that are stored in the
+clustered index record itself.
+@param n_threads  maximum number of threads
+@param rows       receiver of the rows
+@return 0, HA_ERR_UNSUPPORTED or error number */
+int ha_innobase::parallel_scan(uint n_threads, Parallel_scan_rows *rows)
+{
+	DBUG_ENTER("ha_innobase::parallel_scan");
+
+	ut_ad(m_prebuilt->trx == thd_to_trx(m_user_thd));
+
+	if (m_prebuilt->select_lock_type != LOCK_NONE
+	    || m_prebuilt->table->is_temporary()
+	    || m_prebuilt->table->no_rollback()
+	    || !m_prebuilt->table->is_readable()
+	    || dict_table_has_fts_index(m_prebuilt->table)
+	    || pushed_idx_cond || pushed_rowid_filter) {
+		DBUG_RETURN(HA_ERR_UNSUPPORTED);
+	}
+
+	for (Field **field = table->field; *field; field++) {
+		if (bitmap_is_set(table->read_set, (*field)->field_index)
+		    && ((*field)->flags & BLOB_FLAG
+			|| !(*field)->stored_in_db())) {
+			DBUG_RETURN(HA_ERR_UNSUPPORTED);
+		}
+	}
+
+	/* Build the template for the clustered index */
+	if (int err = change_active_index(MAX_KEY)) {
+		DBUG_RETURN(err);
+	}
+
+	if (!m_prebuilt->index_usable) {
+		DBUG_RETURN(HA_ERR_TABLE_DEF_CHANGED);
+	}
+
+	trx_t*	trx = m_prebuilt->trx;
+
+	if (m_prebuilt->sql_stat_start) {
+		m_prebuilt->sql_stat_start = FALSE;
+		trx_start_if_not_started(trx, false);
+		trx->read_view.open(trx);
+	}
+
+	dberr_t	err = row_search_parallel(m_prebuilt, n_threads,
+					  innobase_parallel_add_row, rows);
+
+	DBUG_EXECUTE_IF("ib_select_query_failure", err = DB_ERROR;);
+
+	DBUG_RETURN(convert_error_code_to_mysql(
+			    err, m_prebuilt->table->flags, m_user_thd));
+}
+
 /**********************************************************************//**
 Initialize FT index scan
 @return 0 or error number */
@@ -19458,6 +19601,12 @@ static MYSQL_SYSVAR_BOOL(log_file_write_through, log_sys.log_write_through,
   "Whether each write to ib_logfile0 is write through",
   nullptr, innodb_log_file_write_through_update, FALSE);
 
+static MYSQL_SYSVAR_BOOL(log_writer_threads, innodb_log_writer_threads,
+  PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
+  "Whether dedicated threads write and flush ib_logfile0, instead of"
+  " the first committing transaction that has to wait for it",
+  nullptr, nullptr, FALSE);
+
 static MYSQL_SYSVAR_BOOL(data_file_buffering, fil_system.buffered,
   PLUGIN_VAR_OPCMDARG,
   "Whether the file system cache for data files is enabled",
@@ -19492,6 +19641,19 @@ static MYSQL_SYSVAR_UINT(old_blocks_time, buf_LRU_old_threshold_ms,
   " The timeout is disabled if 0",
   NULL, NULL, 1000, 0, UINT_MAX32, 0);
 
+static MYSQL_SYSVAR_BOOL(lru_make_young_trylock, buf_LRU_make_young_trylock,
+  PLUGIN_VAR_OPCMDARG,
+  "Do not move a block to the start of the LRU list when the buffer pool"
+  " mutex is busy; retry on a later access instead",
+  NULL, NULL, FALSE);
+
+static MYSQL_SYSVAR_ENUM(lru_policy, buf_LRU_policy,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Buffer pool page replacement policy."
+  " midpoint=add pages that are read to the 'old' blocks;"
+  " 2q=like midpoint, but add recently evicted pages to the 'new' blocks",
+  NULL, NULL, BUF_LRU_MIDPOINT, &innodb_lru_policy_typelib);
+
 static MYSQL_SYSVAR_ULONG(open_files, innobase_open_files,
   PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
   "How many files at the maximum InnoDB keeps open at the same time",
@@ -19877,6 +20039,8 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(buffer_pool_load_at_startup),
   MYSQL_SYSVAR(lru_scan_depth),
   MYSQL_SYSVAR(lru_flush_size),
+  MYSQL_SYSVAR(lru_make_young_trylock),
+  MYSQL_SYSVAR(lru_policy),
   MYSQL_SYSVAR(flush_neighbors),
   MYSQL_SYSVAR(checksum_algorithm),
   MYSQL_SYSVAR(compression_level),
@@ -19918,6 +20082,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(data_file_buffering),
   MYSQL_SYSVAR(data_file_write_through),
   MYSQL_SYSVAR(log_file_size),
+  MYSQL_SYSVAR(log_writer_threads),
   MYSQL_SYSVAR(log_write_ahead_size),
   MYSQL_SYSVAR(log_spin_wait_delay),
   MYSQL_SYSVAR(log_group_home_dir),
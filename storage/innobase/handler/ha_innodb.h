@@ -151,8 +151,14 @@ class ha_innobase final : public handler
 
 	int rnd_next(uchar *buf) override;
 
+	int rnd_next_batch(uchar *buf, size_t stride, uint max_rows,
+			   uint *n_rows) override;
+
 	int rnd_pos(uchar * buf, uchar *pos) override;
 
+	int parallel_scan(uint n_threads, Parallel_scan_rows *rows)
+		override;
+
 	int ft_init() override;
 	void ft_end() override { rnd_end(); }
 	FT_INFO *ft_init_ext(uint flags, uint inx, String* key) override;
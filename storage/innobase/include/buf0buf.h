@@ -1121,6 +1121,9 @@ struct buf_pool_stat_t{
 				young because the first access
 				was not long enough ago, in
 				buf_page_peek_if_too_old() */
+	/** number of pages not made young in buf_page_make_young()
+	because buf_pool.mutex was busy; NOT protected by buf_pool.mutex */
+	ib_counter_t<ulint, ib_counter_element_t>	n_pages_young_skipped;
 	/** number of waits for eviction */
 	ulint	LRU_waits;
 	ulint	LRU_bytes;	/*!< LRU size in bytes */
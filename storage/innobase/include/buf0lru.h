@@ -185,6 +185,38 @@ least this many milliseconds ago.  Not protected by any mutex or latch. */
 extern uint	buf_LRU_old_threshold_ms;
 /* @} */
 
+/** innodb_lru_make_young_trylock: whether buf_page_make_young() skips
+the move when buf_pool.mutex is busy */
+extern my_bool buf_LRU_make_young_trylock;
+
+/** Page replacement policies (innodb_lru_policy) */
+enum buf_LRU_policy_t
+{
+  /** Add pages that are read into the buffer pool to the "old" blocks,
+  at innodb_old_blocks_pct from the end of buf_pool.LRU */
+  BUF_LRU_MIDPOINT= 0,
+  /** Like BUF_LRU_MIDPOINT, but remember pages that were evicted from
+  the "old" blocks (the "A1out" queue of the 2Q algorithm), and add them
+  to the start of buf_pool.LRU if they are read again soon enough */
+  BUF_LRU_2Q
+};
+
+/** innodb_lru_policy; set at startup */
+extern ulong buf_LRU_policy;
+
+/** Allocate the memory of evicted page identifiers for innodb_lru_policy=2Q.
+@param n_pages  size of the buffer pool, in pages */
+void buf_LRU_ghost_create(ulint n_pages);
+/** Resize the table of evicted page identifiers to the buffer pool.
+@param n_pages  new size of the buffer pool, in pages */
+void buf_LRU_ghost_resize(ulint n_pages);
+/** Free the memory of evicted page identifiers. */
+void buf_LRU_ghost_free();
+/** Check whether a page that is being read was evicted recently.
+@param id  page identifier
+@return whether the page should be added to the start of buf_pool.LRU */
+bool buf_LRU_ghost_hit(const page_id_t id);
+
 /** @brief Statistics for selecting the LRU list for eviction.
 
 These statistics are not 'of' LRU but 'for' LRU.  We keep count of I/O
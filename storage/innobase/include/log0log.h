@@ -66,6 +66,21 @@ void log_write_up_to(lsn_t lsn, bool durable,
 @param durable  whether to wait for a durable write to complete */
 void log_buffer_flush_to_disk(bool durable= true);
 
+/** innodb_log_writer_threads: whether dedicated threads write and flush
+the log, instead of the first thread that waits in log_write_up_to() */
+extern my_bool innodb_log_writer_threads;
+
+/** Start the dedicated log writer and flusher threads
+if innodb_log_writer_threads is set */
+void log_writer_threads_start();
+/** Stop the dedicated log writer and flusher threads, if they are running */
+void log_writer_threads_stop();
+
+/** Count a wait for a durable transaction commit in the INNODB_METRICS
+histogram log_commit_wait_*.
+@param ns  duration of the wait, in nanoseconds */
+void log_commit_wait_record(ulonglong ns);
+
 
 /** Prepare to invoke log_write_and_flush(), before acquiring log_sys.latch. */
 ATTRIBUTE_COLD void log_write_and_flush_prepare();
@@ -504,6 +519,14 @@ struct log_t
     noexcept;
 public:
   /** Reserve space in the log buffer for appending data.
+
+  Only the assignment of the LSN range and of the matching buf_free range
+  is serialized, by lock_lsn() or lsn_lock. The caller will copy its
+  records into the reserved range while holding a shared latch,
+  concurrently with other mtr_t::commit(). A log write acquires an
+  exclusive latch, which waits for all copying into the ranges that were
+  reserved before it, so that everything up to get_lsn() is complete.
+
   @tparam spin  whether to use the spin-only lock_lsn()
   @tparam mmap  log_sys.is_mmap()
   @param size   total length of the data to append(), in bytes
@@ -237,6 +237,21 @@ struct recv_sys_t
   /** the time when progress was last reported */
   time_t progress_time;
 
+  /** time spent parsing the log, excluding apply(false), in microseconds */
+  ulonglong parse_time;
+  /** time spent in apply(), in microseconds */
+  ulonglong apply_time;
+  /** maximum number of threads whose applied pages are counted apart */
+  static constexpr unsigned APPLY_THREADS_MAX= 64;
+  /** number of threads that have applied log to pages */
+  Atomic_counter<unsigned> apply_threads;
+  /** number of pages that each thread has applied log to; any threads
+  beyond APPLY_THREADS_MAX share the last counter */
+  Atomic_counter<size_t> pages_applied[APPLY_THREADS_MAX];
+
+  /** Count a page that the current thread applies log to */
+  inline void count_applied();
+
   using map = std::map<const page_id_t, page_recv_t,
                        std::less<const page_id_t>,
                        ut_allocator<std::pair<const page_id_t, page_recv_t>>>;
@@ -396,6 +411,9 @@ struct recv_sys_t
 
   /** Report progress in terms of LSN or pages remaining */
   ATTRIBUTE_COLD void report_progress() const;
+  /** Report the parse and apply times and the pages applied by each
+  thread, at the end of the last batch */
+  ATTRIBUTE_COLD void report_apply_stats() const;
 public:
   /** Parse and register one log_t::FORMAT_10_8 mini-transaction,
   without handling any log_sys.is_mmap() buffer wrap-around.
@@ -634,6 +634,15 @@ struct row_prebuilt_t {
 					fetched row in fetch_cache */
 	ulint		n_fetch_cached;	/*!< number of not yet fetched rows
 					in fetch_cache */
+	byte*		bulk_buf;	/*!< if not NULL, row_search_mvcc()
+					converts the rows directly into this
+					buffer of the caller instead of using
+					fetch_cache, until bulk_max rows have
+					been stored or the scan ends; see
+					ha_innobase::rnd_next_batch() */
+	ulint		bulk_stride;	/*!< distance of the rows in bulk_buf */
+	ulint		bulk_max;	/*!< capacity of bulk_buf in rows */
+	ulint		n_bulk;		/*!< number of rows stored in bulk_buf */
 	mem_heap_t*	blob_heap;	/*!< in SELECTS BLOB fields are copied
 					to this heap */
 	mem_heap_t*	old_vers_heap;	/*!< memory heap where a previous
@@ -178,6 +178,27 @@ current read view.
 dberr_t row_check_index(row_prebuilt_t *prebuilt, ulint *n_rows)
   MY_ATTRIBUTE((nonnull, warn_unused_result));
 
+/** Receiver of the rows of row_search_parallel().
+@param arg     the argument that was passed to row_search_parallel()
+@param worker  number of the calling thread
+@param rec     the row in the MySQL format
+@return whether to stop the scan */
+typedef bool (*row_parallel_add_t)(void *arg, ulint worker, const byte *rec);
+
+/** Read the clustered index of a table by several threads in a consistent
+read. The index is split into ranges by node pointers of its upper levels,
+and each thread reads ranges with its own cursor in the read view of
+prebuilt->trx. The calling thread is one of the threads.
+@param prebuilt   template for the clustered index, without BLOB or
+                  virtual columns
+@param n_threads  maximum number of threads
+@param add_row    called by the threads for each row
+@param arg        first argument of add_row
+@return error code */
+dberr_t row_search_parallel(row_prebuilt_t *prebuilt, ulint n_threads,
+                            row_parallel_add_t add_row, void *arg)
+  MY_ATTRIBUTE((nonnull(1,3), warn_unused_result));
+
 /** Read the max AUTOINC value from an index.
 @param[in] index	index starting with an AUTO_INCREMENT column
 @return	the largest AUTO_INCREMENT value
@@ -194,6 +194,10 @@ enum monitor_id_t {
 	MONITOR_FLUSH_ADAPTIVE_AVG_PASS,
 
 	MONITOR_LRU_GET_FREE_LOOPS,
+	MONITOR_LRU_GHOST_HITS,
+	MONITOR_LRU_EVICT_UNACCESSED,
+	MONITOR_LRU_EVICT_OLD,
+	MONITOR_LRU_EVICT_YOUNG,
 
 	MONITOR_FLUSH_AVG_PAGE_RATE,
 	MONITOR_FLUSH_LSN_AVG_RATE,
@@ -293,6 +297,11 @@ enum monitor_id_t {
 	MONITOR_OVLD_LOG_WAITS,
 	MONITOR_OVLD_LOG_WRITE_REQUEST,
 	MONITOR_OVLD_LOG_WRITES,
+	MONITOR_LOG_COMMIT_WAIT_10US,
+	MONITOR_LOG_COMMIT_WAIT_100US,
+	MONITOR_LOG_COMMIT_WAIT_1MS,
+	MONITOR_LOG_COMMIT_WAIT_10MS,
+	MONITOR_LOG_COMMIT_WAIT_LONG,
 
 	/* Page Manager related counters */
 	MONITOR_MODULE_PAGE,
@@ -399,6 +399,8 @@ extern ulong srv_buf_dump_status_frequency;
 extern mysql_pfs_key_t	page_cleaner_thread_key;
 extern mysql_pfs_key_t	trx_rollback_clean_thread_key;
 extern mysql_pfs_key_t	thread_pool_thread_key;
+extern mysql_pfs_key_t	log_writer_thread_key;
+extern mysql_pfs_key_t	log_flusher_thread_key;
 
 /* This macro register the current thread and its key with performance
 schema */
@@ -592,6 +594,8 @@ struct export_var_t{
 #endif /* UNIV_DEBUG */
 	/** buf_pool.stat.n_page_gets (a sharded counter) */
 	ulint innodb_buffer_pool_read_requests;
+	/** buf_pool.stat.n_pages_young_skipped (a sharded counter) */
+	ulint innodb_buffer_pool_pages_made_young_skipped;
 	ulint innodb_checkpoint_age;
 	ulint innodb_checkpoint_max_age;
 	ulint innodb_data_pending_reads;	/*!< Pending reads */
@@ -621,6 +625,15 @@ struct export_var_t{
 						     / srv_n_lock_wait_count */
 	uint64_t innodb_row_lock_time_max;	/*!< srv_n_lock_max_wait_time */
 
+	/** time spent parsing the redo log during crash recovery, in ms */
+	ulonglong innodb_recovery_parse_time;
+	/** time spent applying the redo log during crash recovery, in ms */
+	ulonglong innodb_recovery_apply_time;
+	/** number of pages that crash recovery applied the redo log to */
+	ulint innodb_recovery_pages_applied;
+	/** comma-separated innodb_recovery_pages_applied of each thread */
+	char innodb_recovery_pages_applied_per_thread[512];
+
 	/** Number of undo tablespace truncation operations */
 	ulong innodb_undo_truncations;
 
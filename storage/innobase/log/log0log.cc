@@ -46,6 +46,9 @@ Created 12/9/1995 Heikki Tuuri
 #include "log0sync.h"
 #include "log.h"
 #include "tpool.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 /*
 General philosophy of InnoDB redo-logs:
@@ -1114,32 +1117,13 @@ static lsn_t log_flush(lsn_t lsn)
 
 static const completion_callback dummy_callback{[](void *) {},nullptr};
 
-/** Ensure that the log has been written to the log file up to a given
-log entry (such as that of a transaction commit). Start a new write, or
-wait and check if an already running write is covering the request.
+/** Write the log as the group commit lead, or wait for a concurrent write.
 @param lsn      log sequence number that should be included in the file write
 @param durable  whether the write needs to be durable
 @param callback log write completion callback */
-void log_write_up_to(lsn_t lsn, bool durable,
-                     const completion_callback *callback)
+static void log_write_up_to_low(lsn_t lsn, bool durable,
+                                const completion_callback *callback)
 {
-  ut_ad(!srv_read_only_mode || log_sys.buf_free_ok());
-  ut_ad(lsn != LSN_MAX);
-  ut_ad(lsn != 0);
-  ut_ad(lsn <= log_sys.get_lsn());
-
-#ifdef HAVE_PMEM
-  if (log_sys.is_mmap())
-  {
-    if (durable)
-      log_sys.persist(lsn, false);
-    else
-      ut_ad(!callback);
-    return;
-  }
-#endif
-  ut_ad(!log_sys.is_mmap());
-
 repeat:
   if (durable)
   {
@@ -1176,6 +1160,264 @@ void log_write_up_to(lsn_t lsn, bool durable,
   }
 }
 
+/** Dedicated log writer and flusher threads (innodb_log_writer_threads) */
+static std::thread log_writer, log_flusher;
+/** Protects log_threads_shutdown and the waits on the condition variables */
+static std::mutex log_threads_mutex;
+/** Signalled when there may be log to write */
+static std::condition_variable log_writer_cond;
+/** Signalled when there may be written log to flush */
+static std::condition_variable log_flusher_cond;
+/** Whether log_writer, log_flusher are waiting for a signal */
+static std::atomic<bool> log_writer_idle, log_flusher_idle;
+/** Whether log_writer, log_flusher should exit */
+static bool log_threads_shutdown;
+/** Whether log_write_up_to() waits for log_writer and log_flusher */
+static Atomic_relaxed<bool> log_threads_active;
+/** Moving averages of the log write and fsync latency, in nanoseconds */
+static Atomic_relaxed<ulonglong> log_write_latency, log_flush_latency;
+/** Maximum expected latency that waiting threads will spin for,
+in nanoseconds; on slower storage, they go to sleep immediately */
+static constexpr ulonglong LOG_SPIN_MAX= 100000;
+
+my_bool innodb_log_writer_threads;
+
+#ifdef UNIV_PFS_THREAD
+mysql_pfs_key_t log_writer_thread_key;
+mysql_pfs_key_t log_flusher_thread_key;
+#endif /* UNIV_PFS_THREAD */
+
+/** Update a moving average of log_write_latency or log_flush_latency.
+This is only invoked by the single thread that measures the latency. */
+static void log_latency_update(Atomic_relaxed<ulonglong> &avg, ulonglong ns)
+{
+  const ulonglong a= avg;
+  avg= a - a / 8 + ns / 8;
+}
+
+/** Wake up log_writer and log_flusher if they are waiting */
+static void log_threads_wake()
+{
+  /* Pairs with the fence in log_thread_idle() */
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (log_writer_idle.load(std::memory_order_relaxed) ||
+      log_flusher_idle.load(std::memory_order_relaxed))
+  {
+    std::lock_guard<std::mutex> g{log_threads_mutex};
+    log_writer_cond.notify_one();
+    log_flusher_cond.notify_one();
+  }
+}
+
+/** @return whether there is log for log_writer to write */
+static bool log_writer_has_work()
+{
+  return !log_sys.is_mmap() &&
+    log_sys.get_lsn(std::memory_order_acquire) > write_lock.value();
+}
+
+/** @return whether there is written log for log_flusher to flush */
+static bool log_flusher_has_work()
+{
+  return !log_sys.is_mmap() && write_lock.value() > flush_lock.value();
+}
+
+/** Wait in log_writer or log_flusher for more work.
+@param lk        lock on log_threads_mutex
+@param cond      log_writer_cond or log_flusher_cond
+@param idle      log_writer_idle or log_flusher_idle
+@param has_work  log_writer_has_work or log_flusher_has_work */
+static void log_thread_idle(std::unique_lock<std::mutex> &lk,
+                            std::condition_variable &cond,
+                            std::atomic<bool> &idle, bool (*has_work)())
+{
+  idle.store(true, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  /* No timeout is needed. log_write_wait() invokes log_threads_wake()
+  before it goes to sleep, log_writer wakes up log_flusher after each
+  write, and log_flusher wakes up log_writer when release() reports
+  waiters beyond what has been written. The writes that bypass
+  log_write_up_to() wake us up in the same way. */
+  if (!has_work() && !log_threads_shutdown)
+    cond.wait(lk);
+  idle.store(false, std::memory_order_relaxed);
+}
+
+/** The dedicated log writer thread */
+static void log_writer_thread()
+{
+  my_thread_init();
+#ifdef UNIV_PFS_THREAD
+  pfs_register_thread(log_writer_thread_key);
+#endif /* UNIV_PFS_THREAD */
+  my_thread_set_name("ib_log_writer");
+
+  std::unique_lock<std::mutex> lk{log_threads_mutex};
+  while (!log_threads_shutdown)
+  {
+    if (log_writer_has_work())
+    {
+      lk.unlock();
+      const ulonglong start{my_interval_timer()};
+      /* If release() reports that some waiters are left behind,
+      log_write_up_to_low() will write again for them. */
+      log_write_up_to_low(log_sys.get_lsn(), false, nullptr);
+      log_latency_update(log_write_latency, my_interval_timer() - start);
+      lk.lock();
+      if (log_flusher_idle.load(std::memory_order_relaxed))
+        log_flusher_cond.notify_one();
+    }
+    else
+      log_thread_idle(lk, log_writer_cond, log_writer_idle,
+                      log_writer_has_work);
+  }
+  lk.unlock();
+
+  my_thread_end();
+#ifdef UNIV_PFS_THREAD
+  pfs_delete_thread();
+#endif
+}
+
+/** The dedicated log flusher thread */
+static void log_flusher_thread()
+{
+  my_thread_init();
+#ifdef UNIV_PFS_THREAD
+  pfs_register_thread(log_flusher_thread_key);
+#endif /* UNIV_PFS_THREAD */
+  my_thread_set_name("ib_log_flusher");
+
+  std::unique_lock<std::mutex> lk{log_threads_mutex};
+  while (!log_threads_shutdown)
+  {
+    if (log_flusher_has_work())
+    {
+      lk.unlock();
+      const lsn_t lsn{write_lock.value()};
+      lsn_t pending_lsn= 0;
+      if (flush_lock.acquire(lsn, nullptr) == group_commit_lock::ACQUIRED)
+      {
+        flush_lock.set_pending(lsn);
+        const ulonglong start{my_interval_timer()};
+        pending_lsn= log_flush(lsn);
+        log_latency_update(log_flush_latency, my_interval_timer() - start);
+      }
+      lk.lock();
+      /* Someone is waiting for a durable write beyond lsn. If that
+      part of the log has been written, our next iteration will flush
+      it; otherwise, it must be written first. */
+      if (pending_lsn > write_lock.value() &&
+          log_writer_idle.load(std::memory_order_relaxed))
+        log_writer_cond.notify_one();
+    }
+    else
+      log_thread_idle(lk, log_flusher_cond, log_flusher_idle,
+                      log_flusher_has_work);
+  }
+  lk.unlock();
+
+  my_thread_end();
+#ifdef UNIV_PFS_THREAD
+  pfs_delete_thread();
+#endif
+}
+
+void log_writer_threads_start()
+{
+  ut_ad(!srv_read_only_mode);
+  if (!innodb_log_writer_threads || log_writer.joinable())
+    return;
+  log_threads_shutdown= false;
+  log_writer= std::thread(log_writer_thread);
+  log_flusher= std::thread(log_flusher_thread);
+  log_threads_active= true;
+}
+
+void log_writer_threads_stop()
+{
+  if (!log_writer.joinable())
+    return;
+  log_threads_active= false;
+  {
+    std::lock_guard<std::mutex> g{log_threads_mutex};
+    log_threads_shutdown= true;
+    log_writer_cond.notify_one();
+    log_flusher_cond.notify_one();
+  }
+  log_writer.join();
+  log_flusher.join();
+  /* Wake up anyone who started to wait before log_threads_active
+  was reset. */
+  if (!log_sys.is_mmap())
+    log_write_up_to_low(log_sys.get_lsn(), true, nullptr);
+}
+
+/** Wait for log_writer and log_flusher.
+@param lsn      log sequence number that should be included in the file write
+@param durable  whether the write needs to be durable
+@param callback log write completion callback */
+static void log_write_wait(lsn_t lsn, bool durable,
+                           const completion_callback *callback)
+{
+  /* Spin if the wait is expected to be short; otherwise sleep. */
+  ulonglong expected= log_write_latency;
+  if (durable)
+    expected+= log_flush_latency;
+  const ulonglong spin_ns{expected <= LOG_SPIN_MAX ? expected : 0};
+
+  group_commit_lock &lock= durable ? flush_lock : write_lock;
+  if (lsn > lock.value())
+    log_threads_wake();
+  lock.wait(lsn, callback, spin_ns);
+}
+
+void log_commit_wait_record(ulonglong ns)
+{
+  if (ns < 10000)
+    MONITOR_ATOMIC_INC(MONITOR_LOG_COMMIT_WAIT_10US);
+  else if (ns < 100000)
+    MONITOR_ATOMIC_INC(MONITOR_LOG_COMMIT_WAIT_100US);
+  else if (ns < 1000000)
+    MONITOR_ATOMIC_INC(MONITOR_LOG_COMMIT_WAIT_1MS);
+  else if (ns < 10000000)
+    MONITOR_ATOMIC_INC(MONITOR_LOG_COMMIT_WAIT_10MS);
+  else
+    MONITOR_ATOMIC_INC(MONITOR_LOG_COMMIT_WAIT_LONG);
+}
+
+/** Ensure that the log has been written to the log file up to a given
+log entry (such as that of a transaction commit). Start a new write, or
+wait and check if an already running write is covering the request.
+@param lsn      log sequence number that should be included in the file write
+@param durable  whether the write needs to be durable
+@param callback log write completion callback */
+void log_write_up_to(lsn_t lsn, bool durable,
+                     const completion_callback *callback)
+{
+  ut_ad(!srv_read_only_mode || log_sys.buf_free_ok());
+  ut_ad(lsn != LSN_MAX);
+  ut_ad(lsn != 0);
+  ut_ad(lsn <= log_sys.get_lsn());
+
+#ifdef HAVE_PMEM
+  if (log_sys.is_mmap())
+  {
+    if (durable)
+      log_sys.persist(lsn, false);
+    else
+      ut_ad(!callback);
+    return;
+  }
+#endif
+  ut_ad(!log_sys.is_mmap());
+
+  if (log_threads_active)
+    log_write_wait(lsn, durable, callback);
+  else
+    log_write_up_to_low(lsn, durable, callback);
+}
+
 /** Write to the log file up to the last log entry.
 @param durable  whether to wait for a durable write to complete */
 void log_buffer_flush_to_disk(bool durable)
@@ -1244,8 +1486,12 @@ ATTRIBUTE_COLD void log_write_and_flush()
 #endif
   {
     const lsn_t lsn{log_sys.write_buf<false>()};
-    write_lock.release(lsn);
-    log_flush(lsn);
+    lsn_t pending_lsn= write_lock.release(lsn);
+    pending_lsn= std::max(pending_lsn, log_flush(lsn));
+    /* We are holding log_sys.latch and cannot write any further.
+    Let the dedicated threads take care of anyone left waiting. */
+    if (pending_lsn && log_threads_active)
+      log_threads_wake();
   }
 }
 
@@ -1348,6 +1348,12 @@ void recv_sys_t::create()
 	file_checkpoint = 0;
 
 	progress_time = time(NULL);
+	parse_time = 0;
+	apply_time = 0;
+	apply_threads = 0;
+	for (auto &n : pages_applied) {
+		n = 0;
+	}
 	ut_ad(pages.empty());
 	pages_it = pages.end();
 	recv_max_page_lsn = 0;
@@ -3067,6 +3073,8 @@ static buf_block_t *recv_recover_page(buf_block_t *block, mtr_t &mtr,
 	ut_ad(!space || space->id == block->page.id().space());
 	ut_ad(log_sys.is_latest());
 
+	recv_sys.count_applied();
+
 	if (UNIV_UNLIKELY(srv_print_verbose_log == 2)) {
 		ib::info() << "Applying log to page " << block->page.id();
 	}
@@ -3411,6 +3419,49 @@ bool recv_sys_t::report(time_t time)
   return true;
 }
 
+/** The pages_applied[] slot of the current thread, or ~0U if not assigned */
+static thread_local unsigned recv_apply_slot= ~0U;
+
+inline void recv_sys_t::count_applied()
+{
+  if (UNIV_UNLIKELY(recv_apply_slot == ~0U))
+    recv_apply_slot= std::min(apply_threads++, APPLY_THREADS_MAX - 1);
+  pages_applied[recv_apply_slot]++;
+}
+
+ATTRIBUTE_COLD
+void recv_sys_t::report_apply_stats() const
+{
+  const unsigned n_threads{std::min(unsigned{apply_threads},
+                                    APPLY_THREADS_MAX)};
+  size_t total= 0;
+  char *s= export_vars.innodb_recovery_pages_applied_per_thread;
+  const char *const end= s +
+    sizeof export_vars.innodb_recovery_pages_applied_per_thread;
+  *s= '\0';
+  for (unsigned i= 0; i < n_threads; i++)
+  {
+    const size_t n{pages_applied[i]};
+    total+= n;
+    if (end - s > 1)
+      s+= std::min<ptrdiff_t>(snprintf(s, size_t(end - s), i ? ",%zu" : "%zu",
+                                       n), end - s - 1);
+  }
+
+  export_vars.innodb_recovery_parse_time= parse_time / 1000;
+  export_vars.innodb_recovery_apply_time= apply_time / 1000;
+  export_vars.innodb_recovery_pages_applied= total;
+
+  sql_print_information("InnoDB: Parsed the log in %llu.%03llus;"
+                        " applied it to %zu pages in %llu.%03llus"
+                        " by %u threads: %s",
+                        parse_time / 1000000, parse_time / 1000 % 1000,
+                        total,
+                        apply_time / 1000000, apply_time / 1000 % 1000,
+                        n_threads,
+                        export_vars.innodb_recovery_pages_applied_per_thread);
+}
+
 ATTRIBUTE_COLD
 void recv_sys_t::report_progress() const
 {
@@ -3810,6 +3861,8 @@ void recv_sys_t::apply(bool last_batch)
 
   mysql_mutex_assert_owner(&mutex);
 
+  const ulonglong start{my_interval_timer()};
+
   garbage_collect();
 
   if (truncated_sys_space.lsn)
@@ -3910,6 +3963,7 @@ void recv_sys_t::apply(bool last_batch)
             mysql_mutex_unlock(&buf_pool.mutex);
             mysql_mutex_lock(&mutex);
           }
+          apply_time+= (my_interval_timer() - start) / 1000;
           return;
         }
         if (apply_batch(space_id, space, free_block, last_batch))
@@ -3954,6 +4008,10 @@ void recv_sys_t::apply(bool last_batch)
 
   mysql_mutex_lock(&mutex);
 
+  apply_time+= (my_interval_timer() - start) / 1000;
+  if (last_batch && apply_threads)
+    report_apply_stats();
+
   ut_d(after_apply= true);
   clear();
 }
@@ -3965,6 +4023,18 @@ static bool recv_scan_log(bool last_phase)
 {
   DBUG_ENTER("recv_scan_log");
 
+  /** Accumulate the parsing time, excluding any nested recv_sys.apply() */
+  struct parse_timer
+  {
+    const ulonglong start{my_interval_timer()};
+    const ulonglong apply_time{recv_sys.apply_time};
+    ~parse_timer()
+    {
+      recv_sys.parse_time+= (my_interval_timer() - start) / 1000 -
+        (recv_sys.apply_time - apply_time);
+    }
+  } timer;
+
   ut_ad(log_sys.is_latest());
   const size_t block_size_1{log_sys.write_size - 1};
 
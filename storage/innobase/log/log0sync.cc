@@ -278,6 +278,51 @@ group_commit_lock::lock_return_code group_commit_lock::acquire(value_type num, c
   return lock_return_code::EXPIRED;
 }
 
+group_commit_lock::lock_return_code
+group_commit_lock::wait(value_type num, const completion_callback *callback,
+                        ulonglong spin_ns)
+{
+  if (spin_ns && num > value())
+  {
+    const ulonglong deadline= my_interval_timer() + spin_ns;
+    do
+      MY_RELAX_CPU();
+    while (num > value() && my_interval_timer() < deadline);
+  }
+
+  std::unique_lock<std::mutex> lk(m_mtx, std::defer_lock);
+  while (num > value())
+  {
+    lk.lock();
+    if (num <= value())
+    {
+      lk.unlock();
+      break;
+    }
+
+    if (callback)
+    {
+      m_pending_callbacks.push_back({num, *callback});
+      return lock_return_code::CALLBACK_QUEUED;
+    }
+
+    /* release() may designate us as the next group commit lead,
+    but the lock is only taken by the dedicated threads. In that case,
+    we will merely check the value and go back to sleep. */
+    thread_local_waiter.m_value= num;
+    thread_local_waiter.m_group_commit_leader= false;
+    thread_local_waiter.m_next= m_waiters_list;
+    m_waiters_list= &thread_local_waiter;
+    lk.unlock();
+
+    thd_wait_begin(0, THD_WAIT_GROUP_COMMIT);
+    thread_local_waiter.m_sema.wait();
+    thd_wait_end(0);
+  }
+  do_completion_callback(callback);
+  return lock_return_code::EXPIRED;
+}
+
 group_commit_lock::value_type group_commit_lock::release(value_type num)
 {
   completion_callback callbacks[1000];
@@ -39,7 +39,7 @@ It has a state consisting of
 
 Operations supported on this semaphore
 
-1.acquire(num, callback):
+1. acquire(num, callback):
 - waits until current value exceeds num, or until lock is granted.
   if running synchronously (callback is nullptr)
 
@@ -48,7 +48,7 @@ Operations supported on this semaphore
   or CALLBACK_QUEUED, if callback was not nullptr, and function
   would otherwise have to wait
 
-2.release(num)
+2. release(num)
 - releases lock
 - sets new current value to max(num,current_value)
 - releases some threads waiting in acquire()
@@ -57,13 +57,19 @@ Operations supported on this semaphore
   callbacks left, and there is no new group commit lead
   (i.e caller must do something to flush those pending callbacks)
 
-3. value()
+3. wait(num, callback, spin_ns)
+- like acquire(), but never grants the lock; used when dedicated
+  threads are the only lock holders (innodb_log_writer_threads)
+- spins for up to spin_ns nanoseconds, then sleeps until
+  current value exceeds num
+
+4. value()
 - read current value
 
-4. pending_value()
+5. pending_value()
 - read pending value
 
-5. set_pending_value()
+6. set_pending_value()
 */
 class group_commit_lock
 {
@@ -89,6 +95,8 @@ class group_commit_lock
     CALLBACK_QUEUED
   };
   lock_return_code acquire(value_type num, const completion_callback *cb);
+  lock_return_code wait(value_type num, const completion_callback *cb,
+                        ulonglong spin_ns);
   value_type release(value_type num);
   value_type value() const;
   value_type pending() const;
@@ -53,6 +53,9 @@ Created 12/19/1997 Heikki Tuuri
 #ifdef WITH_WSREP
 #include "mysql/service_wsrep.h" /* For wsrep_thd_skip_locking */
 #endif
+#include <atomic>
+#include <thread>
+#include <vector>
 
 /* Maximum number of rows to prefetch; MySQL interface has another parameter */
 #define SEL_MAX_N_PREFETCH	16
@@ -5625,7 +5628,30 @@ row_search_mvcc(
 	by a page latch that was acquired when pcur was positioned.
 	The latch will not be released until mtr.commit(). */
 
-	if ((match_mode == ROW_SEL_EXACT
+	if (prebuilt->bulk_buf) {
+		/* A bulk fetch: the same restrictions as for the
+		prefetch below were checked by the caller. The rows are
+		converted directly into the buffer of the caller. */
+		ut_ad(prebuilt->select_lock_type == LOCK_NONE);
+		ut_ad(!prebuilt->templ_contains_blob);
+		ut_ad(!prebuilt->pk_filter && !prebuilt->idx_cond);
+		ut_ad(prebuilt->n_bulk < prebuilt->bulk_max);
+
+		if (!row_sel_store_mysql_rec(
+			    prebuilt->bulk_buf
+			    + prebuilt->n_bulk * prebuilt->bulk_stride,
+			    prebuilt, result_rec, vrow,
+			    result_rec != rec,
+			    result_rec != rec ? clust_index : index,
+			    offsets)) {
+			/* Skip incomplete fresh inserts, as below */
+			goto next_rec;
+		}
+
+		if (++prebuilt->n_bulk < prebuilt->bulk_max) {
+			goto next_rec;
+		}
+	} else if ((match_mode == ROW_SEL_EXACT
 	     || prebuilt->n_rows_fetched >= MYSQL_FETCH_CACHE_THRESHOLD)
 	    && prebuilt->select_lock_type == LOCK_NONE
 	    && !prebuilt->templ_contains_blob
@@ -5939,6 +5965,14 @@ row_search_mvcc(
 
 		DEBUG_SYNC_C("row_search_cached_row");
 		err = DB_SUCCESS;
+
+	} else if (prebuilt->bulk_buf && prebuilt->n_bulk
+		   && err == DB_END_OF_INDEX) {
+
+		/* The end of the index was reached after some rows
+		were stored into the bulk buffer. */
+
+		err = DB_SUCCESS;
 	}
 
 #ifdef UNIV_DEBUG
@@ -6967,3 +7001,341 @@ row_search_max_autoinc(dict_index_t* index)
 	mtr.commit();
 	return(value);
 }
+
+/** Number of ranges per thread of row_search_parallel(). More ranges
+than threads let the threads that are done early help the others. */
+static constexpr ulint ROW_PARALLEL_RANGES_PER_THREAD= 4;
+
+/** Number of records that row_search_parallel() reads before it
+releases the page latch and checks for interruption. */
+static constexpr ulint ROW_PARALLEL_RECS_PER_MTR= 1000;
+
+/** State of row_search_parallel() that is shared by the threads */
+struct row_parallel_scan_t
+{
+  row_prebuilt_t *prebuilt;
+  /** Boundaries of the ranges: range r is [bounds[r - 1], bounds[r]),
+  where the missing ends are the ends of the index */
+  std::vector<const dtuple_t*> bounds;
+  /** The next range that is to be read */
+  std::atomic<ulint> next_range;
+  /** Set when the threads should stop */
+  std::atomic<bool> stop;
+  /** The first error */
+  std::atomic<dberr_t> err;
+  row_parallel_add_t add_row;
+  void *arg;
+
+  void set_error(dberr_t e)
+  {
+    dberr_t success= DB_SUCCESS;
+    err.compare_exchange_strong(success, e);
+    stop= true;
+  }
+};
+
+/** Split the clustered index into ranges by the node pointers of the
+highest level of the tree that has at least n_ranges of them, or of the
+level above the leaves.
+@param index     clustered index
+@param n_ranges  wanted number of ranges
+@param bounds    the boundaries between the ranges
+@param heap      memory heap for the boundaries
+@return error code */
+static dberr_t row_parallel_split(dict_index_t *index, ulint n_ranges,
+                                  std::vector<const dtuple_t*> &bounds,
+                                  mem_heap_t *heap)
+{
+  mtr_t mtr;
+  dberr_t err;
+  mem_heap_t *offsets_heap= nullptr;
+  rec_offs *offsets= nullptr;
+  const ulint n_uniq= dict_index_get_n_unique_in_tree_nonleaf(index);
+
+  mtr.start();
+  mtr_s_lock_index(index, &mtr);
+  buf_block_t *root= btr_root_block_get(index, RW_S_LATCH, &mtr, &err);
+  if (!root)
+  {
+    mtr.commit();
+    return err;
+  }
+
+  std::vector<buf_block_t*> level(1, root);
+  std::vector<const dtuple_t*> keys;
+
+  for (ulint height= btr_page_get_level(root->page.frame); height; height--)
+  {
+    ulint n_recs= 0;
+    for (const buf_block_t *block : level)
+      n_recs+= page_get_n_recs(block->page.frame);
+
+    if (n_recs >= n_ranges || height == 1)
+    {
+      for (const buf_block_t *block : level)
+      {
+        const page_t *page= block->page.frame;
+        for (const rec_t *rec=
+               page_rec_get_next_const(page_get_infimum_rec(page));
+             rec && !page_rec_is_supremum(rec);
+             rec= page_rec_get_next_const(rec))
+        {
+          /* The leftmost node pointer of a level has no key */
+          if (rec_get_info_bits(rec, page_is_comp(page))
+              & REC_INFO_MIN_REC_FLAG)
+            continue;
+          dtuple_t *tuple= dtuple_create(heap, n_uniq);
+          dict_index_copy_types(tuple, index, n_uniq);
+          rec_copy_prefix_to_dtuple(tuple, rec, index, 0, n_uniq, heap);
+          keys.push_back(tuple);
+        }
+      }
+      break;
+    }
+
+    std::vector<buf_block_t*> children;
+    for (const buf_block_t *block : level)
+    {
+      const page_t *page= block->page.frame;
+      for (const rec_t *rec=
+             page_rec_get_next_const(page_get_infimum_rec(page));
+           rec && !page_rec_is_supremum(rec);
+           rec= page_rec_get_next_const(rec))
+      {
+        offsets= rec_get_offsets(rec, index, offsets, 0, ULINT_UNDEFINED,
+                                 &offsets_heap);
+        buf_block_t *child= buf_page_get_gen(
+          page_id_t(index->table->space_id,
+                    btr_node_ptr_get_child_page_no(rec, offsets)),
+          index->table->space->zip_size(), RW_S_LATCH, nullptr, BUF_GET,
+          &mtr, &err);
+        if (!child)
+          goto func_exit;
+        children.push_back(child);
+      }
+    }
+    level.swap(children);
+  }
+
+  /* Keep n_ranges - 1 boundaries, evenly spaced */
+  if (keys.size() < n_ranges)
+    bounds= keys;
+  else
+    for (ulint i= 1; i < n_ranges; i++)
+      bounds.push_back(keys[i * keys.size() / n_ranges]);
+
+func_exit:
+  mtr.commit();
+  if (offsets_heap)
+    mem_heap_free(offsets_heap);
+  return err;
+}
+
+/** Read one range of the clustered index in a parallel scan.
+@param scan    the scan
+@param r       number of the range
+@param worker  number of the thread
+@param buf     record buffer of the thread
+@return error code */
+static dberr_t row_parallel_read_range(row_parallel_scan_t *scan, ulint r,
+                                       ulint worker, byte *buf)
+{
+  row_prebuilt_t *prebuilt= scan->prebuilt;
+  trx_t *trx= prebuilt->trx;
+  dict_index_t *index= dict_table_get_first_index(prebuilt->table);
+  const bool comp= dict_table_is_comp(prebuilt->table);
+  const dtuple_t *start= r ? scan->bounds[r - 1] : nullptr;
+  const dtuple_t *end= r < scan->bounds.size() ? scan->bounds[r] : nullptr;
+  rec_offs offsets_[REC_OFFS_NORMAL_SIZE];
+  rec_offs *offsets= offsets_;
+  mem_heap_t *heap= nullptr;
+  mem_heap_t *vers_heap= mem_heap_create(200);
+  btr_pcur_t pcur;
+  mtr_t mtr;
+  dberr_t err;
+
+  rec_offs_init(offsets_);
+  mtr.start();
+
+  if (start)
+    err= btr_pcur_open_on_user_rec(start, BTR_SEARCH_LEAF, &pcur, &mtr);
+  else if ((err= pcur.open_leaf(true, index, BTR_SEARCH_LEAF, &mtr))
+           == DB_SUCCESS)
+    btr_pcur_move_to_next_user_rec(&pcur, &mtr);
+
+  for (ulint n_recs= 0; err == DB_SUCCESS && btr_pcur_is_on_user_rec(&pcur);)
+  {
+    const rec_t *rec= btr_pcur_get_rec(&pcur);
+    offsets= rec_get_offsets(rec, index, offsets, index->n_core_fields,
+                             ULINT_UNDEFINED, &heap);
+
+    if (end && cmp_dtuple_rec(end, rec, index, offsets) <= 0)
+      break;
+
+    if (rec_is_metadata(rec, *index))
+      goto next_rec;
+
+    if (trx->isolation_level > TRX_ISO_READ_UNCOMMITTED)
+    {
+      switch (err= row_sel_clust_sees(rec, *index, offsets,
+                                      trx->read_view)) {
+      case DB_SUCCESS:
+        break;
+      case DB_SUCCESS_LOCKED_REC:
+        rec_t *old_vers;
+        mem_heap_empty(vers_heap);
+        err= row_vers_build_for_consistent_read(
+          rec, &mtr, index, &offsets, &trx->read_view, &heap, vers_heap,
+          &old_vers, nullptr);
+        if (err != DB_SUCCESS)
+          continue;
+        if (!old_vers)
+          goto next_rec;                /* not in the read view */
+        rec= old_vers;
+        break;
+      default:
+        continue;
+      }
+    }
+
+    if (rec_get_deleted_flag(rec, comp))
+      goto next_rec;
+
+    if (row_sel_store_mysql_rec(buf, prebuilt, rec, nullptr, true, index,
+                                offsets) &&
+        scan->add_row(scan->arg, worker, buf))
+      scan->stop= true;
+
+next_rec:
+    if (scan->stop)
+      break;
+
+    if (++n_recs % ROW_PARALLEL_RECS_PER_MTR == 0)
+    {
+      btr_pcur_store_position(&pcur, &mtr);
+      mtr.commit();
+      if (trx_is_interrupted(trx))
+      {
+        err= DB_INTERRUPTED;
+        goto func_exit;
+      }
+      mtr.start();
+      if (pcur.restore_position(BTR_SEARCH_LEAF, &mtr)
+          == btr_pcur_t::CORRUPTED)
+      {
+        err= DB_CORRUPTION;
+        break;
+      }
+    }
+
+    if (!btr_pcur_move_to_next_user_rec(&pcur, &mtr))
+      break;
+  }
+
+  mtr.commit();
+func_exit:
+  btr_pcur_close(&pcur);
+  mem_heap_free(vers_heap);
+  if (heap)
+    mem_heap_free(heap);
+  return err;
+}
+
+/** Read ranges of a parallel scan until none is left.
+@param scan    the scan
+@param worker  number of the thread */
+static void row_parallel_worker(row_parallel_scan_t *scan, ulint worker)
+{
+  row_prebuilt_t *prebuilt= scan->prebuilt;
+  byte *buf= static_cast<byte*>(ut_malloc_nokey(prebuilt->mysql_row_len));
+
+  memcpy(buf, prebuilt->default_rec, prebuilt->mysql_row_len);
+
+  while (!scan->stop)
+  {
+    const ulint r= scan->next_range++;
+    if (r > scan->bounds.size())
+      break;
+    if (trx_is_interrupted(prebuilt->trx))
+    {
+      scan->set_error(DB_INTERRUPTED);
+      break;
+    }
+    if (dberr_t err= row_parallel_read_range(scan, r, worker, buf))
+      scan->set_error(err);
+  }
+
+  ut_free(buf);
+}
+
+/** Read the clustered index of a table by several threads.
+@param prebuilt   template for the clustered index; the read view of
+                  prebuilt->trx must be open unless it is READ UNCOMMITTED
+@param n_threads  maximum number of threads, including the caller
+@param add_row    called by the threads for each row of the read view
+@param arg        first argument of add_row
+@return error code */
+dberr_t row_search_parallel(row_prebuilt_t *prebuilt, ulint n_threads,
+                            row_parallel_add_t add_row, void *arg)
+{
+  dict_index_t *index= dict_table_get_first_index(prebuilt->table);
+  row_parallel_scan_t scan;
+  std::vector<std::thread> threads;
+
+  ut_ad(prebuilt->index == index);
+  ut_ad(prebuilt->select_lock_type == LOCK_NONE);
+  ut_ad(!prebuilt->blob_heap);
+  ut_ad(n_threads);
+
+  /* See row_search_mvcc() for a comment on bulk_trx_id */
+  if (prebuilt->trx->isolation_level > TRX_ISO_READ_UNCOMMITTED &&
+      prebuilt->trx->read_view.is_open())
+    if (trx_id_t bulk_trx_id= index->table->bulk_trx_id)
+      if (!prebuilt->trx->read_view.changes_visible(bulk_trx_id))
+        return DB_SUCCESS;
+
+  scan.prebuilt= prebuilt;
+  scan.next_range= 0;
+  scan.stop= false;
+  scan.err= DB_SUCCESS;
+  scan.add_row= add_row;
+  scan.arg= arg;
+
+  mem_heap_t *heap= mem_heap_create(1024);
+  dberr_t err= row_parallel_split(index,
+                                  n_threads * ROW_PARALLEL_RANGES_PER_THREAD,
+                                  scan.bounds, heap);
+  if (err != DB_SUCCESS)
+  {
+    mem_heap_free(heap);
+    return err;
+  }
+
+  n_threads= std::min<ulint>(n_threads, scan.bounds.size() + 1);
+
+  /* The caller is the last of the threads */
+  for (ulint i= 0; i + 1 < n_threads; i++)
+  {
+    try
+    {
+      threads.emplace_back([&scan, i]() {
+        my_thread_init();
+        row_parallel_worker(&scan, i);
+        my_thread_end();
+      });
+    }
+    catch (const std::system_error &)
+    {
+      n_threads= i + 1;
+      break;
+    }
+  }
+  row_parallel_worker(&scan, n_threads - 1);
+
+  for (std::thread &thread : threads)
+    thread.join();
+
+  mem_heap_free(heap);
+  return scan.err;
+}
+
@@ -363,6 +363,26 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_NONE,
 	 MONITOR_DEFAULT_START, MONITOR_LRU_GET_FREE_LOOPS},
 
+	{"buffer_LRU_ghost_hits", "buffer",
+	 "Pages read again soon after eviction (innodb_lru_policy=2Q)",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LRU_GHOST_HITS},
+
+	{"buffer_LRU_evict_unaccessed", "buffer",
+	 "Pages evicted without having been accessed",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LRU_EVICT_UNACCESSED},
+
+	{"buffer_LRU_evict_old", "buffer",
+	 "Accessed pages evicted from the old blocks of the LRU list",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LRU_EVICT_OLD},
+
+	{"buffer_LRU_evict_young", "buffer",
+	 "Pages evicted from the young blocks of the LRU list",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LRU_EVICT_YOUNG},
+
 	{"buffer_flush_avg_page_rate", "buffer",
 	 "Average number of pages at which flushing is happening",
 	 MONITOR_NONE,
@@ -760,6 +780,36 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_EXISTING | MONITOR_DEFAULT_ON),
 	 MONITOR_DEFAULT_START, MONITOR_OVLD_LOG_WRITES},
 
+	{"log_commit_wait_10us", "recovery",
+	 "Number of transaction commits that waited less than 10 microseconds"
+	 " for a durable log write",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOG_COMMIT_WAIT_10US},
+
+	{"log_commit_wait_100us", "recovery",
+	 "Number of transaction commits that waited 10 to 100 microseconds"
+	 " for a durable log write",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOG_COMMIT_WAIT_100US},
+
+	{"log_commit_wait_1ms", "recovery",
+	 "Number of transaction commits that waited 0.1 to 1 milliseconds"
+	 " for a durable log write",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOG_COMMIT_WAIT_1MS},
+
+	{"log_commit_wait_10ms", "recovery",
+	 "Number of transaction commits that waited 1 to 10 milliseconds"
+	 " for a durable log write",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOG_COMMIT_WAIT_10MS},
+
+	{"log_commit_wait_long", "recovery",
+	 "Number of transaction commits that waited 10 milliseconds or more"
+	 " for a durable log write",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOG_COMMIT_WAIT_LONG},
+
 	/* ========== Counters for Page Compression ========== */
 	{"module_compress", "compression", "Page Compression Info",
 	 MONITOR_MODULE,
@@ -1963,6 +1963,10 @@ dberr_t srv_start(bool create_new_db)
 		fil_crypt_threads_cond. */
 		fil_crypt_threads_init();
 
+		if (srv_operation <= SRV_OPERATION_EXPORT_RESTORED) {
+			log_writer_threads_start();
+		}
+
 		srv_started_redo = true;
 	}
 
@@ -2033,6 +2037,7 @@ void innodb_shutdown()
 	case SRV_OPERATION_EXPORT_RESTORED:
 		/* Shut down the persistent files. */
 		logs_empty_and_mark_files_at_shutdown();
+		log_writer_threads_stop();
 	}
 
 	os_aio_free();
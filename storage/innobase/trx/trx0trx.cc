@@ -1278,7 +1278,14 @@ static void trx_flush_log_if_needed(lsn_t lsn, trx_t *trx)
     }
   }
   trx->op_info= "flushing log";
-  log_write_up_to(lsn, flush);
+  if (flush && MONITOR_IS_ON(MONITOR_LOG_COMMIT_WAIT_10US))
+  {
+    const ulonglong start{my_interval_timer()};
+    log_write_up_to(lsn, true);
+    log_commit_wait_record(my_interval_timer() - start);
+  }
+  else
+    log_write_up_to(lsn, flush);
   trx->op_info= "";
 }
 
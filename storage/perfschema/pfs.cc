@@ -7012,6 +7012,28 @@ void pfs_set_prepared_stmt_text_v1(PSI_prepared_stmt *prepared_stmt,
   return;
 }
 
+void pfs_plan_prepared_stmt_v1(PSI_prepared_stmt *prepared_stmt,
+                               PSI_prepared_stmt_plan_event event)
+{
+  PFS_prepared_stmt *pfs_prepared_stmt =
+    reinterpret_cast<PFS_prepared_stmt *>(prepared_stmt);
+  DBUG_ASSERT(pfs_prepared_stmt != NULL);
+
+  switch (event)
+  {
+  case PSI_PS_PLAN_HIT:
+    pfs_prepared_stmt->m_plan_hit_stat.aggregate_counted();
+    break;
+  case PSI_PS_PLAN_MISS:
+    pfs_prepared_stmt->m_plan_miss_stat.aggregate_counted();
+    break;
+  case PSI_PS_PLAN_INVALIDATE:
+    pfs_prepared_stmt->m_plan_invalidate_stat.aggregate_counted();
+    break;
+  }
+  return;
+}
+
 /**
   Implementation of the instrumentation interface.
   @sa PSI_v1.
@@ -7153,7 +7175,8 @@ PSI_v1 PFS_v1=
   pfs_destroy_metadata_lock_v1,
   pfs_start_metadata_wait_v1,
   pfs_end_metadata_wait_v1,
-  pfs_set_thread_peer_port_v1
+  pfs_set_thread_peer_port_v1,
+  pfs_plan_prepared_stmt_v1
 };
 
 static void* get_interface(int version)
@@ -62,6 +62,9 @@ void PFS_prepared_stmt::reset_data()
   m_prepare_stat.reset();
   m_reprepare_stat.reset();
   m_execute_stat.reset();
+  m_plan_hit_stat.reset();
+  m_plan_miss_stat.reset();
+  m_plan_invalidate_stat.reset();
 }
 
 static void fct_reset_prepared_stmt_instances(PFS_prepared_stmt *pfs)
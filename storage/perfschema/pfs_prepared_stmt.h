@@ -77,6 +77,15 @@ struct PFS_ALIGNED PFS_prepared_stmt : public PFS_instr
   /** Prepared stmt execution stat. */
   PFS_statement_stat m_execute_stat;
 
+  /** COLUMN COUNT_PLAN_HIT. Executions that reused the saved plan. */
+  PFS_single_stat m_plan_hit_stat;
+
+  /** COLUMN COUNT_PLAN_MISS. Executions that searched for a plan. */
+  PFS_single_stat m_plan_miss_stat;
+
+  /** COLUMN COUNT_PLAN_INVALIDATE. Saved plans that were discarded. */
+  PFS_single_stat m_plan_invalidate_stat;
+
   /** Reset data for this record. */
   void reset_data();
 };
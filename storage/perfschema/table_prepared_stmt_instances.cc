@@ -92,7 +92,10 @@ table_prepared_stmt_instances::m_share=
   "SUM_SORT_ROWS bigint(20) unsigned NOT NULL comment 'The total number of sorted rows that were sorted by the prepared statements.',"
   "SUM_SORT_SCAN bigint(20) unsigned NOT NULL comment 'The total number of sorts that were done by scanning the table by the prepared statements.',"
   "SUM_NO_INDEX_USED bigint(20) unsigned NOT NULL comment 'The total number of statements that performed a table scan without using an index.',"
-  "SUM_NO_GOOD_INDEX_USED bigint(20) unsigned NOT NULL comment 'The total number of statements where no good index was found.')")},
+  "SUM_NO_GOOD_INDEX_USED bigint(20) unsigned NOT NULL comment 'The total number of statements where no good index was found.',"
+  "COUNT_PLAN_HIT bigint(20) unsigned NOT NULL comment 'The number of times the saved join plan was reused.',"
+  "COUNT_PLAN_MISS bigint(20) unsigned NOT NULL comment 'The number of times a join plan was searched for and saved.',"
+  "COUNT_PLAN_INVALIDATE bigint(20) unsigned NOT NULL comment 'The number of times the saved join plans were discarded.')")},
   false, /* m_perpetual */
   false, /* m_optional */
   &m_share_state
@@ -206,6 +209,11 @@ void table_prepared_stmt_instances::make_row(PFS_prepared_stmt* prepared_stmt)
   m_row.m_reprepare_stat.set(normalizer, & prepared_stmt->m_reprepare_stat);
   /* Get prepared statement execute stats. */
   m_row.m_execute_stat.set(normalizer, & prepared_stmt->m_execute_stat);
+  /* Get prepared statement saved plan stats. */
+  m_row.m_plan_hit_stat.set(normalizer, & prepared_stmt->m_plan_hit_stat);
+  m_row.m_plan_miss_stat.set(normalizer, & prepared_stmt->m_plan_miss_stat);
+  m_row.m_plan_invalidate_stat.set(normalizer,
+                                   & prepared_stmt->m_plan_invalidate_stat);
 
   if (! prepared_stmt->m_lock.end_optimistic_lock(&lock))
     return;
@@ -289,6 +297,15 @@ ::read_row_values(TABLE *table, unsigned char *buf, Field **fields,
       case 10:   /* COUNT_REPREPARE */
         m_row.m_reprepare_stat.set_field(0, f);
         break;
+      case 35:   /* COUNT_PLAN_HIT */
+        m_row.m_plan_hit_stat.set_field(0, f);
+        break;
+      case 36:   /* COUNT_PLAN_MISS */
+        m_row.m_plan_miss_stat.set_field(0, f);
+        break;
+      case 37:   /* COUNT_PLAN_INVALIDATE */
+        m_row.m_plan_invalidate_stat.set_field(0, f);
+        break;
       default: /* 14, ... COUNT/SUM/MIN/AVG/MAX */
         m_row.m_execute_stat.set_field(f->field_index - 11, f);
         break;
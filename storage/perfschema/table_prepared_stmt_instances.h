@@ -81,6 +81,15 @@ struct row_prepared_stmt_instances
 
   /** Columns COUNT_STAR...SUM_NO_GOOD_INDEX_USED. */
   PFS_statement_stat_row m_execute_stat;
+
+  /** Column COUNT_PLAN_HIT. */
+  PFS_stat_row m_plan_hit_stat;
+
+  /** Column COUNT_PLAN_MISS. */
+  PFS_stat_row m_plan_miss_stat;
+
+  /** Column COUNT_PLAN_INVALIDATE. */
+  PFS_stat_row m_plan_invalidate_stat;
 };
 
 /** Table PERFORMANCE_SCHEMA.PREPARED_STATEMENT_INSTANCES. */
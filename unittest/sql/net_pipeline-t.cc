@@ -0,0 +1,205 @@
+/*
+   Copyright (c) 2026, MariaDB Corporation.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1335 USA */
+
+/**
+  Unit test of the corking of the responses to pipelined commands.
+
+  A client sends several commands in one write over a TCP connection.
+  The server side reads them one by one, like do_command() does for a
+  client with MARIADB_CLIENT_PIPELINE: the socket must be corked while
+  the next command is pending, and uncorked for the last one, also when
+  a command in the middle gets an error.
+*/
+
+#include <tap.h>
+#include <sql_class.h>
+#include <violite.h>
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#endif
+
+#ifndef _WIN32
+
+static const uchar ok_packet[]= { 0, 0, 0, 2, 0, 0, 0 };
+static const uchar err_packet[]= { 255, 0x28, 0x04, '#', '4', '2', '0', '0', '0',
+                                   'e', 'r', 'r', 'o', 'r' };
+
+/** @return whether a socket is corked, according to the kernel */
+static bool is_corked(NET *net)
+{
+#ifdef TCP_CORK
+  int cork= 0;
+  socklen_t length= sizeof cork;
+  if (getsockopt(vio_fd(net->vio), IPPROTO_TCP, TCP_CORK, &cork, &length))
+    return false;
+  return cork && net->vio->corked;
+#else
+  return net->vio->corked;
+#endif
+}
+
+static bool is_uncorked(NET *net)
+{
+#ifdef TCP_CORK
+  int cork= 1;
+  socklen_t length= sizeof cork;
+  if (getsockopt(vio_fd(net->vio), IPPROTO_TCP, TCP_CORK, &cork, &length))
+    return false;
+  return !cork && !net->vio->corked;
+#else
+  return !net->vio->corked;
+#endif
+}
+
+/** Connect two TCP sockets over the loopback interface */
+static bool tcp_pair(my_socket *client, my_socket *server)
+{
+  struct sockaddr_in addr;
+  socklen_t length= sizeof addr;
+  my_socket listener= socket(AF_INET, SOCK_STREAM, 0);
+  if (listener < 0)
+    return true;
+  memset(&addr, 0, sizeof addr);
+  addr.sin_family= AF_INET;
+  addr.sin_addr.s_addr= htonl(INADDR_LOOPBACK);
+  addr.sin_port= 0;
+  bool error= bind(listener, (struct sockaddr*) &addr, sizeof addr) ||
+    listen(listener, 1) ||
+    getsockname(listener, (struct sockaddr*) &addr, &length) ||
+    (*client= socket(AF_INET, SOCK_STREAM, 0)) < 0 ||
+    connect(*client, (struct sockaddr*) &addr, sizeof addr) ||
+    (*server= accept(listener, NULL, NULL)) < 0;
+  closesocket(listener);
+  return error;
+}
+
+static bool init_net(NET *net, my_socket fd)
+{
+  Vio *vio= vio_new(fd, VIO_TYPE_TCPIP, 0);
+  return !vio || my_net_init(net, vio, NULL, 0);
+}
+
+/** Send commands to the server in a single write */
+static bool send_commands(NET *net, uint n)
+{
+  for (uint i= 0; i < n; i++)
+  {
+    uchar command[]= { COM_QUERY, 'S', 'E', 'L', 'E', 'C', 'T', ' ',
+                       (uchar) ('0' + i) };
+    net->pkt_nr= 0;
+    if (my_net_write(net, command, sizeof command))
+      return true;
+  }
+  return net_flush(net);
+}
+
+/** Read a command on the server side, like do_command() */
+static bool read_command(NET *net, uint i)
+{
+  net_new_transaction(net);
+  return my_net_read(net) != 9 || net->read_pos[0] != COM_QUERY ||
+    net->read_pos[8] != '0' + i;
+}
+
+static bool send_response(NET *net, const uchar *packet, size_t length)
+{
+  net->pkt_nr= 1;
+  return my_net_write(net, packet, length) || net_flush(net);
+}
+
+static bool read_response(NET *net, uchar first_byte)
+{
+  net->pkt_nr= 1;
+  ulong length= my_net_read(net);
+  return length == packet_error || !length || net->read_pos[0] != first_byte;
+}
+
+int main(int argc __attribute__((unused)), char *argv[])
+{
+  MY_INIT(argv[0]);
+  plan(11);
+
+  global_system_variables.net_buffer_length= 16384;
+  global_system_variables.max_allowed_packet= 1024 * 1024;
+  global_system_variables.net_read_timeout= 60;
+  global_system_variables.net_write_timeout= 60;
+  global_system_variables.net_retry_count= 10;
+
+  my_socket client_fd, server_fd;
+  NET client, server;
+  ok(!tcp_pair(&client_fd, &server_fd) &&
+     !init_net(&client, client_fd) && !init_net(&server, server_fd),
+     "connected");
+
+  /* A single command is not corked */
+  bool error= send_commands(&client, 1) || read_command(&server, 0);
+  ok(!error && !net_cork_pipeline(&server) && is_uncorked(&server),
+     "single command: not corked");
+  error= send_response(&server, ok_packet, sizeof ok_packet) ||
+    read_response(&client, 0);
+  ok(!error, "single command: response");
+
+  /* A pipeline of three commands; the second one fails */
+  error= send_commands(&client, 3) || read_command(&server, 0);
+  ok(!error && net_cork_pipeline(&server) && is_corked(&server),
+     "pipeline: corked for the first command");
+  error= send_response(&server, ok_packet, sizeof ok_packet) ||
+    read_command(&server, 1);
+  ok(!error && net_cork_pipeline(&server) && is_corked(&server),
+     "pipeline: corked for the failing command");
+  error= send_response(&server, err_packet, sizeof err_packet) ||
+    read_command(&server, 2);
+  ok(!error && !net_cork_pipeline(&server) && is_uncorked(&server),
+     "pipeline: uncorked for the last command");
+  error= send_response(&server, ok_packet, sizeof ok_packet);
+  ok(!error, "pipeline: responses sent");
+
+  ok(!read_response(&client, 0), "pipeline: first response");
+  ok(!read_response(&client, 255) && uint2korr(client.read_pos + 1) == 1064,
+     "pipeline: error response");
+  ok(!read_response(&client, 0), "pipeline: last response");
+
+  /* A pipeline that ends with an error is uncorked too */
+  error= send_commands(&client, 2) || read_command(&server, 0) ||
+    !net_cork_pipeline(&server) ||
+    send_response(&server, ok_packet, sizeof ok_packet) ||
+    read_command(&server, 1) || net_cork_pipeline(&server) ||
+    send_response(&server, err_packet, sizeof err_packet) ||
+    read_response(&client, 0) || read_response(&client, 255);
+  ok(!error && is_uncorked(&server), "pipeline ending with an error");
+
+  vio_delete(client.vio);
+  vio_delete(server.vio);
+  net_end(&client);
+  net_end(&server);
+  my_end(0);
+  return exit_status();
+}
+
+#else
+
+int main(int argc __attribute__((unused)), char *argv[])
+{
+  MY_INIT(argv[0]);
+  skip_all("no socket API for the test");
+  my_end(0);
+  return 0;
+}
+
+#endif
@@ -0,0 +1,153 @@
+/*
+   Copyright (c) 2026, MariaDB Corporation.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1335 USA */
+
+/**
+  Unit test of the zstd compressed protocol: packets are written to
+  one end of a socket pair with my_net_write() and read back from the
+  other end with my_net_read(), with both ends using zstd streams.
+*/
+
+#include <tap.h>
+#include <sql_class.h>
+#include <violite.h>
+#include <thread>
+#ifndef _WIN32
+#include <sys/socket.h>
+#endif
+
+#if defined HAVE_ZSTD_COMPRESS && !defined _WIN32
+
+/* The packets that are sent */
+static const uint n_small= 200;
+static const size_t large_length= 3 * MAX_PACKET_LENGTH / 2;
+
+static size_t small_packet(uint i, char *buff)
+{
+  /* Like the rows of a result set: similar, but not identical */
+  return (size_t) sprintf(buff, "%u\tcustomer %u\t2026-10-%02u\tshipped",
+                          i, i * 7 % 100, i % 28 + 1);
+}
+
+static uchar *large_packet()
+{
+  uchar *p= (uchar*) my_malloc(PSI_NOT_INSTRUMENTED, large_length, MYF(0));
+  if (p)
+  {
+    ulonglong x= 1;
+    for (size_t i= 0; i < large_length; i++)
+    {
+      /* Mostly repetitive, with some noise */
+      x= x * 6364136223846793005ULL + 1442695040888963407ULL;
+      p[i]= (uchar) (i % 64 < 60 ? 'a' + i % 26 : x >> 56);
+    }
+  }
+  return p;
+}
+
+static bool write_packets(NET *net, const uchar *large)
+{
+  char buff[100];
+  for (uint i= 0; i < n_small; i++)
+    if (my_net_write(net, (uchar*) buff, small_packet(i, buff)))
+      return true;
+  if (my_net_write(net, (uchar*) "", 0) ||
+      my_net_write(net, large, large_length))
+    return true;
+  /* The same data once more: it can refer to the previous packets */
+  for (uint i= 0; i < n_small; i++)
+    if (my_net_write(net, (uchar*) buff, small_packet(i, buff)))
+      return true;
+  return net_flush(net);
+}
+
+static bool read_small_packets(NET *net)
+{
+  char buff[100];
+  for (uint i= 0; i < n_small; i++)
+  {
+    size_t length= small_packet(i, buff);
+    if (my_net_read(net) != length || memcmp(net->read_pos, buff, length))
+      return true;
+  }
+  return false;
+}
+
+static bool init_net(NET *net, my_socket fd)
+{
+  Vio *vio= vio_new(fd, VIO_TYPE_SOCKET, VIO_LOCALHOST);
+  if (!vio || my_net_init(net, vio, NULL, 0))
+    return true;
+  net->compress= 1;
+  return net_zstd_init(net, 3);
+}
+
+int main(int argc __attribute__((unused)), char *argv[])
+{
+  MY_INIT(argv[0]);
+  plan(6);
+
+  global_system_variables.net_buffer_length= 16384;
+  global_system_variables.max_allowed_packet= 4 * MAX_PACKET_LENGTH;
+  global_system_variables.net_read_timeout= 60;
+  global_system_variables.net_write_timeout= 60;
+  global_system_variables.net_retry_count= 10;
+
+  int fds[2];
+  NET writer, reader;
+  uchar *large= large_packet();
+
+  ok(large && !socketpair(AF_UNIX, SOCK_STREAM, 0, fds) &&
+     !init_net(&writer, fds[0]) && !init_net(&reader, fds[1]),
+     "zstd streams initialized");
+
+  bool write_error= true;
+  std::thread t([&]()
+  {
+    my_thread_init();
+    write_error= write_packets(&writer, large);
+    my_thread_end();
+  });
+
+  ok(!read_small_packets(&reader), "small packets");
+  ok(my_net_read(&reader) == 0, "empty packet");
+  ok(my_net_read(&reader) == large_length &&
+     !memcmp(reader.read_pos, large, large_length),
+     "packet longer than MAX_PACKET_LENGTH");
+  ok(!read_small_packets(&reader), "small packets after the long one");
+
+  t.join();
+  ok(!write_error, "all packets written");
+
+  vio_delete(writer.vio);
+  vio_delete(reader.vio);
+  net_end(&writer);
+  net_end(&reader);
+  my_free(large);
+  my_end(0);
+  return exit_status();
+}
+
+#else
+
+int main(int argc __attribute__((unused)), char *argv[])
+{
+  MY_INIT(argv[0]);
+  skip_all("the server is built without zstd");
+  my_end(0);
+  return 0;
+}
+
+#endif
@@ -437,6 +437,38 @@ int vio_nodelay(Vio *vio, my_bool on)
   DBUG_RETURN(r);
 }
 
+/*
+  Set TCP_CORK: partial segments are held back until the cork is removed,
+  so that the responses to pipelined commands are sent together
+*/
+int vio_cork(Vio *vio, my_bool on)
+{
+  int r= 0;
+  DBUG_ENTER("vio_cork");
+
+  if (vio->corked == MY_TEST(on))
+    DBUG_RETURN(0);
+  vio->corked= MY_TEST(on);
+
+#ifdef TCP_CORK
+  if (vio->type == VIO_TYPE_TCPIP || vio->type == VIO_TYPE_SSL)
+  {
+    int cork= MY_TEST(on);
+    r= mysql_socket_setsockopt(vio->mysql_socket, IPPROTO_TCP, TCP_CORK,
+                               (void*) &cork, sizeof(cork));
+    if (r)
+    {
+      DBUG_PRINT("warning",
+                 ("Couldn't set socket option for cork, error %d",
+                  socket_errno));
+      r= -1;
+    }
+  }
+#endif
+  DBUG_PRINT("exit", ("%d", r));
+  DBUG_RETURN(r);
+}
+
 int vio_fastsend(Vio * vio)
 {
   int r=0;